@@ -1,6 +1,8 @@
 #include <AStar.hpp>
+#include <Metrics.hpp>
 #include <RobotWorld.hpp>
 #include <Shape2DUtils.hpp>
+#include <TraceLog.hpp>
 #include <Wall.hpp>
 #include <algorithm>
 #include <cmath>
@@ -50,12 +52,12 @@ namespace PathAlgorithm
 	 *
 	 */
 	std::vector< Vertex > GetNeighbours(	const Vertex& aVertex,
-											int aFreeRadius /*= 1*/)
+											int aFreeRadius,
+											const std::vector< Model::WallPtr >& aWalls)
 				{
 		static int xOffset[] = { 0, 1, 1, 1, 0, -1, -1, -1 };
 		static int yOffset[] = { 1, 1, 0, -1, -1, -1, 0, 1 };
 
-		const std::vector< Model::WallPtr >& walls = Model::RobotWorld::getRobotWorld().getWalls();
 		std::vector< Vertex > neighbours;
 
 		for (int i = 0; i < 8; ++i)
@@ -63,7 +65,7 @@ namespace PathAlgorithm
 			bool addToNeigbours = true;
 
 			Vertex vertex( aVertex.x + xOffset[i], aVertex.y + yOffset[i]);
-			for (Model::WallPtr wall : walls)
+			for (Model::WallPtr wall : aWalls)
 			{
 				if (Utils::Shape2DUtils::isOnLine( wall->getPoint1(), wall->getPoint2(), vertex.asPoint(), aFreeRadius))
 				{
@@ -82,11 +84,12 @@ namespace PathAlgorithm
 	 *
 	 */
 	std::vector< Edge > GetNeighbourConnections(	const Vertex& aVertex,
-													int aFreeRadius /*= 1*/)
+													int aFreeRadius,
+													const std::vector< Model::WallPtr >& aWalls)
 				{
 		std::vector< Edge > connections;
 
-		const std::vector< Vertex >& neighbours = GetNeighbours( aVertex, aFreeRadius);
+		const std::vector< Vertex >& neighbours = GetNeighbours( aVertex, aFreeRadius, aWalls);
 		for (const Vertex& vertex : neighbours)
 		{
 			connections.push_back( Edge( aVertex, vertex));
@@ -94,6 +97,22 @@ namespace PathAlgorithm
 
 		return connections;
 				}
+	/**
+	 *
+	 */
+	AStar::AStar() :
+				robotWorld( &Model::RobotWorld::getRobotWorld()),
+				openSetVersion( 0)
+	{
+	}
+	/**
+	 *
+	 */
+	AStar::AStar( const Model::RobotWorld& aRobotWorld) :
+				robotWorld( &aRobotWorld),
+				openSetVersion( 0)
+	{
+	}
 	/**
 	 *
 	 */
@@ -118,28 +137,55 @@ namespace PathAlgorithm
 		getCS().clear();
 		getPM().clear();
 
+		// The distance as the crow flies in, the expansions and the length of the path out
+		Base::TraceScope trace( Base::TraceEvent::RouteSearch, static_cast< std::uint64_t >(HeuristicCost( aStart, aGoal)));
+
+		static Base::Histogram& searchTime = Base::Metrics::getMetrics().getHistogram( "robotworld_astar_search_seconds", "The duration of a route search", 1e-6);
+		static Base::Histogram& searchNodes = Base::Metrics::getMetrics().getHistogram( "robotworld_astar_search_nodes", "The vertices a route search expanded");
+		static Base::Counter& failedSearches = Base::Metrics::getMetrics().getCounter( "robotworld_astar_failed_searches_total", "The route searches that found no route");
+		Base::ScopedTimer timer( searchTime);
+
+		// The walls as they were when the search started, even if they are changed while it runs
+		Model::RobotWorld::SnapshotPtr snapshot = robotWorld->getSnapshot();
+		const std::vector< Model::WallPtr >& walls = snapshot->walls;
+
 		int radius = std::sqrt( (aRobotSize.x / 2.0) * (aRobotSize.x / 2.0) + (aRobotSize.y / 2.0) * (aRobotSize.y / 2.0));
 
 		aStart.actualCost = 0.0; 													// Cost from aStart along the best known path.
 		aStart.heuristicCost = aStart.actualCost + HeuristicCost( aStart, aGoal);	// Estimated total cost from aStart to aGoal through y.
 
 		addToOpenSet(aStart);
+		publishOpenSet();
 
 		//		long long begin = std::clock();
 
+		// The open set is published every so many expansions, often enough to watch the search
+		// and seldom enough for the copies not to matter
+		const unsigned long publishInterval = 1024;
+		unsigned long expansions = 0;
+
 		while (!openSet.empty())
 		{
 			Vertex current = *openSet.begin();
 
 			if (current.equalPoint( aGoal))
 			{
-				return ConstructPath( predecessorMap, current);
+				publishOpenSet();
+				Path path = ConstructPath( predecessorMap, current);
+				trace.setEndPayload( expansions, path.size());
+				searchNodes.record( expansions);
+				return path;
 			} else
 			{
+				if ((++expansions % publishInterval) == 0)
+				{
+					publishOpenSet();
+				}
+
 				addToClosedSet( current);
 				removeFirstFromOpenSet();
 
-				const std::vector< Edge >& connections = GetNeighbourConnections( current, radius);
+				const std::vector< Edge >& connections = GetNeighbourConnections( current, radius, walls);
 				for (const Edge& connection : connections)
 				{
 					Vertex neighbour = connection.otherSide( current);
@@ -254,6 +300,10 @@ namespace PathAlgorithm
 		}
 		// std::cerr << "Duration: " << (std::clock() - begin) << " openSet: " << getOS().size() << " closedSet: " << getCS().size() << " predecessorMap: " << getPM().size() << std::endl;
 
+		publishOpenSet();
+		trace.setEndPayload( expansions);
+		searchNodes.record( expansions);
+		failedSearches.add();
 		std::cerr << "**** No route from " << aStart << " to " << aGoal << std::endl;
 		return Path();
 	}
@@ -388,6 +438,21 @@ namespace PathAlgorithm
 		OpenSet o = getOS();
 		return o;
 	}
+	/**
+	 *
+	 */
+	VertexViewPtr AStar::getOpenSetView() const
+	{
+		return std::atomic_load( &openSetView);
+	}
+	/**
+	 *
+	 */
+	void AStar::publishOpenSet()
+	{
+		std::lock_guard< std::recursive_mutex > lock( openSetMutex);
+		std::atomic_store( &openSetView, VertexViewPtr( std::make_shared< VertexView >( ++openSetVersion, openSet)));
+	}
 	/**
 	 *
 	 */
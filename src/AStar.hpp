@@ -5,6 +5,7 @@
 
 #include <iostream>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <set>
 #include <vector>
@@ -13,6 +14,11 @@
 #include "Point.hpp"
 #include "Size.hpp"
 
+namespace Model
+{
+	class RobotWorld;
+} // namespace Model
+
 namespace PathAlgorithm
 {
 	struct Vertex
@@ -182,12 +188,41 @@ namespace PathAlgorithm
 	typedef std::vector< Vertex > OpenSet;
 	typedef std::set< Vertex, VertexLessIdCompare > ClosedSet;
 	typedef std::map< Vertex, Vertex, VertexLessIdCompare > VertexMap;
+	/**
+	 * An immutable version of a path or an open set. A new one is published instead of changing it, so a
+	 * reader on another thread (the renderer) can keep it without a lock or a copy and only has to
+	 * compare the version to see whether it changed.
+	 */
+	struct VertexView
+	{
+			/**
+			 *
+			 */
+			VertexView(	unsigned long aVersion,
+						const std::vector< Vertex >& someVertices) :
+							version( aVersion),
+							vertices( someVertices)
+			{
+			}
+
+			const unsigned long version;
+			const std::vector< Vertex > vertices;
+	};
+	typedef std::shared_ptr< const VertexView > VertexViewPtr;
 	/**
 	 *
 	 */
 	class AStar : public Base::Notifier
 	{
 		public:
+			/**
+			 * Searches in the default RobotWorld
+			 */
+			AStar();
+			/**
+			 * Searches in aRobotWorld, which must outlive the AStar
+			 */
+			explicit AStar( const Model::RobotWorld& aRobotWorld);
 			/**
 			 *
 			 */
@@ -252,6 +287,10 @@ namespace PathAlgorithm
 			 *
 			 */
 			OpenSet getOpenSet() const;
+			/**
+			 * The open set as it was when the running or last search published it, without copying it
+			 */
+			VertexViewPtr getOpenSetView() const;
 			/**
 			 *
 			 */
@@ -284,6 +323,15 @@ namespace PathAlgorithm
 			const VertexMap& getPM() const;
 
 		private:
+			/**
+			 * Publishes a copy of the open set as a new version of the open set view
+			 */
+			void publishOpenSet();
+
+			/**
+			 * The world whose walls are avoided
+			 */
+			const Model::RobotWorld* robotWorld;
 			/**
 			 *
 			 */
@@ -296,6 +344,11 @@ namespace PathAlgorithm
 			 *
 			 */
 			VertexMap predecessorMap;
+			/**
+			 * Only accessed with std::atomic_load and std::atomic_store
+			 */
+			VertexViewPtr openSetView;
+			unsigned long openSetVersion;
 
 			mutable std::recursive_mutex openSetMutex;
 			mutable std::recursive_mutex closedSetMutex;
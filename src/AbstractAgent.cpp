@@ -9,7 +9,8 @@ namespace Model
 	/**
 	 *
 	 */
-	AbstractAgent::AbstractAgent()
+	AbstractAgent::AbstractAgent() :
+								perceptQueue( 64, Base::OverflowPolicy::DropOldest)
 	{
 	}
 	/**
@@ -49,6 +50,13 @@ namespace Model
 	{
 		perceptQueue.enqueue( aPercept);
 	}
+	/**
+	 *
+	 */
+	unsigned long AbstractAgent::getDroppedPercepts() const
+	{
+		return perceptQueue.getDropped();
+	}
 	/**
 	 *
 	 */
@@ -7,7 +7,7 @@
 #include <vector>
 
 #include "ModelObject.hpp"
-#include "Queue.hpp"
+#include "RingBuffer.hpp"
 
 /**
  *
@@ -57,6 +57,10 @@ namespace Model
 			 *
 			 */
 			virtual void addPercept( std::shared_ptr< AbstractPercept > anAbstractPercept);
+			/**
+			 * @return the number of percepts that were dropped because the agent did not keep up with its sensors
+			 */
+			unsigned long getDroppedPercepts() const;
 			/**
 			 *
 			 */
@@ -81,7 +85,11 @@ namespace Model
 		protected:
 			std::vector< std::shared_ptr< AbstractSensor > > sensors;
 			std::vector< std::shared_ptr< AbstractActuator > > actuators;
-			Base::Queue< std::shared_ptr< AbstractPercept > > perceptQueue;
+			/**
+			 * Filled by the sensors, possibly from several threads. If the agent does not keep up the
+			 * oldest percepts are dropped: they are the least relevant ones.
+			 */
+			Base::RingBuffer< std::shared_ptr< AbstractPercept >, Base::Producers::Multiple > perceptQueue;
 
 		private:
 	};
@@ -1,5 +1,6 @@
 #include "AbstractSensor.hpp"
 #include "AbstractAgent.hpp"
+#include "SensorScheduler.hpp"
 #include "Logger.hpp"
 
 namespace Model
@@ -26,6 +27,12 @@ namespace Model
 	 */
 	AbstractSensor::~AbstractSensor()
 	{
+		// Derived sensors that are switched on should call setOff in their own destructor
+		// so that they are not sampled while being destroyed
+		if (running)
+		{
+			setOff();
+		}
 	}
 	/**
 	 *
@@ -33,13 +40,8 @@ namespace Model
 	void AbstractSensor::setOn( unsigned long aSleepTime /*= 100*/)
 	{
 		std::unique_lock< std::recursive_mutex > lock( sensorMutex);
-		if (running == false)
-		{
-			running = true;
-			std::thread newSensorThread( [this, aSleepTime]
-										  {	run(aSleepTime);});
-			sensorThread.swap( newSensorThread);
-		}
+		running = true;
+		SensorScheduler::getSensorScheduler().schedule( this, aSleepTime);
 	}
 	/**
 	 *
@@ -49,8 +51,7 @@ namespace Model
 		std::unique_lock< std::recursive_mutex > lock( sensorMutex);
 
 		running = false;
-		//sensorThread.interrupt();
-		sensorThread.join();
+		SensorScheduler::getSensorScheduler().unschedule( this);
 	}
 	/**
 	 *
@@ -62,35 +63,15 @@ namespace Model
 	/**
 	 *
 	 */
-	void AbstractSensor::run( unsigned long UNUSEDPARAM(aSleepTime))
+	void AbstractSensor::sample()
 	{
-		try
-		{
-			while (running == true)
-			{
-				std::shared_ptr< AbstractStimulus > currentStimulus = getStimulus();
-				std::shared_ptr< AbstractPercept > currentPercept = getPerceptFor( currentStimulus);
-				sendPercept( currentPercept);
-
-				//std::this_thread::sleep_for( std::chrono::milliseconds( aSleepTime));
-
-
-				// this should be either the last call in the loop or
-				// part of the while.
-				//			if (sensorThread.interruption_requested())
-				//			{
-				//				break;
-				//			}
-			}
-		}
-		catch (std::exception& e)
-		{
-			std::cerr << __PRETTY_FUNCTION__ << ": " << e.what() << std::endl;
-		}
-		catch (...)
+		if (agent == nullptr)
 		{
-			std::cerr << __PRETTY_FUNCTION__ << ": unknown exception" << std::endl;
+			return;
 		}
+		std::shared_ptr< AbstractStimulus > currentStimulus = getStimulus();
+		std::shared_ptr< AbstractPercept > currentPercept = getPerceptFor( currentStimulus);
+		sendPercept( currentPercept);
 	}
 	/**
 	 *
@@ -3,6 +3,8 @@
 
 #include "Config.hpp"
 
+#include <atomic>
+
 #include "Thread.hpp"
 #include "ModelObject.hpp"
 
@@ -56,13 +58,21 @@ namespace Model
 			 */
 			virtual ~AbstractSensor();
 			/**
-			 * A sensor reads 10 stimuli/second (it sleeps for 100 ms) by default
+			 * A sensor reads 10 stimuli/second (once every 100 ms) by default.
+			 * The sensor is sampled by the SensorScheduler.
 			 */
 			virtual void setOn( unsigned long aSleepTime = 100);
 			/**
 			 *
 			 */
 			virtual void setOff();
+			/**
+			 *
+			 */
+			bool isOn() const
+			{
+				return running;
+			}
 			/**
 			 *
 			 */
@@ -76,9 +86,10 @@ namespace Model
 			 */
 			virtual void sendPercept( std::shared_ptr< AbstractPercept > anAbstractPercept);
 			/**
-			 *
+			 * Reads one stimulus and sends the percept for it to the agent.
+			 * Called by the SensorScheduler at the rate given to setOn.
 			 */
-			virtual void run( unsigned long aSleepTime);
+			virtual void sample();
 			/**
 			 *
 			 */
@@ -103,8 +114,7 @@ namespace Model
 
 		protected:
 			AbstractAgent* agent;
-			bool running;
-			std::thread sensorThread;
+			std::atomic< bool > running;
 			mutable std::recursive_mutex sensorMutex;
 
 		private:
@@ -0,0 +1,32 @@
+#include "AllocationCounter.hpp"
+#include "Thread.hpp"
+
+namespace Base
+{
+	/**
+	 *
+	 */
+	/* static */std::atomic< unsigned long > AllocationCounter::total( 0);
+
+	static std::mutex allocationsPerSecondMutex;
+
+	/**
+	 *
+	 */
+	/* static */double AllocationCounter::getAllocationsPerSecond()
+	{
+		std::lock_guard< std::mutex > lock( allocationsPerSecondMutex);
+
+		static std::chrono::steady_clock::time_point previousTime = std::chrono::steady_clock::now();
+		static unsigned long previousTotal = 0;
+
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		unsigned long currentTotal = getTotal();
+		double seconds = std::chrono::duration< double >( now - previousTime).count();
+		double allocationsPerSecond = seconds > 0.0 ? static_cast< double >(currentTotal - previousTotal) / seconds : 0.0;
+
+		previousTime = now;
+		previousTotal = currentTotal;
+		return allocationsPerSecond;
+	}
+} // namespace Base
@@ -0,0 +1,107 @@
+#ifndef ALLOCATIONCOUNTER_HPP_
+#define ALLOCATIONCOUNTER_HPP_
+
+#include "Config.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace Base
+{
+	/**
+	 * Counts the heap allocations made by the allocation-free code paths so that it can be seen that they
+	 * really are allocation-free in steady state. Only what is reported is counted: the growth of an
+	 * ObjectPool and every allocation of a container that uses a CountingAllocator.
+	 */
+	class AllocationCounter
+	{
+		public:
+			/**
+			 *
+			 */
+			static void add( unsigned long aNumberOfAllocations = 1)
+			{
+				total.fetch_add( aNumberOfAllocations, std::memory_order_relaxed);
+			}
+			/**
+			 *
+			 */
+			static unsigned long getTotal()
+			{
+				return total.load( std::memory_order_relaxed);
+			}
+			/**
+			 *
+			 * @return the number of allocations per second since the previous call of this function
+			 */
+			static double getAllocationsPerSecond();
+
+		private:
+			static std::atomic< unsigned long > total;
+	};
+	// class AllocationCounter
+
+	/**
+	 * A std::allocator that reports every allocation to the AllocationCounter. Used by the containers
+	 * of the allocation-free code paths, e.g. the scans and percepts of the LaserDistanceSensor, so
+	 * that a container that grows in steady state shows up in the count.
+	 */
+	template< typename T >
+	class CountingAllocator
+	{
+		public:
+			typedef T value_type;
+
+			/**
+			 *
+			 */
+			CountingAllocator()
+			{
+			}
+			/**
+			 *
+			 */
+			template< typename U >
+			CountingAllocator( const CountingAllocator< U >& UNUSEDPARAM(aCountingAllocator))
+			{
+			}
+			/**
+			 *
+			 */
+			T* allocate( std::size_t aNumberOfObjects)
+			{
+				AllocationCounter::add();
+				return std::allocator< T >().allocate( aNumberOfObjects);
+			}
+			/**
+			 *
+			 */
+			void deallocate(	T* anObject,
+								std::size_t aNumberOfObjects)
+			{
+				std::allocator< T >().deallocate( anObject, aNumberOfObjects);
+			}
+	};
+	// class CountingAllocator
+
+	/**
+	 * Stateless, so all CountingAllocators are equal
+	 */
+	template< typename T, typename U >
+	bool operator==(	const CountingAllocator< T >& UNUSEDPARAM(lhs),
+						const CountingAllocator< U >& UNUSEDPARAM(rhs))
+	{
+		return true;
+	}
+	/**
+	 *
+	 */
+	template< typename T, typename U >
+	bool operator!=(	const CountingAllocator< T >& UNUSEDPARAM(lhs),
+						const CountingAllocator< U >& UNUSEDPARAM(rhs))
+	{
+		return false;
+	}
+} // namespace Base
+#endif // ALLOCATIONCOUNTER_HPP_
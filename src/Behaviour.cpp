@@ -0,0 +1,220 @@
+#include "Behaviour.hpp"
+#include <chrono>
+#include <memory>
+#include <thread>
+
+namespace Model
+{
+	/**
+	 * The behaviour whose task runs on this thread, if any
+	 */
+	static thread_local const Behaviour* runningBehaviour = nullptr;
+
+	/**
+	 *
+	 */
+	Behaviour::Await::Await( Kind aKind /*= Kind::NextTick*/) :
+								kind( aKind),
+								ticks( 0),
+								name( "task")
+	{
+	}
+	/**
+	 *
+	 */
+	Behaviour::Behaviour() :
+								simulationClock( nullptr),
+								behaving( false)
+	{
+	}
+	/**
+	 *
+	 */
+	Behaviour::~Behaviour()
+	{
+		stopBehaviour();
+	}
+	/**
+	 *
+	 */
+	void Behaviour::startBehaviour( SimulationClock& aSimulationClock)
+	{
+		stopBehaviour();
+
+		simulationClock = &aSimulationClock;
+		awaiting = nextTick();
+		behaving = true;
+		simulationClock->attach( this);
+	}
+	/**
+	 *
+	 */
+	void Behaviour::stopBehaviour()
+	{
+		behaving = false;
+		if (simulationClock)
+		{
+			simulationClock->detach( this);
+			simulationClock = nullptr;
+		}
+		if (!taskDone.valid() || runningBehaviour == this)
+		{
+			// Called by its own task, which is over as soon as the caller returns
+			return;
+		}
+		Base::WorkStealingPool& workStealingPool = Base::WorkStealingPool::getWorkStealingPool();
+		if (!workStealingPool.isWorker())
+		{
+			taskDone.wait();
+			return;
+		}
+		// A worker must not block on the pool: the task may be queued behind the caller
+		while (taskDone.wait_for( std::chrono::seconds( 0)) != std::future_status::ready)
+		{
+			if (!workStealingPool.runPendingTask())
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+	/**
+	 *
+	 */
+	void Behaviour::handleTick( unsigned long aTick)
+	{
+		if (!behaving)
+		{
+			return;
+		}
+
+		switch (awaiting.kind)
+		{
+			case Await::Kind::NextTick:
+			{
+				break;
+			}
+			case Await::Kind::Ticks:
+			{
+				if (--awaiting.ticks > 0)
+				{
+					return;
+				}
+				break;
+			}
+			case Await::Kind::Task:
+			{
+				if (taskDone.wait_for( std::chrono::seconds( 0)) != std::future_status::ready)
+				{
+					return;
+				}
+				taskDone = std::future< void >();
+				break;
+			}
+			case Await::Kind::Done:
+			{
+				return;
+			}
+		}
+
+		awaiting = resume( aTick);
+		// The task only belongs to the pool, the behaviour is done with it
+		Base::WorkStealingPool::Task task;
+		task.swap( awaiting.task);
+
+		switch (awaiting.kind)
+		{
+			case Await::Kind::Ticks:
+			{
+				if (awaiting.ticks == 0)
+				{
+					awaiting.kind = Await::Kind::NextTick;
+				}
+				break;
+			}
+			case Await::Kind::Task:
+			{
+				std::shared_ptr< std::promise< void > > done = std::make_shared< std::promise< void > >();
+				taskDone = done->get_future();
+				const Behaviour* behaviour = this;
+				Base::WorkStealingPool::getWorkStealingPool().submit( [task, done, behaviour]
+				{
+					// The pool reports an exception, the promise only tells that the task is over
+					struct Fulfil
+					{
+							~Fulfil()
+							{
+								promise->set_value();
+							}
+							std::shared_ptr< std::promise< void > > promise;
+					} fulfil { done };
+					// Restored afterwards: a waiting worker runs other tasks inside its own
+					struct Running
+					{
+							explicit Running( const Behaviour* aBehaviour) :
+												previous( runningBehaviour)
+							{
+								runningBehaviour = aBehaviour;
+							}
+							~Running()
+							{
+								runningBehaviour = previous;
+							}
+							const Behaviour* previous;
+					} running( behaviour);
+					task();
+				}, awaiting.name);
+				break;
+			}
+			case Await::Kind::Done:
+			{
+				// Detaching from within a tick does not wait for the tick. resume() may have stopped
+				// the behaviour already.
+				behaving = false;
+				if (simulationClock)
+				{
+					simulationClock->detach( this);
+					simulationClock = nullptr;
+				}
+				break;
+			}
+			case Await::Kind::NextTick:
+			{
+				break;
+			}
+		}
+	}
+	/**
+	 *
+	 */
+	/* static */Behaviour::Await Behaviour::nextTick()
+	{
+		return Await( Await::Kind::NextTick);
+	}
+	/**
+	 *
+	 */
+	/* static */Behaviour::Await Behaviour::waitTicks( unsigned long aNumberOfTicks)
+	{
+		Await await( Await::Kind::Ticks);
+		await.ticks = aNumberOfTicks;
+		return await;
+	}
+	/**
+	 *
+	 */
+	/* static */Behaviour::Await Behaviour::runAsync(	const Base::WorkStealingPool::Task& aTask,
+														const char* aName)
+	{
+		Await await( Await::Kind::Task);
+		await.task = aTask;
+		await.name = aName;
+		return await;
+	}
+	/**
+	 *
+	 */
+	/* static */Behaviour::Await Behaviour::done()
+	{
+		return Await( Await::Kind::Done);
+	}
+} // namespace Model
@@ -0,0 +1,137 @@
+#ifndef BEHAVIOUR_HPP_
+#define BEHAVIOUR_HPP_
+
+#include "Config.hpp"
+
+#include <atomic>
+#include <future>
+#include <string>
+
+#include "SimulationClock.hpp"
+#include "WorkStealingPool.hpp"
+
+namespace Model
+{
+	/**
+	 * A behaviour that is resumed by a SimulationClock instead of running on a thread of its own.
+	 *
+	 * resume() does a bit of work and returns what the behaviour waits for before it wants to be resumed
+	 * again: the next tick, a number of ticks or a task (e.g. planning or sending a message) that runs on
+	 * the shared WorkStealingPool in the meantime. While it waits a behaviour costs nothing but its own
+	 * data: it has no stack and no thread, so thousands of them can be suspended at the same time.
+	 *
+	 * The state to continue with is kept by the behaviour itself, typically in a member that tells
+	 * which wait resume() returns from.
+	 */
+	class Behaviour : public TickHandler
+	{
+		public:
+			/**
+			 * What the behaviour waits for until it is resumed
+			 */
+			class Await
+			{
+				public:
+					/**
+					 *
+					 */
+					enum class Kind
+					{
+						NextTick, Ticks, Task, Done
+					};
+					/**
+					 *
+					 */
+					Await( Kind aKind = Kind::NextTick);
+
+					Kind kind;
+					unsigned long ticks;
+					Base::WorkStealingPool::Task task;
+					const char* name;
+			};
+			// class Await
+
+			/**
+			 *
+			 */
+			Behaviour();
+			/**
+			 * Stops the behaviour
+			 */
+			virtual ~Behaviour();
+			/**
+			 *
+			 */
+			Behaviour( const Behaviour& aBehaviour) = delete;
+			/**
+			 *
+			 */
+			Behaviour& operator=( const Behaviour& aBehaviour) = delete;
+			/**
+			 * Resumes the behaviour from the next tick of aSimulationClock on
+			 */
+			void startBehaviour( SimulationClock& aSimulationClock);
+			/**
+			 * Detaches the behaviour from its clock and waits for the task it waits for, if any.
+			 * Called by that task it does not wait, so the task must not destroy the behaviour.
+			 * Called by another worker of the pool it runs queued tasks while it waits.
+			 */
+			void stopBehaviour();
+			/**
+			 *
+			 * @return true from startBehaviour until resume() returns done() or stopBehaviour() is called
+			 */
+			bool isBehaving() const
+			{
+				return behaving;
+			}
+			/**
+			 * @name TickHandler functions
+			 */
+			//@{
+			/**
+			 * Resumes the behaviour if what it waits for is there
+			 */
+			virtual void handleTick( unsigned long aTick);
+			//@}
+
+		protected:
+			/**
+			 * Continues the behaviour until it has to wait
+			 *
+			 * @return what to wait for until the next call
+			 */
+			virtual Await resume( unsigned long aTick) = 0;
+			/**
+			 * Resume in the next tick
+			 */
+			static Await nextTick();
+			/**
+			 * Resume in the aNumberOfTicks-th tick from now
+			 */
+			static Await waitTicks( unsigned long aNumberOfTicks);
+			/**
+			 * Runs aTask on the shared WorkStealingPool and resumes in the first tick after it is done.
+			 * An exception thrown by aTask is reported and the behaviour is resumed anyway.
+			 *
+			 * @param aName see WorkStealingPool::submit
+			 */
+			static Await runAsync(	const Base::WorkStealingPool::Task& aTask,
+									const char* aName);
+			/**
+			 * Stops the behaviour
+			 */
+			static Await done();
+
+		private:
+			SimulationClock* simulationClock;
+			std::atomic< bool > behaving;
+			Await awaiting;
+			/**
+			 * Ready when the task of awaiting is done
+			 */
+			std::future< void > taskDone;
+	};
+	// class Behaviour
+} // namespace Model
+#endif // BEHAVIOUR_HPP_
@@ -32,11 +32,14 @@ namespace Messaging
 			}
 			/**
 			 *
+			 * @param aWhenDone called when the exchange is over: after the response was read or the
+			 * connection failed. It is called on whatever thread ends the exchange and must not block.
 			 */
-			void dispatchMessage( Message& aMessage)
+			void dispatchMessage(	Message& aMessage,
+									const std::function< void() >& aWhenDone = nullptr)
 			{
 				// Create the session that will handle the next outgoing connection
-				ClientSession* session = new ClientSession( aMessage, io_service, responseHandler);
+				std::shared_ptr< ClientSession > session = std::make_shared< ClientSession >( aMessage, io_service, responseHandler, aWhenDone);
 
 				// Build up the remote address to which we will connect
 				boost::asio::ip::tcp::resolver resolver( io_service);
@@ -44,23 +47,25 @@ namespace Messaging
 				boost::asio::ip::tcp::resolver::iterator endpoint_iterator = resolver.resolve( query);
 				boost::asio::ip::tcp::endpoint endpoint = *endpoint_iterator;
 
-				// Let the session handle any outgoing messages
+				// Let the session handle any outgoing messages. The Client may be gone by the time the
+				// connection is made, so the handler gets what it needs by value.
 				session->getSocket().async_connect( endpoint,
-													boost::bind( &Client::handleConnect, this, session, boost::asio::placeholders::error));
+													boost::bind( &Client::handleConnect, session, host, port, boost::asio::placeholders::error));
 			}
 			/**
 			 *
 			 */
-			void handleConnect( ClientSession* aSession,
-								const boost::system::error_code& error)
+			static void handleConnect(	std::shared_ptr< ClientSession > aSession,
+										const std::string& aHost,
+										const std::string& aPort,
+										const boost::system::error_code& error)
 			{
 				if (!error)
 				{
 					aSession->start();
 				} else
 				{
-					std::string sessionDestination =  "host = " + host + ", port =  "+ port;
-					delete aSession;
+					std::string sessionDestination =  "host = " + aHost + ", port =  "+ aPort;
 					throw std::runtime_error( __PRETTY_FUNCTION__ + std::string( ": ") + error.message() + ", " + sessionDestination);
 				}
 			}
@@ -0,0 +1,93 @@
+#include "CommandlineArguments.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+
+namespace Application
+{
+	/* static */std::vector< CommandlineArgument > CommandlineArguments::commandlineArguments;
+	/* static */std::vector< std::string > CommandlineArguments::commandlineFiles;
+
+	/* static */void CommandlineArguments::setCommandlineArguments( 	int argc,
+																char* argv[])
+	{
+
+		// argv[0] contains the executable name as one types on the command line (with or without extension)
+		CommandlineArguments::commandlineArguments.push_back( CommandlineArgument( 0, "Executable", argv[0]));
+
+		for (int i = 1; i < argc; ++i)
+		{
+			char* currentArg = argv[i];
+			size_t argLength = std::strlen( currentArg);
+
+
+			// If the first char of the argument is not a "-" we assume that is is
+			// a filename otherwise it is an ordinary argument
+
+			if (currentArg[0] == '-') // ordinary argument
+			{
+				bool inserted = false;
+
+				// First handle the arguments in the form of "variable=value", and find the "="
+
+				for (size_t j = 0; j < argLength; ++j)
+				{
+					if (currentArg[j] == '=')
+					{
+						std::string variable( currentArg, j);
+						std::string value( &currentArg[j + 1]);
+						CommandlineArguments::commandlineArguments.push_back( CommandlineArgument( i, variable, value));
+						inserted = true;
+					}
+				}
+
+				// Second handle the stand alone arguments.
+
+				// If inserted is
+
+				// It is assumed that they are actually booleans.
+				// If given on the command line than the variable will be set to true as if
+				// variable=true is passed
+				if (inserted == false)
+				{
+					std::string variable( currentArg);
+					std::string value( "true");
+					CommandlineArguments::commandlineArguments.push_back( CommandlineArgument( i, variable, value));
+				}
+			} else // file argument
+			{
+				CommandlineArguments::commandlineFiles.push_back( currentArg);
+			}
+		}
+	}
+
+	/* static */bool CommandlineArguments::isArgGiven( const std::string& aVariable)
+	{
+		std::vector< CommandlineArgument >::iterator i = std::find( CommandlineArguments::commandlineArguments.begin(), CommandlineArguments::commandlineArguments.end(), aVariable);
+		return i != commandlineArguments.end();
+	}
+
+	/* static */CommandlineArgument& CommandlineArguments::getArg( const std::string& aVariable)
+	{
+		std::vector< CommandlineArgument >::iterator i = std::find( CommandlineArguments::commandlineArguments.begin(), CommandlineArguments::commandlineArguments.end(), aVariable);
+		if (i == CommandlineArguments::commandlineArguments.end())
+		{
+			throw std::invalid_argument( "No such command line argument");
+		}
+		return *i;
+	}
+
+	/* static */CommandlineArgument& CommandlineArguments::getArg( unsigned long anArgumentNumber)
+	{
+		if(anArgumentNumber >= CommandlineArguments::commandlineArguments.size())
+		{
+			throw std::invalid_argument( "No such command line argument");
+		}
+		return CommandlineArguments::commandlineArguments[anArgumentNumber];
+	}
+
+	/* static */std::vector< std::string >& CommandlineArguments::getCommandlineFiles()
+	{
+		return commandlineFiles;
+	}
+} // namespace Application
@@ -34,7 +34,8 @@ namespace Messaging
 	/**
 	 *
 	 */
-	CommunicationService::CommunicationService()
+	CommunicationService::CommunicationService() :
+								running( false)
 	{
 	}
 	/**
@@ -55,15 +56,19 @@ namespace Messaging
 			Messaging::Server server( aPort, aRequestHandler);
 
 			// Run the service until further notice
+			running = true;
 			getIOService().run();
+			running = false;
 		}
 
 		catch (std::exception& e)
 		{
+			running = false;
 			std::cerr << e.what() << std::endl;
 		}
 		catch (...)
 		{
+			running = false;
 			std::cerr << "Unknown exception" << std::endl;
 		}
 
@@ -3,6 +3,8 @@
 
 #include "Config.hpp"
 
+#include <atomic>
+
 #include <boost/asio.hpp>
 
 #include "Thread.hpp"
@@ -29,6 +31,9 @@ namespace Messaging
 			 * Runs the given aRequestHandler at the given port until boost::asio::io_service::io_service.run()
 			 * returns. In the limited context of RobotWorld this is done by sending a "stop"-message.
 			 * @see ServerSession::handleMessageRead( Message& aMessage) for the implementation.
+			 *
+			 * The thread that runs the io_service only does the socket I/O, the requests and responses
+			 * are handled in tasks on the shared WorkStealingPool.
 			 */
 			void runRequestHandler(	RequestHandlerPtr aRequestHandler,
 									short aPort = 12345);
@@ -41,6 +46,14 @@ namespace Messaging
 			{
 				runRequestHandler(aRequestHandler,std::stoi(aPort));
 			}
+			/**
+			 * @return true while a request handler is running the io_service. Outgoing messages
+			 * are only handled while it runs, e.g. not in the headless simulator.
+			 */
+			bool isRunning() const
+			{
+				return running;
+			}
 		private:
 			/**
 			 *
@@ -63,6 +76,10 @@ namespace Messaging
 			 *
 			 */
 			boost::asio::io_service io_service;
+			/**
+			 *
+			 */
+			std::atomic< bool > running;
 	};
 	// class CommunicationService
 } // namespace Messaging
@@ -12,4 +12,10 @@ namespace Base
 	DebugTraceFunction::~DebugTraceFunction()
 	{
 	}
+	/**
+	 *
+	 */
+	void DebugTraceFunction::flush()
+	{
+	}
 } // namespace Base
@@ -29,6 +29,10 @@ namespace Base
 			 * @param aText The text that will be send to the final trace destination.
 			 */
 			virtual void trace( const std::string& aText) = 0;
+			/**
+			 * Called after a batch of traces, the default does nothing
+			 */
+			virtual void flush();
 	};
 } // namespace Base
 #endif /* DEBUGTRACEFUNCTION_HPP_ */
@@ -0,0 +1,203 @@
+#include "EventBus.hpp"
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <unordered_map>
+#include "WorkStealingPool.hpp"
+
+namespace Base
+{
+	/**
+	 *
+	 */
+	ChangeEvent::ChangeEvent(	const ObjectId& anObjectId /*= ObjectId()*/,
+								unsigned aFields /*= All*/) :
+									objectId( anObjectId),
+									fields( aFields)
+	{
+	}
+	/**
+	 *
+	 */
+	std::string ChangeEvent::asString() const
+	{
+		std::ostringstream os;
+		os << "ChangeEvent " << objectId << ": 0x" << std::hex << fields;
+		return os.str();
+	}
+	/**
+	 *
+	 */
+	EventBus::Subscription::Subscription(	const Handler& aHandler,
+											const Executor& anExecutor,
+											std::size_t aQueueCapacity) :
+												handler( aHandler),
+												executor( anExecutor),
+												queue( aQueueCapacity, OverflowPolicy::DropOldest),
+												active( true),
+												scheduled( false),
+												merged( 0),
+												deliveries( 0),
+												lastDropped( 0)
+	{
+	}
+	/**
+	 *
+	 */
+	void EventBus::Subscription::deliver( const std::shared_ptr< Subscription >& aSelf)
+	{
+		try
+		{
+			std::vector< ChangeEvent > events;
+			unsigned long dropped = queue.getDropped();
+			queue.dequeue( std::back_inserter( events), queue.capacity());
+
+			if (active && !events.empty())
+			{
+				// Merge the events per object, in the order the objects first changed
+				ChangeEvents changeEvents;
+				std::unordered_map< ObjectId, std::size_t > positions;
+				for (const ChangeEvent& event : events)
+				{
+					auto i = positions.find( event.objectId);
+					if (i == positions.end())
+					{
+						positions.insert( std::make_pair( event.objectId, changeEvents.size()));
+						changeEvents.push_back( event);
+					} else
+					{
+						changeEvents[i->second].fields |= event.fields;
+						++merged;
+					}
+				}
+				if (dropped != lastDropped)
+				{
+					lastDropped = dropped;
+					changeEvents.push_back( ChangeEvent());
+				}
+
+				++deliveries;
+				handler( changeEvents);
+			}
+		}
+		catch (std::exception& e)
+		{
+			std::cerr << __PRETTY_FUNCTION__ << ": " << e.what() << std::endl;
+		}
+		catch (...)
+		{
+			std::cerr << __PRETTY_FUNCTION__ << ": unknown exception" << std::endl;
+		}
+
+		// An event published during the delivery did not schedule one because this one was pending
+		scheduled = false;
+		if (active && !queue.empty())
+		{
+			schedule( aSelf);
+		}
+	}
+	/**
+	 *
+	 */
+	void EventBus::Subscription::schedule( const std::shared_ptr< Subscription >& aSelf)
+	{
+		if (!scheduled.exchange( true))
+		{
+			std::shared_ptr< Subscription > self = aSelf;
+			executor( [self]
+			{
+				self->deliver( self);
+			});
+		}
+	}
+	/**
+	 *
+	 */
+	/* static */EventBus& EventBus::getEventBus()
+	{
+		static EventBus eventBus;
+		return eventBus;
+	}
+	/**
+	 *
+	 */
+	/* static */EventBus::Executor EventBus::getPoolExecutor()
+	{
+		return [](const Delivery& aDelivery)
+		{
+			WorkStealingPool::getWorkStealingPool().submit( aDelivery, "event");
+		};
+	}
+	/**
+	 *
+	 */
+	EventBus::EventBus() :
+							subscriptions( std::make_shared< Subscriptions >())
+	{
+	}
+	/**
+	 *
+	 */
+	EventBus::SubscriptionPtr EventBus::subscribe(	const Handler& aHandler,
+													const Executor& anExecutor,
+													std::size_t aQueueCapacity /*= 4096*/)
+	{
+		SubscriptionPtr subscription = std::make_shared< Subscription >( aHandler, anExecutor, aQueueCapacity);
+
+		std::lock_guard< std::mutex > lock( subscriptionsMutex);
+		std::shared_ptr< Subscriptions > newSubscriptions = std::make_shared< Subscriptions >( *std::atomic_load( &subscriptions));
+		newSubscriptions->push_back( subscription);
+		std::atomic_store( &subscriptions, std::shared_ptr< const Subscriptions >( newSubscriptions));
+		return subscription;
+	}
+	/**
+	 *
+	 */
+	void EventBus::unsubscribe( const SubscriptionPtr& aSubscription)
+	{
+		if (!aSubscription)
+		{
+			return;
+		}
+		aSubscription->active = false;
+
+		std::lock_guard< std::mutex > lock( subscriptionsMutex);
+		std::shared_ptr< Subscriptions > newSubscriptions = std::make_shared< Subscriptions >( *std::atomic_load( &subscriptions));
+		newSubscriptions->erase( std::remove( newSubscriptions->begin(), newSubscriptions->end(), aSubscription), newSubscriptions->end());
+		std::atomic_store( &subscriptions, std::shared_ptr< const Subscriptions >( newSubscriptions));
+	}
+	/**
+	 *
+	 */
+	void EventBus::publish( const ChangeEvent& aChangeEvent)
+	{
+		std::shared_ptr< const Subscriptions > currentSubscriptions = std::atomic_load( &subscriptions);
+		for (const SubscriptionPtr& subscription : *currentSubscriptions)
+		{
+			subscription->queue.enqueue( aChangeEvent);
+			subscription->schedule( subscription);
+		}
+	}
+	/**
+	 *
+	 */
+	bool EventBus::hasSubscribers() const
+	{
+		return !std::atomic_load( &subscriptions)->empty();
+	}
+	/**
+	 *
+	 */
+	std::string EventBus::asString() const
+	{
+		std::ostringstream os;
+		std::shared_ptr< const Subscriptions > currentSubscriptions = std::atomic_load( &subscriptions);
+		os << "EventBus: " << currentSubscriptions->size() << " subscriptions";
+		for (const SubscriptionPtr& subscription : *currentSubscriptions)
+		{
+			os << ", " << subscription->getDeliveries() << " deliveries/" << subscription->getMerged() << " merged/" << subscription->getDropped() << " dropped";
+		}
+		return os.str();
+	}
+} // namespace Base
@@ -0,0 +1,217 @@
+#ifndef EVENTBUS_HPP_
+#define EVENTBUS_HPP_
+
+#include "Config.hpp"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ObjectId.hpp"
+#include "RingBuffer.hpp"
+#include "Thread.hpp"
+
+namespace Base
+{
+	/**
+	 * What changed of which object
+	 */
+	class ChangeEvent
+	{
+		public:
+			/**
+			 * The fields of an object that can change, or'ed together in fields
+			 */
+			enum Field : unsigned
+			{
+				Added = 1 << 0,
+				Removed = 1 << 1,
+				Position = 1 << 2,
+				Front = 1 << 3,
+				Speed = 1 << 4,
+				Size = 1 << 5,
+				Name = 1 << 6,
+				Path = 1 << 7,
+				Other = 1 << 8,
+				All = ~0U
+			};
+			/**
+			 * A null anObjectId with All fields means that anything may have changed
+			 */
+			ChangeEvent(	const ObjectId& anObjectId = ObjectId(),
+							unsigned aFields = All);
+			/**
+			 *
+			 */
+			bool has( unsigned someFields) const
+			{
+				return (fields & someFields) != 0;
+			}
+			/**
+			 * @name Debug functions
+			 */
+			//@{
+			/**
+			 * Returns a 1-line description of the object
+			 */
+			std::string asString() const;
+			//@}
+
+			ObjectId objectId;
+			unsigned fields;
+	};
+	// class ChangeEvent
+
+	/**
+	 * Delivers ChangeEvents asynchronously to its subscribers.
+	 *
+	 * publish() only puts the event in the lock-free queue of every subscriber and, if no delivery is
+	 * pending for that subscriber, hands one to the Executor of the subscriber (e.g. the GUI thread or
+	 * the shared WorkStealingPool). A delivery takes everything that is in the queue, merges the events
+	 * of the same object into one and calls the Handler once with the result. So the thread that
+	 * publishes never waits for a subscriber, and a subscriber that is slow gets fewer, merged events.
+	 *
+	 * If the queue of a subscriber overflows the oldest events are dropped and the next delivery
+	 * contains a ChangeEvent with a null ObjectId that tells that anything may have changed.
+	 */
+	class EventBus
+	{
+		public:
+			typedef std::vector< ChangeEvent > ChangeEvents;
+			/**
+			 * Called with the merged events of one delivery
+			 */
+			typedef std::function< void( const ChangeEvents&) > Handler;
+			typedef std::function< void() > Delivery;
+			/**
+			 * Runs a Delivery on the thread the subscriber wants its events on
+			 */
+			typedef std::function< void( const Delivery&) > Executor;
+
+			/**
+			 *
+			 */
+			class Subscription
+			{
+				public:
+					/**
+					 *
+					 */
+					Subscription(	const Handler& aHandler,
+									const Executor& anExecutor,
+									std::size_t aQueueCapacity);
+					/**
+					 * The number of events that were merged with an earlier event of the same object
+					 */
+					unsigned long getMerged() const
+					{
+						return merged;
+					}
+					/**
+					 * The number of events that were dropped because the queue was full
+					 */
+					unsigned long getDropped() const
+					{
+						return queue.getDropped();
+					}
+					/**
+					 * The number of calls of the Handler
+					 */
+					unsigned long getDeliveries() const
+					{
+						return deliveries;
+					}
+
+				private:
+					friend class EventBus;
+
+					/**
+					 * Runs on the Executor
+					 */
+					void deliver( const std::shared_ptr< Subscription >& aSelf);
+					/**
+					 * Hands a delivery to the Executor unless one is pending already
+					 */
+					void schedule( const std::shared_ptr< Subscription >& aSelf);
+
+					Handler handler;
+					Executor executor;
+					RingBuffer< ChangeEvent, Producers::Multiple > queue;
+					std::atomic< bool > active;
+					std::atomic< bool > scheduled;
+					std::atomic< unsigned long > merged;
+					std::atomic< unsigned long > deliveries;
+					/**
+					 * The dropped count at the previous delivery
+					 */
+					unsigned long lastDropped;
+			};
+			// class Subscription
+			typedef std::shared_ptr< Subscription > SubscriptionPtr;
+
+			/**
+			 * The bus the model publishes its changes on
+			 */
+			static EventBus& getEventBus();
+			/**
+			 * An Executor that runs the deliveries on the shared WorkStealingPool
+			 */
+			static Executor getPoolExecutor();
+			/**
+			 *
+			 */
+			EventBus();
+			/**
+			 *
+			 */
+			EventBus( const EventBus& anEventBus) = delete;
+			/**
+			 *
+			 */
+			EventBus& operator=( const EventBus& anEventBus) = delete;
+			/**
+			 * aHandler is called on anExecutor until unsubscribe is called
+			 */
+			SubscriptionPtr subscribe(	const Handler& aHandler,
+										const Executor& anExecutor,
+										std::size_t aQueueCapacity = 4096);
+			/**
+			 * No delivery starts after this returns, but with an Executor on another thread
+			 * a delivery may still be running
+			 */
+			void unsubscribe( const SubscriptionPtr& aSubscription);
+			/**
+			 *
+			 */
+			void publish( const ChangeEvent& aChangeEvent);
+			/**
+			 *
+			 */
+			bool hasSubscribers() const;
+			/**
+			 * @name Debug functions
+			 */
+			//@{
+			/**
+			 * Returns a 1-line description of the object
+			 */
+			std::string asString() const;
+			//@}
+
+		private:
+			typedef std::vector< SubscriptionPtr > Subscriptions;
+
+			/**
+			 * Only accessed with std::atomic_load and std::atomic_store, so publish takes no lock
+			 */
+			std::shared_ptr< const Subscriptions > subscriptions;
+			/**
+			 * Serialises subscribe and unsubscribe
+			 */
+			std::mutex subscriptionsMutex;
+	};
+	// class EventBus
+} // namespace Base
+#endif // EVENTBUS_HPP_
@@ -0,0 +1,32 @@
+#include "FileDebugTraceFunction.hpp"
+#include <stdexcept>
+
+namespace Base
+{
+	/**
+	 *
+	 */
+	FileDebugTraceFunction::FileDebugTraceFunction( const std::string& aFileName) :
+								fileName( aFileName),
+								file( aFileName.c_str(), std::ios::out | std::ios::app)
+	{
+		if (!file)
+		{
+			throw std::runtime_error( "Can not open " + aFileName);
+		}
+	}
+	/**
+	 *
+	 */
+	void FileDebugTraceFunction::trace( const std::string& aText)
+	{
+		file << aText << '\n';
+	}
+	/**
+	 *
+	 */
+	void FileDebugTraceFunction::flush()
+	{
+		file.flush();
+	}
+} // namespace Base
@@ -0,0 +1,45 @@
+#ifndef FILEDEBUGTRACEFUNCTION_HPP_
+#define FILEDEBUGTRACEFUNCTION_HPP_
+
+#include "Config.hpp"
+
+#include <fstream>
+#include <string>
+
+#include "DebugTraceFunction.hpp"
+
+namespace Base
+{
+	/**
+	 * Appends the traces to a file, one per line
+	 */
+	class FileDebugTraceFunction : public DebugTraceFunction
+	{
+		public:
+			/**
+			 * @throws std::runtime_error if aFileName can not be opened
+			 */
+			explicit FileDebugTraceFunction( const std::string& aFileName);
+			/**
+			 *
+			 * @param aText The text that will be send to the final trace destination.
+			 */
+			virtual void trace( const std::string& aText);
+			/**
+			 *
+			 */
+			virtual void flush();
+			/**
+			 *
+			 */
+			const std::string& getFileName() const
+			{
+				return fileName;
+			}
+		private:
+			std::string fileName;
+			std::ofstream file;
+	};
+	// class FileDebugTraceFunction
+} // namespace Base
+#endif // FILEDEBUGTRACEFUNCTION_HPP_
@@ -0,0 +1,239 @@
+#include "Config.hpp"
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+#include "CommandlineArguments.hpp"
+#include "FileDebugTraceFunction.hpp"
+#include "Logger.hpp"
+#include "Metrics.hpp"
+#include "StdOutDebugTraceFunction.hpp"
+#include "RobotWorld.hpp"
+#include "Robot.hpp"
+#include "Goal.hpp"
+#include "ScenarioRunner.hpp"
+#include "SimulationClock.hpp"
+#include "TraceLog.hpp"
+
+namespace
+{
+	typedef Application::CommandlineArguments Arguments;
+
+	/**
+	 * Splits "a,b,c" into its values
+	 */
+	template< typename ValueType >
+	std::vector< ValueType > parseList( const std::string& aList)
+	{
+		std::vector< ValueType > values;
+		std::istringstream is( aList);
+		std::string item;
+		while (std::getline( is, item, ','))
+		{
+			std::istringstream itemStream( item);
+			ValueType value;
+			if (!(itemStream >> value))
+			{
+				throw std::invalid_argument( "Invalid value in list: " + aList);
+			}
+			values.push_back( value);
+		}
+		return values;
+	}
+	/**
+	 * Splits "40x30,60x40" into sizes
+	 */
+	std::vector< Size > parseSizes( const std::string& aList)
+	{
+		std::vector< Size > sizes;
+		for (const std::string& item : parseList< std::string >( aList))
+		{
+			std::string::size_type x = item.find( 'x');
+			if (x == std::string::npos)
+			{
+				throw std::invalid_argument( "Invalid size, expected WIDTHxHEIGHT: " + item);
+			}
+			sizes.push_back( Size( std::stoi( item.substr( 0, x)), std::stoi( item.substr( x + 1))));
+		}
+		return sizes;
+	}
+	/**
+	 *
+	 */
+	std::string getArg(	const std::string& aVariable,
+						const std::string& aDefault)
+	{
+		return Arguments::isArgGiven( aVariable) ? Arguments::getArg( aVariable).value : aDefault;
+	}
+	/**
+	 * Runs the parameter sweep and writes the aggregate statistics
+	 */
+	int runSweep( unsigned long aMaximumTicks)
+	{
+		Model::ParameterGrid parameterGrid;
+		parameterGrid.speeds = parseList< float >( getArg( "-speeds", "10"));
+		parameterGrid.safetyMargins = parseList< unsigned short >( getArg( "-safety_margins", "80"));
+		parameterGrid.footprints = parseSizes( getArg( "-footprints", "40x30"));
+
+		std::string seeds = getArg( "-seeds", "1-10");
+		std::string::size_type dash = seeds.find( '-');
+		parameterGrid.firstSeed = std::stoul( seeds.substr( 0, dash));
+		parameterGrid.lastSeed = dash == std::string::npos ? parameterGrid.firstSeed : std::stoul( seeds.substr( dash + 1));
+
+		Model::ScenarioRunner scenarioRunner( parameterGrid);
+		scenarioRunner.setMaximumTicks( aMaximumTicks);
+		scenarioRunner.run( static_cast< unsigned short >(std::stoul( getArg( "-threads", "0"))));
+
+		std::string output = getArg( "-output", "");
+		std::string format = getArg( "-format", output.size() > 5 && output.substr( output.size() - 5) == ".json" ? "json" : "csv");
+
+		std::ofstream file;
+		if (!output.empty())
+		{
+			file.open( output);
+			if (!file)
+			{
+				throw std::runtime_error( "Cannot write " + output);
+			}
+		}
+		std::ostream& os = output.empty() ? std::cout : file;
+		if (format == "json")
+		{
+			scenarioRunner.writeJson( os);
+		} else
+		{
+			scenarioRunner.writeCsv( os);
+		}
+		return 0;
+	}
+	/**
+	 * Runs a single world and prints where the robot ended up
+	 */
+	int runSingle( unsigned long aMaximumTicks)
+	{
+		int numberOfWalls = std::stoi( getArg( "-walls", "1"));
+
+		// A world of its own with a clock that only advances when stepped, so that a run
+		// does not depend on the speed of the machine
+		Model::RobotWorld robotWorld;
+		Model::SimulationClock& clock = robotWorld.getSimulationClock();
+		clock.setMode( Model::SimulationClock::Mode::Paused);
+		if (Arguments::isArgGiven( "-time_step"))
+		{
+			clock.setTimeStep( std::chrono::milliseconds( std::stol( Arguments::getArg( "-time_step").value)));
+		}
+
+		robotWorld.populate( numberOfWalls);
+
+		// In the GUI the shapes size the objects to fit their title, here they get the size of a typical shape
+		for (Model::RobotPtr robot : robotWorld.getRobots())
+		{
+			robot->setSize( Size( 40, 30), false);
+		}
+		for (Model::GoalPtr goal : robotWorld.getGoals())
+		{
+			goal->setSize( Size( 40, 30), false);
+		}
+
+		Model::RobotPtr robot = robotWorld.getRobot( "Robot");
+		if (!robot)
+		{
+			throw std::runtime_error( "The world has no robot called \"Robot\"");
+		}
+		robot->startDriving();
+
+		unsigned long ticks = 0;
+		while (robot->isDriving() && ticks < aMaximumTicks)
+		{
+			clock.step();
+			++ticks;
+		}
+		Model::GoalPtr goal = robotWorld.getGoal( "Goal");
+		bool arrived = goal && robot->intersects( goal->getRegion());
+		robot->stopDriving();
+
+		std::cout << "ticks: " << ticks << "\n"
+				  << "simulated time: " << clock.getSimulatedTime().count() << " ms\n"
+				  << "position: " << robot->getPosition().x << "," << robot->getPosition().y << "\n"
+				  << "arrived: " << (arrived ? "yes" : "no") << std::endl;
+
+		return arrived ? 0 : 1;
+	}
+} // namespace
+
+/**
+ * The entry point of robotworld_sim, the simulator without a GUI.
+ *
+ * By default it populates a world, lets "Robot" drive to "Goal" on the SimulationClock and prints where it
+ * ended up. With -sweep it runs a Monte-Carlo parameter sweep on all cores and writes the statistics.
+ *
+ * Command line arguments:
+ * -ticks=N					the maximum number of ticks to run a world, 1000 by default
+ * -time_step=N				the simulated time step in milliseconds, 100 by default
+ * -walls=N					the number of walls, 1 by default
+ * -verbose					log to stdout
+ * -log_file=FILE			log to FILE, appending, instead of to stdout
+ * -log_level=LEVEL			trace, debug, info, warning or error; trace by default
+ * -trace=FILE				write a binary trace to FILE, see robotworld_trace
+ * -metrics=FILE			dump the metrics to FILE in the Prometheus text format
+ * -metrics_interval=N		dump every N milliseconds, 1000 by default
+ * -sweep					run a parameter sweep with:
+ * 		-speeds=A,B,...				10 by default
+ * 		-safety_margins=A,B,...		80 by default
+ * 		-footprints=WxH,WxH,...		40x30 by default
+ * 		-seeds=FIRST-LAST			1-10 by default
+ * 		-threads=N					one per hardware thread by default
+ * 		-output=FILE				stdout by default
+ * 		-format=csv|json			json if FILE ends with .json, csv otherwise
+ * Any other argument is handled as by the GUI application, e.g. -robot_type=client
+ */
+int main( 	int argc,
+			char* argv[])
+{
+	try
+	{
+		Arguments::setCommandlineArguments( argc, argv);
+
+		Application::Logger::setLevel( Application::Logger::levelFor( getArg( "-log_level", "trace")));
+
+		Base::StdOutDebugTraceFunction debugTraceFunction;
+		std::unique_ptr< Base::FileDebugTraceFunction > fileDebugTraceFunction;
+		if (Arguments::isArgGiven( "-log_file"))
+		{
+			fileDebugTraceFunction.reset( new Base::FileDebugTraceFunction( getArg( "-log_file", "")));
+			Application::Logger::setDebugTraceFunction( fileDebugTraceFunction.get());
+		} else if (Arguments::isArgGiven( "-verbose"))
+		{
+			Application::Logger::setDebugTraceFunction( &debugTraceFunction);
+		}
+
+		if (Arguments::isArgGiven( "-trace"))
+		{
+			Base::TraceLog::getTraceLog().open( getArg( "-trace", ""));
+		}
+		if (Arguments::isArgGiven( "-metrics"))
+		{
+			Base::Metrics::getMetrics().startDumping( getArg( "-metrics", ""), std::chrono::milliseconds( std::stol( getArg( "-metrics_interval", "1000"))));
+		}
+
+		unsigned long maximumTicks = std::stoul( getArg( "-ticks", "1000"));
+
+		int result = Arguments::isArgGiven( "-sweep") ? runSweep( maximumTicks) : runSingle( maximumTicks);
+
+		Base::TraceLog::getTraceLog().close();
+		Base::Metrics::getMetrics().stopDumping();
+		Application::Logger::setDebugTraceFunction( nullptr);
+		return result;
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << __PRETTY_FUNCTION__ << ": " << e.what() << std::endl;
+	}
+	catch (...)
+	{
+		std::cerr << __PRETTY_FUNCTION__ << ": unknown exception" << std::endl;
+	}
+	return 2;
+}
@@ -6,45 +6,204 @@
  */
 
 #include "LaserDistanceSensor.hpp"
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
 #include "Robot.hpp"
+#include "RobotWorld.hpp"
+#include "SegmentGrid.hpp"
 #include "Logger.hpp"
 
 namespace Model
 {
+	/* static */const double LaserDistanceSensor::noObject = -1.0;
 	/**
 	 *
 	 */
-	LaserDistanceSensor::LaserDistanceSensor()
+	LaserDistanceSensor::LaserDistanceSensor() :
+								robot( nullptr),
+								numberOfBeams( 360),
+								fieldOfView( 2 * Utils::PI),
+								range( 500.0)
 	{
 	}
 	/**
 	 *
 	 */
-	LaserDistanceSensor::LaserDistanceSensor( Robot* aRobot) :
-								AbstractSensor( aRobot)
+	LaserDistanceSensor::LaserDistanceSensor(	Robot* aRobot,
+												unsigned short aNumberOfBeams /*= 360*/,
+												double aFieldOfView /*= 2 * Utils::PI*/,
+												double aRange /*= 500.0*/) :
+								AbstractSensor( aRobot),
+								robot( aRobot),
+								numberOfBeams( aNumberOfBeams),
+								fieldOfView( 2 * Utils::PI),
+								range( 500.0)
 	{
+		// The same checks as for a change later on
+		setFieldOfView( aFieldOfView);
+		setRange( aRange);
 	}
 	/**
 	 *
 	 */
 	LaserDistanceSensor::~LaserDistanceSensor()
 	{
+		if (isOn())
+		{
+			setOff();
+		}
 	}
 	/**
 	 *
 	 */
 	std::shared_ptr< AbstractStimulus > LaserDistanceSensor::getStimulus() const
 	{
-		std::shared_ptr< AbstractStimulus > distanceStimulus( new DistanceStimulus( 666,666));
-		return distanceStimulus;
+		std::shared_ptr< DistanceStimuli > distanceStimuli = stimulusPool.acquire();
+		scan( *distanceStimuli);
+		return distanceStimuli;
 	}
 	/**
 	 *
 	 */
 	std::shared_ptr< AbstractPercept > LaserDistanceSensor::getPerceptFor( std::shared_ptr< AbstractStimulus > anAbstractStimulus) const
 	{
-		DistanceStimulus* distanceStimulus = dynamic_cast< DistanceStimulus* >( anAbstractStimulus.get());
-		return std::shared_ptr< AbstractPercept >( new DistancePercept( distanceStimulus->angle,distanceStimulus->distance));
+		std::shared_ptr< DistancePercepts > percepts = perceptPool.acquire();
+		percepts->pointCloud.clear();
+
+		if (DistanceStimuli* distanceStimuli = dynamic_cast< DistanceStimuli* >( anAbstractStimulus.get()))
+		{
+			convert( *distanceStimuli, *percepts);
+		} else if (DistanceStimulus* distanceStimulus = dynamic_cast< DistanceStimulus* >( anAbstractStimulus.get()))
+		{
+			percepts->pointCloud.push_back( DistancePercept( distanceStimulus->angle, distanceStimulus->distance));
+		}
+		return percepts;
+	}
+	/**
+	 *
+	 */
+	void LaserDistanceSensor::sample()
+	{
+		if (agent == nullptr)
+		{
+			return;
+		}
+		std::shared_ptr< DistanceStimuli > distanceStimuli = stimulusPool.acquire();
+		scan( *distanceStimuli);
+
+		std::shared_ptr< DistancePercepts > percepts = perceptPool.acquire();
+		percepts->pointCloud.clear();
+		convert( *distanceStimuli, *percepts);
+
+		sendPercept( percepts);
+	}
+	/**
+	 *
+	 */
+	void LaserDistanceSensor::scan( DistanceStimuli& aScan) const
+	{
+		// Clearing keeps the capacity of a pooled scan
+		aScan.stimuli.clear();
+		if (!robot || numberOfBeams == 0)
+		{
+			return;
+		}
+		aScan.stimuli.reserve( numberOfBeams);
+
+		RobotWorld& robotWorld = robot->getRobotWorld();
+		std::shared_ptr< const Utils::SegmentGrid > wallGrid = robotWorld.getWallGrid();
+
+		// The other robots move all the time so indexing them does not pay off, their outlines
+		// are tested with the same kernel the wall grid uses for a single cell. getStimulus and the
+		// scheduled sensor task may scan at the same time, so every thread has its own buffer, which
+		// keeps its capacity from scan to scan.
+		thread_local Utils::Segments robotEdges;
+		robotEdges.clear();
+		RobotWorld::SnapshotPtr snapshot = robotWorld.getSnapshot();
+		for (const RobotPtr& otherRobot : snapshot->robots)
+		{
+			if (otherRobot.get() == robot)
+			{
+				continue;
+			}
+			Point frontLeft = otherRobot->getFrontLeft();
+			Point frontRight = otherRobot->getFrontRight();
+			Point backRight = otherRobot->getBackRight();
+			Point backLeft = otherRobot->getBackLeft();
+			robotEdges.add( frontLeft, frontRight);
+			robotEdges.add( frontRight, backRight);
+			robotEdges.add( backRight, backLeft);
+			robotEdges.add( backLeft, frontLeft);
+		}
+
+		Point position = robot->getPosition();
+		BoundedVector front = robot->getFront();
+		double heading = std::atan2( front.y, front.x);
+
+		// A full circle has no end beams that coincide, a partial field of view includes both of its edges
+		double firstAngle = 0.0;
+		double step = 0.0;
+		if (numberOfBeams > 1)
+		{
+			bool fullCircle = fieldOfView >= 2 * Utils::PI;
+			firstAngle = -fieldOfView / 2;
+			step = fieldOfView / (fullCircle ? numberOfBeams : numberOfBeams - 1);
+		}
+
+		float maxRange = static_cast< float >(range);
+		for (unsigned short beam = 0; beam < numberOfBeams; ++beam)
+		{
+			double angle = firstAngle + beam * step;
+			float directionX = static_cast< float >(std::cos( heading + angle));
+			float directionY = static_cast< float >(std::sin( heading + angle));
+
+			float distance = wallGrid->castRay( static_cast< float >(position.x), static_cast< float >(position.y), directionX, directionY, maxRange);
+			distance = Utils::SegmentGrid::nearestHit( robotEdges, 0, robotEdges.size(), static_cast< float >(position.x), static_cast< float >(position.y), directionX, directionY, distance);
+
+			aScan.stimuli.push_back( DistanceStimulus( angle, distance < maxRange ? distance : noObject));
+		}
+	}
+	/**
+	 *
+	 */
+	void LaserDistanceSensor::convert(	const DistanceStimuli& aScan,
+										DistancePercepts& aPercepts) const
+	{
+		aPercepts.pointCloud.reserve( aScan.stimuli.size());
+		for (const DistanceStimulus& distanceStimulus : aScan.stimuli)
+		{
+			aPercepts.pointCloud.push_back( DistancePercept( distanceStimulus));
+		}
+	}
+	/**
+	 *
+	 */
+	void LaserDistanceSensor::setNumberOfBeams( unsigned short aNumberOfBeams)
+	{
+		numberOfBeams = aNumberOfBeams;
+	}
+	/**
+	 *
+	 */
+	void LaserDistanceSensor::setFieldOfView( double aFieldOfView)
+	{
+		if (aFieldOfView <= 0.0 || aFieldOfView > 2 * Utils::PI)
+		{
+			throw std::invalid_argument( "LaserDistanceSensor::setFieldOfView: field of view must be in (0,2*PI]");
+		}
+		fieldOfView = aFieldOfView;
+	}
+	/**
+	 *
+	 */
+	void LaserDistanceSensor::setRange( double aRange)
+	{
+		if (aRange <= 0.0)
+		{
+			throw std::invalid_argument( "LaserDistanceSensor::setRange: range must be positive");
+		}
+		range = aRange;
 	}
 	/**
 	 *
@@ -58,6 +217,8 @@ namespace Model
 	 */
 	std::string LaserDistanceSensor::asDebugString() const
 	{
-		return asString();
+		std::ostringstream os;
+		os << asString() << ": " << numberOfBeams << " beams, field of view " << fieldOfView << ", range " << range << ", pooled stimuli " << stimulusPool.size() << ", pooled percepts " << perceptPool.size();
+		return os.str();
 	}
 } // namespace Model
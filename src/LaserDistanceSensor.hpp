@@ -10,7 +10,11 @@
 
 #include "Config.hpp"
 
+#include <vector>
+
 #include "AbstractSensor.hpp"
+#include "MathUtils.hpp"
+#include "ObjectPool.hpp"
 
 namespace Model
 {
@@ -53,23 +57,58 @@ namespace Model
 	};
 	//	class DistancePercept
 
+	/**
+	 * The result of one laser scan: one DistanceStimulus per beam, in beam order
+	 */
+	class DistanceStimuli : public AbstractStimulus
+	{
+		public:
+			std::vector< DistanceStimulus, Base::CountingAllocator< DistanceStimulus > > stimuli;
+	};
+	// class DistanceStimuli
+
+	/**
+	 *
+	 */
+	class DistancePercepts : public AbstractPercept
+	{
+		public:
+			std::vector< DistancePercept, Base::CountingAllocator< DistancePercept > > pointCloud;
+	};
+	//	class DistancePercepts
+
 	class Robot;
 	typedef std::shared_ptr<Robot> RobotPtr;
 
 	/**
-	 *
+	 * A laser scanner: casts numberOfBeams rays, evenly spread over fieldOfView and centred
+	 * on the front of the robot, against the walls and the other robots in the world.
+	 * The angles of the stimuli are relative to the front of the robot, the distances of beams
+	 * that hit nothing within range are LaserDistanceSensor::noObject.
 	 */
 	class LaserDistanceSensor : public AbstractSensor
 	{
 		public:
+			/**
+			 * The distance of a beam that did not hit anything
+			 */
+			static const double noObject;
 			/**
 			 *
 			 */
 			LaserDistanceSensor();
 			/**
 			 *
+			 * @param aRobot The robot that carries the sensor
+			 * @param aNumberOfBeams The number of rays per scan
+			 * @param aFieldOfView The angle in radians over which the rays are spread
+			 * @param aRange The maximum distance a ray can measure
+			 * @throws std::invalid_argument as setFieldOfView and setRange do
 			 */
-			LaserDistanceSensor( Robot* aRobot);
+			LaserDistanceSensor(	Robot* aRobot,
+									unsigned short aNumberOfBeams = 360,
+									double aFieldOfView = 2 * Utils::PI,
+									double aRange = 500.0);
 			/**
 			 *
 			 */
@@ -82,6 +121,44 @@ namespace Model
 			 *
 			 */
 			virtual std::shared_ptr< AbstractPercept > getPerceptFor( std::shared_ptr< AbstractStimulus > anAbstractStimulus) const;
+			/**
+			 * Scans into a pooled DistanceStimuli and converts it into a pooled DistancePercepts without
+			 * going through the AbstractStimulus interface. Does not allocate in steady state.
+			 */
+			virtual void sample();
+			/**
+			 *
+			 */
+			unsigned short getNumberOfBeams() const
+			{
+				return numberOfBeams;
+			}
+			/**
+			 *
+			 */
+			void setNumberOfBeams( unsigned short aNumberOfBeams);
+			/**
+			 *
+			 */
+			double getFieldOfView() const
+			{
+				return fieldOfView;
+			}
+			/**
+			 *
+			 */
+			void setFieldOfView( double aFieldOfView);
+			/**
+			 *
+			 */
+			double getRange() const
+			{
+				return range;
+			}
+			/**
+			 *
+			 */
+			void setRange( double aRange);
 			/**
 			 * @name Debug functions
 			 */
@@ -97,7 +174,25 @@ namespace Model
 			//@}
 		protected:
 		private:
+			/**
+			 *
+			 */
+			void scan( DistanceStimuli& aScan) const;
+			/**
+			 *
+			 */
+			void convert(	const DistanceStimuli& aScan,
+							DistancePercepts& aPercepts) const;
 
+			Robot* robot;
+			unsigned short numberOfBeams;
+			double fieldOfView;
+			double range;
+			/**
+			 * Shared by all scans, whatever thread they run on, the pools lock themselves
+			 */
+			mutable Base::ObjectPool< DistanceStimuli > stimulusPool;
+			mutable Base::ObjectPool< DistancePercepts > perceptPool;
 	};
 } // namespace Model
 #endif /* LASERDISTANCESENSOR_HPP_ */
@@ -237,6 +237,13 @@ namespace View
 	void LineShape::setCentre( const Point& UNUSEDPARAM(aPoint))
 	{
 	}
+	/**
+	 *
+	 */
+	Rect LineShape::getBoundingBox() const
+	{
+		return Rect( node1->getCentre(), node2->getCentre()).Inflate( lineWidth + arrowHeadSize + 1);
+	}
 
 	/**
 	 *
@@ -70,6 +70,10 @@ namespace View
 			 *
 			 */
 			virtual void setCentre( const Point& aPoint);
+			/**
+			 * The line and its arrow head, not the title
+			 */
+			virtual Rect getBoundingBox() const;
 			//@}
 			/**
 			 *
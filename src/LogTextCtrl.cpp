@@ -1,4 +1,7 @@
 #include "LogTextCtrl.hpp"
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
 
 namespace Application
 {
@@ -6,37 +9,176 @@ namespace Application
 	 *
 	 */
 	wxDEFINE_EVENT(ROBOTWORLD_TRACE_EVENT, CommandEvent);
+	/**
+	 * The lines are taken in at most this often
+	 */
+	const int IngestMilliseconds = 1000 / 30;
 	/**
 	 *
 	 */
 	LogTextCtrl::LogTextCtrl( 	Window* aParent,
 								WindowId aWindowId /*  = DEFAULT_ID */,
-								long aStyle /* = wxTE_READONLY | wxTE_MULTILINE | wxTE_DONTWRAP */,
-								const std::string& anInitialText /* = "" */,
+								long aStyle /* = wxLC_REPORT | wxLC_VIRTUAL | wxLC_NO_HEADER | wxLC_SINGLE_SEL */,
+								std::size_t aMaximumLines /* = 10000 */,
 								const Point& aPoint /* = DefaultPosition */,
 								const Size& aSize /* = DefaultSize */) :
-								wxTextCtrl( aParent, aWindowId, WXSTRING( anInitialText), aPoint, aSize, aStyle)
+								wxListCtrl( aParent, aWindowId, aPoint, aSize, aStyle),
+								pending( 4096, Base::OverflowPolicy::DropOldest),
+								ingestPending( false),
+								ingestTimer( this),
+								lines( aMaximumLines),
+								firstLine( 0),
+								lineCount( 0)
 	{
+		if (aMaximumLines == 0)
+		{
+			throw std::invalid_argument( "A LogTextCtrl must keep at least 1 line");
+		}
+
+		// Wide enough for any line, the list scrolls horizontally
+		InsertColumn( 0, WXSTRING( ""), wxLIST_FORMAT_LEFT, 4000);
+		SetItemCount( 0);
+
 		Connect( ROBOTWORLD_TRACE_EVENT, wxCommandEventHandler( LogTextCtrl::OnCommandEvent));
+		Bind( wxEVT_TIMER, [this](TimerEvent& anEvent){ this->OnIngestTimer(anEvent);}, ingestTimer.GetId());
 	}
 	/**
 	 *
 	 */
 	LogTextCtrl::~LogTextCtrl()
 	{
+		ingestTimer.Stop();
 	}
 	/**
 	 *
 	 */
 	void LogTextCtrl::log( const std::string& aString)
 	{
-		AppendText( WXSTRING( aString + "\n"));
+		pending.enqueue( aString);
+		if (!ingestPending.exchange( true))
+		{
+			CommandEvent event( ROBOTWORLD_TRACE_EVENT);
+			wxPostEvent( this, event);
+		}
+	}
+	/**
+	 *
+	 */
+	void LogTextCtrl::setMaximumLines( std::size_t aMaximumLines)
+	{
+		if (aMaximumLines == 0)
+		{
+			throw std::invalid_argument( "A LogTextCtrl must keep at least 1 line");
+		}
+
+		std::size_t keep = std::min( lineCount, aMaximumLines);
+		std::vector< std::string > newLines( aMaximumLines);
+		for (std::size_t i = 0; i < keep; ++i)
+		{
+			newLines[i] = std::move( lines[(firstLine + lineCount - keep + i) % lines.size()]);
+		}
+		lines.swap( newLines);
+		firstLine = 0;
+		lineCount = keep;
+
+		SetItemCount( static_cast< long >(lineCount));
+		Refresh();
+	}
+	/**
+	 *
+	 */
+	const std::string& LogTextCtrl::getLine( std::size_t anIndex) const
+	{
+		if (anIndex >= lineCount)
+		{
+			throw std::out_of_range( "No such line in the LogTextCtrl");
+		}
+		return lines[(firstLine + anIndex) % lines.size()];
+	}
+	/**
+	 *
+	 */
+	void LogTextCtrl::clear()
+	{
+		for (std::string& line : lines)
+		{
+			line.clear();
+		}
+		firstLine = 0;
+		lineCount = 0;
+
+		SetItemCount( 0);
+		Refresh();
+	}
+	/**
+	 *
+	 */
+	wxString LogTextCtrl::OnGetItemText(	long anItem,
+											long UNUSEDPARAM(aColumn)) const
+	{
+		if (anItem < 0 || static_cast< std::size_t >(anItem) >= lineCount)
+		{
+			return wxString();
+		}
+		return WXSTRING( getLine( static_cast< std::size_t >(anItem)));
 	}
 	/**
 	 *
 	 */
 	void LogTextCtrl::OnCommandEvent( CommandEvent& anEvent)
 	{
-		log( STDSTRING( anEvent.GetString()));
+		if (!anEvent.GetString().IsEmpty())
+		{
+			pending.enqueue( STDSTRING( anEvent.GetString()));
+		}
+		if (!ingestTimer.IsRunning())
+		{
+			ingestTimer.StartOnce( IngestMilliseconds);
+		}
+	}
+	/**
+	 *
+	 */
+	void LogTextCtrl::OnIngestTimer( TimerEvent& UNUSEDPARAM(anEvent))
+	{
+		ingest();
+	}
+	/**
+	 *
+	 */
+	void LogTextCtrl::ingest()
+	{
+		// A line logged from now on posts a new event
+		ingestPending = false;
+
+		std::vector< std::string > batch;
+		if (pending.dequeue( std::back_inserter( batch), pending.capacity()) == 0)
+		{
+			return;
+		}
+
+		// Only follow the new lines if the last line was visible
+		bool followNewLines = lineCount == 0 || GetTopItem() + GetCountPerPage() >= static_cast< long >(lineCount);
+
+		for (std::string& line : batch)
+		{
+			if (lineCount < lines.size())
+			{
+				lines[(firstLine + lineCount) % lines.size()] = std::move( line);
+				++lineCount;
+			} else
+			{
+				// Full: the new line takes the place of the oldest one
+				lines[firstLine] = std::move( line);
+				firstLine = (firstLine + 1) % lines.size();
+			}
+		}
+
+		SetItemCount( static_cast< long >(lineCount));
+		if (followNewLines)
+		{
+			EnsureVisible( static_cast< long >(lineCount) - 1);
+		}
+		Refresh();
 	}
 } // namespace Application
@@ -2,20 +2,33 @@
 #define LOGTEXTCTRL_HPP_
 
 #include "Config.hpp"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
 #include "Widgets.hpp"
 #include "Point.hpp"
+#include "RingBuffer.hpp"
 #include "Size.hpp"
 
 namespace Application
 {
 	/**
-	 *
+	 * Asks a LogTextCtrl to take in the lines that were logged. A non-empty string of the event is
+	 * logged first.
 	 */
 	wxDECLARE_EVENT(ROBOTWORLD_TRACE_EVENT, CommandEvent);
 	/**
-	 * A text widget that accepts the tracing of a trace function.
+	 * A log view that accepts the tracing of a trace function.
+	 *
+	 * It keeps only the last getMaximumLines() lines, in a ring of strings, and is a virtual list:
+	 * only the lines that are visible are ever turned into text on the screen. log() may be called
+	 * from any thread. It only queues the line and, if none is pending, posts a single
+	 * ROBOTWORLD_TRACE_EVENT. The GUI thread then takes in everything that was queued at most once
+	 * per frame, so a burst of lines costs one update of the view.
 	 */
-	class LogTextCtrl : public wxTextCtrl
+	class LogTextCtrl : public wxListCtrl
 	{
 		public:
 			/**
@@ -27,24 +40,81 @@ namespace Application
 			 */
 			LogTextCtrl( 	Window* aParent,
 							WindowId aWindowId = DEFAULT_ID,
-							long aStyle = wxTE_READONLY | wxTE_MULTILINE | wxTE_DONTWRAP,
-							const std::string& anInitialText = "",
+							long aStyle = wxLC_REPORT | wxLC_VIRTUAL | wxLC_NO_HEADER | wxLC_SINGLE_SEL,
+							std::size_t aMaximumLines = 10000,
 							const Point& aPoint = DefaultPosition,
 							const Size& aSize = DefaultSize);
 			virtual ~LogTextCtrl();
 			//@}
 			/**
+			 * Queues aString, may be called from any thread
 			 *
 			 * @param aString
 			 */
 			virtual void log( const std::string& aString);
+			/**
+			 *
+			 */
+			std::size_t getMaximumLines() const
+			{
+				return lines.size();
+			}
+			/**
+			 * Keeps the last aMaximumLines lines
+			 *
+			 * @throws std::invalid_argument if aMaximumLines is 0
+			 */
+			void setMaximumLines( std::size_t aMaximumLines);
+			/**
+			 * The number of lines in the view
+			 */
+			std::size_t getLineCount() const
+			{
+				return lineCount;
+			}
+			/**
+			 * The line at anIndex in the view, 0 is the oldest
+			 */
+			const std::string& getLine( std::size_t anIndex) const;
+			/**
+			 *
+			 */
+			void clear();
 		protected:
+			/**
+			 * Called by wxListCtrl for the visible lines only
+			 */
+			virtual wxString OnGetItemText(	long anItem,
+											long aColumn) const;
 			/**
 			 *
 			 * @param anEvent
 			 */
 			void OnCommandEvent( CommandEvent& anEvent);
+			/**
+			 *
+			 */
+			void OnIngestTimer( TimerEvent& anEvent);
+			/**
+			 * Moves the queued lines into the ring and updates the view
+			 */
+			void ingest();
 		private:
+			/**
+			 * The lines that were logged but are not in the view yet
+			 */
+			Base::RingBuffer< std::string, Base::Producers::Multiple > pending;
+			/**
+			 * True from the moment a ROBOTWORLD_TRACE_EVENT is posted until the lines are taken in
+			 */
+			std::atomic< bool > ingestPending;
+			Timer ingestTimer;
+			/**
+			 * The ring, the oldest line is at firstLine
+			 */
+			std::vector< std::string > lines;
+			std::size_t firstLine;
+			std::size_t lineCount;
 	};
 	// class LogTextCtrl
 } // namespace Application
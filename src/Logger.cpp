@@ -1,30 +1,194 @@
 #include "Logger.hpp"
-#include "MainApplication.hpp"
-#include "MainFrameWindow.hpp"
 #include "DebugTraceFunction.hpp"
+#include "RingBuffer.hpp"
+#include "Thread.hpp"
 
 #include <chrono>
 #include <ctime>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
 
 namespace Application {
-/* static */bool Logger::disable = false;
+namespace {
 /**
- *
+ * A message as it waits for the writer
  */
-/*static*/void Logger::log(const std::string& aMessage) {
-	Application::MainFrameWindow* frame =
-			dynamic_cast<Application::MainFrameWindow*>(Application::TheApp().GetTopWindow());
-	if (frame && !disable) {
-		time_t rawtime;
-		struct tm * timeinfo;
-		char buffer[80];
+struct Record {
+	Logger::Level level;
+	std::chrono::system_clock::time_point time;
+	std::string message;
+};
+/**
+ * The queue and the background thread that empties it into the DebugTraceFunction
+ */
+class Writer {
+public:
+	/**
+	 *
+	 */
+	Writer() :
+			queue(8192, Base::OverflowPolicy::DropNewest), stopping(false), sleeping(
+					false), reportedDropped(0), lastSecond(0) {
+		thread = std::thread([this] {run();});
+	}
+	/**
+	 *
+	 */
+	~Writer() {
+		stopping = true;
+		wakeUp.notify_one();
+		thread.join();
+	}
+	/**
+	 *
+	 */
+	void enqueue(Record&& aRecord) {
+		queue.enqueue(std::move(aRecord));
+		if (sleeping.load(std::memory_order_relaxed)) {
+			wakeUp.notify_one();
+		}
+	}
+	/**
+	 * Traces everything that is in the queue to aDebugTraceFunction
+	 */
+	void drain(Base::DebugTraceFunction* aDebugTraceFunction) {
+		std::vector<Record> records;
+		while (queue.dequeue(std::back_inserter(records), 256) > 0) {
+			write(aDebugTraceFunction, records);
+			records.clear();
+		}
+		reportDropped(aDebugTraceFunction);
+		if (aDebugTraceFunction) {
+			aDebugTraceFunction->flush();
+		}
+	}
+	/**
+	 *
+	 */
+	unsigned long getDropped() const {
+		return queue.getDropped();
+	}
+	/**
+	 * Serialises the writer with Logger::setDebugTraceFunction and Logger::flush
+	 */
+	std::mutex debugTraceFunctionMutex;
+
+private:
+	/**
+	 *
+	 */
+	void run() {
+		std::vector<Record> records;
+		while (!stopping) {
+			{
+				std::lock_guard<std::mutex> lock(debugTraceFunctionMutex);
+				// Dequeued under the lock so no message can overtake another one
+				if (queue.dequeue(std::back_inserter(records), 256) > 0) {
+					Base::DebugTraceFunction* debugTraceFunction =
+							Logger::getDebugTraceFunction();
+					write(debugTraceFunction, records);
+					reportDropped(debugTraceFunction);
+					if (debugTraceFunction) {
+						debugTraceFunction->flush();
+					}
+					records.clear();
+					continue;
+				}
+			}
+
+			std::unique_lock<std::mutex> lock(wakeUpMutex);
+			sleeping = true;
+			wakeUp.wait_for(lock, std::chrono::milliseconds(50),
+					[this] {return stopping || !queue.empty();});
+			sleeping = false;
+		}
+	}
+	/**
+	 *
+	 */
+	void write(Base::DebugTraceFunction* aDebugTraceFunction,
+			const std::vector<Record>& someRecords) {
+		if (!aDebugTraceFunction) {
+			return;
+		}
+		for (const Record& record : someRecords) {
+			aDebugTraceFunction->trace(
+					timeStampFor(record.time) + ";" + Logger::nameOf(record.level)
+							+ ";" + record.message);
+		}
+	}
+	/**
+	 *
+	 */
+	void reportDropped(Base::DebugTraceFunction* aDebugTraceFunction) {
+		unsigned long dropped = queue.getDropped();
+		if (aDebugTraceFunction && dropped != reportedDropped) {
+			aDebugTraceFunction->trace(
+					timeStampFor(std::chrono::system_clock::now()) + ";"
+							+ Logger::nameOf(Logger::Level::Warning) + ";"
+							+ std::to_string(dropped - reportedDropped)
+							+ " log messages dropped");
+			reportedDropped = dropped;
+		}
+	}
+	/**
+	 * Formatted once per second, as the messages of a batch mostly are of the same second
+	 */
+	const std::string& timeStampFor(
+			const std::chrono::system_clock::time_point& aTime) {
+		std::time_t seconds = std::chrono::system_clock::to_time_t(aTime);
+		if (seconds != lastSecond || lastTimeStamp.empty()) {
+			struct tm timeinfo;
+			char buffer[80];
+			// localtime_r is POSIX, MinGW has localtime_s
+#ifdef __MINGW32__
+			localtime_s(&timeinfo, &seconds);
+#else
+			localtime_r(&seconds, &timeinfo);
+#endif
+			strftime(buffer, sizeof(buffer), "%d-%m-%Y %I:%M:%S", &timeinfo);
+			lastTimeStamp = buffer;
+			lastSecond = seconds;
+		}
+		return lastTimeStamp;
+	}
 
-		time(&rawtime);
-		timeinfo = localtime(&rawtime);
+	Base::RingBuffer<Record, Base::Producers::Multiple> queue;
+	std::atomic<bool> stopping;
+	std::atomic<bool> sleeping;
+	std::mutex wakeUpMutex;
+	std::condition_variable wakeUp;
+	unsigned long reportedDropped;
+	std::time_t lastSecond;
+	std::string lastTimeStamp;
+	std::thread thread;
+};
+/**
+ * Started when it is needed for the first time
+ */
+Writer& getWriter() {
+	static Writer writer;
+	return writer;
+}
+} // namespace
 
-		strftime(buffer, sizeof(buffer), "%d-%m-%Y %I:%M:%S", timeinfo);
-		std::string str(buffer);
-		frame->getTraceFunction().trace(str + ";" + aMessage);
+/* static */std::atomic< bool > Logger::disable( false);
+/* static */std::atomic< Logger::Level > Logger::level( Logger::Level::Trace);
+/* static */std::atomic< Base::DebugTraceFunction* > Logger::debugTraceFunction( nullptr);
+/**
+ *
+ */
+/*static*/void Logger::log(const std::string& aMessage) {
+	log(Level::Info, aMessage);
+}
+/**
+ *
+ */
+/*static*/void Logger::log(Level aLevel, const std::string& aMessage) {
+	if (isEnabledFor(aLevel)) {
+		getWriter().enqueue(
+				Record { aLevel, std::chrono::system_clock::now(), aMessage });
 	}
 }
 /**
@@ -33,4 +197,69 @@ namespace Application {
 /* static */void Logger::setDisable(bool aDisable /*= true*/) {
 	disable = aDisable;
 }
+/**
+ *
+ */
+/* static */void Logger::setLevel(Level aLevel) {
+	level = aLevel;
+}
+/**
+ *
+ */
+/* static */Logger::Level Logger::levelFor(const std::string& aLevelName) {
+	for (Level candidate : { Level::Trace, Level::Debug, Level::Info,
+			Level::Warning, Level::Error }) {
+		if (nameOf(candidate) == aLevelName) {
+			return candidate;
+		}
+	}
+	throw std::invalid_argument("No such log level: " + aLevelName);
+}
+/**
+ *
+ */
+/* static */std::string Logger::nameOf(Level aLevel) {
+	switch (aLevel) {
+	case Level::Trace:
+		return "trace";
+	case Level::Debug:
+		return "debug";
+	case Level::Info:
+		return "info";
+	case Level::Warning:
+		return "warning";
+	case Level::Error:
+		return "error";
+	}
+	return "unknown";
+}
+/**
+ *
+ */
+/* static */void Logger::setDebugTraceFunction(Base::DebugTraceFunction* aDebugTraceFunction) {
+	Writer& writer = getWriter();
+	std::lock_guard<std::mutex> lock(writer.debugTraceFunctionMutex);
+	writer.drain(debugTraceFunction);
+	debugTraceFunction = aDebugTraceFunction;
+}
+/**
+ *
+ */
+/* static */Base::DebugTraceFunction* Logger::getDebugTraceFunction() {
+	return debugTraceFunction;
+}
+/**
+ *
+ */
+/* static */void Logger::flush() {
+	Writer& writer = getWriter();
+	std::lock_guard<std::mutex> lock(writer.debugTraceFunctionMutex);
+	writer.drain(debugTraceFunction);
+}
+/**
+ *
+ */
+/* static */unsigned long Logger::getDropped() {
+	return getWriter().getDropped();
+}
 } //namespace Application
@@ -3,22 +3,103 @@
 
 #include "Config.hpp"
 
+#include <atomic>
+#include <sstream>
 #include <string>
 
+/**
+ * The levels of the LOG_* macros. A macro of a level below LOG_COMPILE_LEVEL compiles to nothing,
+ * so neither its message nor the check of the runtime level costs anything. E.g. build with
+ * CPPFLAGS=-DLOG_COMPILE_LEVEL=2 to leave out everything below LOG_LEVEL_INFO.
+ */
+#define LOG_LEVEL_TRACE 0
+#define LOG_LEVEL_DEBUG 1
+#define LOG_LEVEL_INFO 2
+#define LOG_LEVEL_WARNING 3
+#define LOG_LEVEL_ERROR 4
+
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+/**
+ * Streams someStreamArguments (e.g. "speed " << speed) into the message, but only if aLevel is enabled
+ */
+#define LOG_AT( aLevel, someStreamArguments)															\
+	do																									\
+	{																									\
+		if (Application::Logger::isEnabledFor( aLevel))												\
+		{																								\
+			std::ostringstream logStream;																\
+			logStream << someStreamArguments;															\
+			Application::Logger::log( aLevel, logStream.str());										\
+		}																								\
+	} while (false)
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_TRACE
+#define LOG_TRACE( someStreamArguments) LOG_AT( Application::Logger::Level::Trace, someStreamArguments)
+#else
+#define LOG_TRACE( someStreamArguments) do {} while (false)
+#endif
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG( someStreamArguments) LOG_AT( Application::Logger::Level::Debug, someStreamArguments)
+#else
+#define LOG_DEBUG( someStreamArguments) do {} while (false)
+#endif
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO( someStreamArguments) LOG_AT( Application::Logger::Level::Info, someStreamArguments)
+#else
+#define LOG_INFO( someStreamArguments) do {} while (false)
+#endif
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_WARNING
+#define LOG_WARNING( someStreamArguments) LOG_AT( Application::Logger::Level::Warning, someStreamArguments)
+#else
+#define LOG_WARNING( someStreamArguments) do {} while (false)
+#endif
+#define LOG_ERROR( someStreamArguments) LOG_AT( Application::Logger::Level::Error, someStreamArguments)
+
+namespace Base
+{
+	class DebugTraceFunction;
+} // namespace Base
+
 namespace Application
 {
 	/**
+	 * Logs asynchronously to the current DebugTraceFunction.
+	 *
+	 * log() only puts the level, the time and the message in a lock-free RingBuffer. A background
+	 * writer formats the time stamps and hands the messages in batches to the DebugTraceFunction, so
+	 * the thread that logs never waits for a widget, the console or a file. If the writer can not keep
+	 * up the newest messages are dropped and the writer logs how many were lost.
 	 *
+	 * Prefer the LOG_* macros to log(): they only build the message if its level is enabled.
 	 */
 	class Logger
 	{
 		public:
 			/**
-			 * If enabled, traces the message to the current DebugTraceFunction
+			 * The values are those of the LOG_LEVEL_* macros
+			 */
+			enum class Level : int
+			{
+				Trace = LOG_LEVEL_TRACE,
+				Debug = LOG_LEVEL_DEBUG,
+				Info = LOG_LEVEL_INFO,
+				Warning = LOG_LEVEL_WARNING,
+				Error = LOG_LEVEL_ERROR
+			};
+			/**
+			 * If enabled, traces the message to the current DebugTraceFunction at Level::Info
 			 *
 			 * @param aMessage
 			 */
 			static void log( const std::string& aMessage);
+			/**
+			 * If aLevel is enabled, traces the message to the current DebugTraceFunction
+			 */
+			static void log(	Level aLevel,
+								const std::string& aMessage);
 			/**
 			 *
 			 * Disable/enable the logger. Called with true (default) enables the logger, with false disables the logger.
@@ -34,11 +115,56 @@ namespace Application
 			{
 				return !disable;
 			}
+			/**
+			 * @return true if a message of aLevel would be traced
+			 */
+			static bool isEnabledFor( Level aLevel)
+			{
+				return !disable && aLevel >= level.load( std::memory_order_relaxed) && debugTraceFunction.load( std::memory_order_relaxed) != nullptr;
+			}
+			/**
+			 * Messages below aLevel are not logged
+			 */
+			static void setLevel( Level aLevel);
+			/**
+			 *
+			 */
+			static Level getLevel()
+			{
+				return level;
+			}
+			/**
+			 * @param aLevelName "trace", "debug", "info", "warning" or "error"
+			 * @throws std::invalid_argument if aLevelName is none of those
+			 */
+			static Level levelFor( const std::string& aLevelName);
 			/**
 			 *
 			 */
+			static std::string nameOf( Level aLevel);
+			/**
+			 * Sets the DebugTraceFunction the messages are traced to. The Logger does not take
+			 * ownership; nothing is traced while there is none (nullptr). The messages that are
+			 * waiting are traced to the previous DebugTraceFunction first, so that one may be
+			 * deleted as soon as this returns.
+			 */
+			static void setDebugTraceFunction( Base::DebugTraceFunction* aDebugTraceFunction);
+			/**
+			 *
+			 */
+			static Base::DebugTraceFunction* getDebugTraceFunction();
+			/**
+			 * Traces the messages that are waiting, on the calling thread
+			 */
+			static void flush();
+			/**
+			 * The number of messages that were dropped because the writer could not keep up
+			 */
+			static unsigned long getDropped();
 		private:
-			static bool disable;
+			static std::atomic< bool > disable;
+			static std::atomic< Level > level;
+			static std::atomic< Base::DebugTraceFunction* > debugTraceFunction;
 	};
 } // namespace Application
 #endif /* LOGGER_HPP_ */
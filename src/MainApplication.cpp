@@ -4,12 +4,12 @@
 #include <cstring>
 #include "MainFrameWindow.hpp"
 #include "ObjectId.hpp"
+#include "SimulationClock.hpp"
+#include "Metrics.hpp"
+#include "TraceLog.hpp"
 
 namespace Application
 {
-	/* static */std::vector< CommandlineArgument > MainApplication::commandlineArguments;
-	/* static */std::vector< std::string > MainApplication::commandlineFiles;
-
 	// Create a new application object: this macro will allow wxWidgets to create
 	// the application object during program execution (it's better than using a
 	// static object for many reasons) and also implements the accessor function
@@ -34,6 +34,21 @@ namespace Application
 
 		MainApplication::setCommandlineArguments( argc, argv);
 
+		if (MainApplication::isArgGiven( "-simulation_mode"))
+		{
+			Model::SimulationClock::getSimulationClock().setMode( Model::SimulationClock::modeFromString( MainApplication::getArg( "-simulation_mode").value));
+		}
+
+		if (MainApplication::isArgGiven( "-trace"))
+		{
+			Base::TraceLog::getTraceLog().open( MainApplication::getArg( "-trace").value);
+		}
+		if (MainApplication::isArgGiven( "-metrics"))
+		{
+			long interval = MainApplication::isArgGiven( "-metrics_interval") ? std::stol( MainApplication::getArg( "-metrics_interval").value) : 1000;
+			Base::Metrics::getMetrics().startDumping( MainApplication::getArg( "-metrics").value, std::chrono::milliseconds( interval));
+		}
+
 		MainFrameWindow* frame = nullptr;
 		if(MainApplication::isArgGiven("-worldname"))
 		{
@@ -66,86 +81,4 @@ namespace Application
 		return true;
 	}
 
-	/* static */void MainApplication::setCommandlineArguments( 	int argc,
-																char* argv[])
-	{
-
-		// argv[0] contains the executable name as one types on the command line (with or without extension)
-		MainApplication::commandlineArguments.push_back( CommandlineArgument( 0, "Executable", argv[0]));
-
-		for (int i = 1; i < argc; ++i)
-		{
-			char* currentArg = argv[i];
-			size_t argLength = std::strlen( currentArg);
-
-
-			// If the first char of the argument is not a "-" we assume that is is
-			// a filename otherwise it is an ordinary argument
-
-			if (currentArg[0] == '-') // ordinary argument
-			{
-				bool inserted = false;
-
-				// First handle the arguments in the form of "variable=value", and find the "="
-
-				for (size_t j = 0; j < argLength; ++j)
-				{
-					if (currentArg[j] == '=')
-					{
-						std::string variable( currentArg, j);
-						std::string value( &currentArg[j + 1]);
-						MainApplication::commandlineArguments.push_back( CommandlineArgument( i, variable, value));
-						inserted = true;
-					}
-				}
-
-				// Second handle the stand alone arguments.
-
-				// If inserted is
-
-				// It is assumed that they are actually booleans.
-				// If given on the command line than the variable will be set to true as if
-				// variable=true is passed
-				if (inserted == false)
-				{
-					std::string variable( currentArg);
-					std::string value( "true");
-					MainApplication::commandlineArguments.push_back( CommandlineArgument( i, variable, value));
-				}
-			} else // file argument
-			{
-				MainApplication::commandlineFiles.push_back( currentArg);
-			}
-		}
-	}
-
-	/* static */bool MainApplication::isArgGiven( const std::string& aVariable)
-	{
-		std::vector< CommandlineArgument >::iterator i = std::find( MainApplication::commandlineArguments.begin(), MainApplication::commandlineArguments.end(), aVariable);
-		return i != commandlineArguments.end();
-	}
-
-	/* static */CommandlineArgument& MainApplication::getArg( const std::string& aVariable)
-	{
-		std::vector< CommandlineArgument >::iterator i = std::find( MainApplication::commandlineArguments.begin(), MainApplication::commandlineArguments.end(), aVariable);
-		if (i == MainApplication::commandlineArguments.end())
-		{
-			throw std::invalid_argument( "No such command line argument");
-		}
-		return *i;
-	}
-
-	/* static */CommandlineArgument& MainApplication::getArg( unsigned long anArgumentNumber)
-	{
-		if(anArgumentNumber >= MainApplication::commandlineArguments.size())
-		{
-			throw std::invalid_argument( "No such command line argument");
-		}
-		return MainApplication::commandlineArguments[anArgumentNumber];
-	}
-
-	/* static */std::vector< std::string >& MainApplication::getCommandlineFiles()
-	{
-		return commandlineFiles;
-	}
 } // namespace Application
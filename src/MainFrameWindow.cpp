@@ -5,6 +5,7 @@
 #include "LogTextCtrl.hpp"
 #include "WidgetDebugTraceFunction.hpp"
 #include "StdOutDebugTraceFunction.hpp"
+#include "FileDebugTraceFunction.hpp"
 #include "Button.hpp"
 #include "RobotWorld.hpp"
 #include "Robot.hpp"
@@ -14,6 +15,12 @@
 #include "Logger.hpp"
 #include "Client.hpp"
 #include "Message.hpp"
+#include "SensorScheduler.hpp"
+#include "SimulationClock.hpp"
+#include "WorkStealingPool.hpp"
+#include "AllocationCounter.hpp"
+#include "Metrics.hpp"
+#include <sstream>
 
 namespace Application
 {
@@ -28,7 +35,14 @@ namespace Application
 		ID_OPTIONS 	= wxID_PROPERTIES,		//!< ID_OPTIONS
 		ID_ABOUT 	= wxID_ABOUT,        	//!< ID_ABOUT
 		ID_WIDGET_DEBUG_TRACE_FUNCTION, 	//!< ID_WIDGET_DEBUG_TRACE_FUNCTION
-		ID_STDCOUT_DEBUG_TRACE_FUNCTION 	//!< ID_STDCOUT_DEBUG_TRACE_FUNCTION
+		ID_STDCOUT_DEBUG_TRACE_FUNCTION, 	//!< ID_STDCOUT_DEBUG_TRACE_FUNCTION
+		ID_FILE_DEBUG_TRACE_FUNCTION, 		//!< ID_FILE_DEBUG_TRACE_FUNCTION
+		ID_SENSOR_STATISTICS, 				//!< ID_SENSOR_STATISTICS
+		ID_METRICS, 						//!< ID_METRICS
+		ID_SIMULATION_REAL_TIME, 			//!< ID_SIMULATION_REAL_TIME
+		ID_SIMULATION_ACCELERATED, 			//!< ID_SIMULATION_ACCELERATED
+		ID_SIMULATION_PAUSED, 				//!< ID_SIMULATION_PAUSED
+		ID_SIMULATION_STEP 					//!< ID_SIMULATION_STEP
 
 	};
 	/**
@@ -44,6 +58,9 @@ namespace Application
 								rhsPanel( nullptr),
 								logTextCtrl( nullptr),
 								buttonPanel( nullptr),
+								metricsPanel( nullptr),
+								metricsListCtrl( nullptr),
+								metricsTimer( this),
 								debugTraceFunction( nullptr)
 	{
 		initialise();
@@ -53,6 +70,8 @@ namespace Application
 	 */
 	MainFrameWindow::~MainFrameWindow()
 	{
+		metricsTimer.Stop();
+		Logger::setDebugTraceFunction( nullptr);
 		if (debugTraceFunction)
 		{
 			delete debugTraceFunction;
@@ -98,13 +117,37 @@ namespace Application
 		Bind( wxEVT_COMMAND_MENU_SELECTED,
 			  [this](CommandEvent& anEvent){ this->OnStdOutDebugTraceFunction(anEvent);},
 			  ID_STDCOUT_DEBUG_TRACE_FUNCTION);
+		Bind( wxEVT_COMMAND_MENU_SELECTED,
+			  [this](CommandEvent& anEvent){ this->OnFileDebugTraceFunction(anEvent);},
+			  ID_FILE_DEBUG_TRACE_FUNCTION);
+		Bind( wxEVT_COMMAND_MENU_SELECTED,
+			  [this](CommandEvent& anEvent){ this->OnSensorStatistics(anEvent);},
+			  ID_SENSOR_STATISTICS);
+		Bind( wxEVT_COMMAND_MENU_SELECTED,
+			  [this](CommandEvent& anEvent){ this->OnMetrics(anEvent);},
+			  ID_METRICS);
+		Bind( wxEVT_TIMER,
+			  [this](TimerEvent& anEvent){ this->OnMetricsTimer(anEvent);},
+			  metricsTimer.GetId());
+		Bind( wxEVT_COMMAND_MENU_SELECTED,
+			  [this](CommandEvent& anEvent){ this->OnSimulationMode(anEvent);},
+			  ID_SIMULATION_REAL_TIME, ID_SIMULATION_PAUSED);
+		Bind( wxEVT_COMMAND_MENU_SELECTED,
+			  [this](CommandEvent& anEvent){ this->OnSimulationStep(anEvent);},
+			  ID_SIMULATION_STEP);
 		Bind( wxEVT_COMMAND_MENU_SELECTED,
 			  [this](CommandEvent& anEvent){ this->OnAbout(anEvent);},
 			  ID_ABOUT);
 
+		if (MainApplication::isArgGiven( "-log_level"))
+		{
+			Logger::setLevel( Logger::levelFor( MainApplication::getArg( "-log_level").value));
+		}
+
 		// By default we initialise the WidgetDebugTraceFunction
 		// as we expect that this is what the user wants....
 		debugTraceFunction = new Application::WidgetDebugTraceFunction( logTextCtrl);
+		Logger::setDebugTraceFunction( debugTraceFunction);
 	}
 	/**
 	 *
@@ -117,12 +160,36 @@ namespace Application
 		Menu* debugMenu = new Menu;
 		debugMenu->AppendRadioItem( ID_WIDGET_DEBUG_TRACE_FUNCTION, WXSTRING( "Widget"), WXSTRING( "Widget"));
 		debugMenu->AppendRadioItem( ID_STDCOUT_DEBUG_TRACE_FUNCTION, WXSTRING( "StdOut"), WXSTRING( "StdOut"));
+		debugMenu->AppendRadioItem( ID_FILE_DEBUG_TRACE_FUNCTION, WXSTRING( "File"), WXSTRING( "Append to robotworld.log or the file given with -log_file"));
+		debugMenu->AppendSeparator();
+		debugMenu->Append( ID_SENSOR_STATISTICS, WXSTRING( "Sensor statistics"), WXSTRING( "Log the sensor jitter, task latency and allocation statistics"));
+		debugMenu->AppendCheckItem( ID_METRICS, WXSTRING( "Metrics\tCtrl-M"), WXSTRING( "Show the counters, gauges and latency histograms"));
+
+		Menu* simulationMenu = new Menu;
+		simulationMenu->AppendRadioItem( ID_SIMULATION_REAL_TIME, WXSTRING( "Real time"), WXSTRING( "Run the simulation in real time"));
+		simulationMenu->AppendRadioItem( ID_SIMULATION_ACCELERATED, WXSTRING( "Accelerated"), WXSTRING( "Run the simulation as fast as possible"));
+		simulationMenu->AppendRadioItem( ID_SIMULATION_PAUSED, WXSTRING( "Paused"), WXSTRING( "Pause the simulation"));
+		simulationMenu->AppendSeparator();
+		simulationMenu->Append( ID_SIMULATION_STEP, WXSTRING( "Step\tF10"), WXSTRING( "Run one tick of the simulation"));
+		switch (Model::SimulationClock::getSimulationClock().getMode())
+		{
+			case Model::SimulationClock::Mode::RealTime:
+				simulationMenu->Check( ID_SIMULATION_REAL_TIME, true);
+				break;
+			case Model::SimulationClock::Mode::Accelerated:
+				simulationMenu->Check( ID_SIMULATION_ACCELERATED, true);
+				break;
+			case Model::SimulationClock::Mode::Paused:
+				simulationMenu->Check( ID_SIMULATION_PAUSED, true);
+				break;
+		}
 
 		Menu* helpMenu = new Menu;
 		helpMenu->Append( ID_ABOUT, WXSTRING( "&About...\tF1"), WXSTRING( "Show about dialog"));
 
 		menuBar = new wxMenuBar;
 		menuBar->Append( fileMenu, WXSTRING( "&File"));
+		menuBar->Append( simulationMenu, WXSTRING( "&Simulation"));
 		menuBar->Append( debugMenu, WXSTRING( "&Debug"));
 		menuBar->Append( helpMenu, WXSTRING( "&Help"));
 
@@ -185,6 +252,10 @@ namespace Application
 			sizer->Add( robotWorldCanvas = new View::RobotWorldCanvas( lhsPanel),
 						GBPosition( 1, 1),
 						GBSpan( 1, 1), EXPAND);
+			if (MainApplication::isArgGiven( "-fps"))
+			{
+				robotWorldCanvas->setFramesPerSecond( static_cast< unsigned short >(std::stoul( MainApplication::getArg( "-fps").value)));
+			}
 			sizer->AddGrowableCol( 1);
 			sizer->AddGrowableRow( 1);
 
@@ -211,18 +282,27 @@ namespace Application
 						GBPosition( 0, 0),
 						GBSpan( 1, 1), EXPAND);
 
-			sizer->Add( logTextCtrl = new LogTextCtrl( rhsPanel, DEFAULT_ID, wxTE_MULTILINE | wxTE_DONTWRAP),
+			sizer->Add( logTextCtrl = new LogTextCtrl( rhsPanel, DEFAULT_ID),
 						GBPosition( 1, 1),
 						GBSpan( 1, 1), EXPAND);
 			sizer->AddGrowableCol( 1);
 			sizer->AddGrowableRow( 1);
 			logTextCtrl->SetMinSize( Size( 500, 300));
+			if (MainApplication::isArgGiven( "-log_lines"))
+			{
+				logTextCtrl->setMaximumLines( std::stoul( MainApplication::getArg( "-log_lines").value));
+			}
 
 			sizer->Add( buttonPanel = initialiseButtonPanel(),
 						GBPosition( 2, 1),
 						GBSpan( 1, 1), SHRINK);
 			sizer->AddGrowableRow( 2);
 
+			sizer->Add( metricsPanel = initialiseMetricsPanel(),
+						GBPosition( 3, 1),
+						GBSpan( 1, 1), EXPAND);
+			sizer->Show( metricsPanel, false);
+
 			sizer->Add( 5, 5,
 						GBPosition( 2, 2),
 						GBSpan( 1, 1), EXPAND);
@@ -291,6 +371,51 @@ namespace Application
 
 		return panel;
 	}
+	/**
+	 *
+	 */
+	Panel* MainFrameWindow::initialiseMetricsPanel()
+	{
+		Panel* panel = new Panel( rhsPanel);
+
+		GridBagSizer* sizer = new GridBagSizer();
+
+		sizer->Add( metricsListCtrl = new wxListCtrl( panel, DEFAULT_ID, DefaultPosition, DefaultSize, wxLC_REPORT | wxLC_SINGLE_SEL),
+					GBPosition( 0, 0),
+					GBSpan( 1, 1), EXPAND);
+		sizer->AddGrowableCol( 0);
+		sizer->AddGrowableRow( 0);
+		metricsListCtrl->InsertColumn( 0, WXSTRING( "Metric"), wxLIST_FORMAT_LEFT, 260);
+		metricsListCtrl->InsertColumn( 1, WXSTRING( "Value"), wxLIST_FORMAT_LEFT, 400);
+		metricsListCtrl->SetMinSize( Size( 500, 200));
+
+		panel->SetSizerAndFit( sizer);
+
+		return panel;
+	}
+	/**
+	 *
+	 */
+	void MainFrameWindow::updateMetricsPanel()
+	{
+		std::vector< Base::Metrics::Summary > summaries = Base::Metrics::getMetrics().getSummaries();
+
+		// Metrics are only ever added, so the rows only have to be added when there are new ones
+		metricsListCtrl->Freeze();
+		if (static_cast< std::size_t >(metricsListCtrl->GetItemCount()) != summaries.size())
+		{
+			metricsListCtrl->DeleteAllItems();
+			for (std::size_t i = 0; i < summaries.size(); ++i)
+			{
+				metricsListCtrl->InsertItem( static_cast< long >(i), WXSTRING( summaries[i].first));
+			}
+		}
+		for (std::size_t i = 0; i < summaries.size(); ++i)
+		{
+			metricsListCtrl->SetItem( static_cast< long >(i), 1, WXSTRING( summaries[i].second));
+		}
+		metricsListCtrl->Thaw();
+	}
 	/**
 	 *
 	 */
@@ -303,21 +428,111 @@ namespace Application
 	 */
 	void MainFrameWindow::OnWidgetDebugTraceFunction( CommandEvent& UNUSEDPARAM(anEvent))
 	{
-		if (debugTraceFunction)
-			delete debugTraceFunction;
+		// The Logger gets the new one before the old one is deleted
+		Base::DebugTraceFunction* oldDebugTraceFunction = debugTraceFunction;
 		debugTraceFunction = new WidgetDebugTraceFunction( logTextCtrl);
+		Logger::setDebugTraceFunction( debugTraceFunction);
+		delete oldDebugTraceFunction;
 	}
 	/**
 	 *
 	 */
 	void MainFrameWindow::OnStdOutDebugTraceFunction( CommandEvent& UNUSEDPARAM(anEvent))
 	{
-		if (debugTraceFunction)
-			delete debugTraceFunction;
+		// The Logger gets the new one before the old one is deleted
+		Base::DebugTraceFunction* oldDebugTraceFunction = debugTraceFunction;
 		debugTraceFunction = new Base::StdOutDebugTraceFunction();
+		Logger::setDebugTraceFunction( debugTraceFunction);
+		delete oldDebugTraceFunction;
 
 	}
+	/**
+	 *
+	 */
+	void MainFrameWindow::OnFileDebugTraceFunction( CommandEvent& UNUSEDPARAM(anEvent))
+	{
+		std::string fileName = MainApplication::isArgGiven( "-log_file") ? MainApplication::getArg( "-log_file").value : "robotworld.log";
+		try
+		{
+			// The Logger gets the new one before the old one is deleted
+			Base::DebugTraceFunction* oldDebugTraceFunction = debugTraceFunction;
+			debugTraceFunction = new Base::FileDebugTraceFunction( fileName);
+			Logger::setDebugTraceFunction( debugTraceFunction);
+			delete oldDebugTraceFunction;
+		}
+		catch (std::exception& e)
+		{
+			LOG_ERROR( e.what());
+		}
+	}
 
+	/**
+	 *
+	 */
+	void MainFrameWindow::OnSensorStatistics( CommandEvent& UNUSEDPARAM(anEvent))
+	{
+		std::ostringstream os;
+		os << Model::SensorScheduler::getSensorScheduler().asDebugString();
+		os << Base::WorkStealingPool::getWorkStealingPool().asDebugString();
+		os << "heap allocations: " << Base::AllocationCounter::getAllocationsPerSecond() << "/s, " << Base::AllocationCounter::getTotal() << " in total\n";
+		os << robotWorldCanvas->asRefreshString();
+		Logger::log( os.str());
+	}
+	/**
+	 *
+	 */
+	void MainFrameWindow::OnMetrics( CommandEvent& anEvent)
+	{
+		bool show = anEvent.IsChecked();
+		rhsPanel->GetSizer()->Show( metricsPanel, show);
+		rhsPanel->Layout();
+		if (show)
+		{
+			updateMetricsPanel();
+			metricsTimer.Start( 1000);
+		} else
+		{
+			metricsTimer.Stop();
+		}
+	}
+	/**
+	 *
+	 */
+	void MainFrameWindow::OnMetricsTimer( TimerEvent& UNUSEDPARAM(anEvent))
+	{
+		updateMetricsPanel();
+	}
+	/**
+	 *
+	 */
+	void MainFrameWindow::OnSimulationMode( CommandEvent& anEvent)
+	{
+		Model::SimulationClock& simulationClock = Model::SimulationClock::getSimulationClock();
+		switch (anEvent.GetId())
+		{
+			case ID_SIMULATION_REAL_TIME:
+				simulationClock.setMode( Model::SimulationClock::Mode::RealTime);
+				break;
+			case ID_SIMULATION_ACCELERATED:
+				simulationClock.setMode( Model::SimulationClock::Mode::Accelerated);
+				break;
+			case ID_SIMULATION_PAUSED:
+				simulationClock.setMode( Model::SimulationClock::Mode::Paused);
+				break;
+		}
+		Logger::log( simulationClock.asString());
+	}
+	/**
+	 *
+	 */
+	void MainFrameWindow::OnSimulationStep( CommandEvent& UNUSEDPARAM(anEvent))
+	{
+		Model::SimulationClock& simulationClock = Model::SimulationClock::getSimulationClock();
+		if (simulationClock.getMode() == Model::SimulationClock::Mode::Paused)
+		{
+			simulationClock.step();
+		}
+	}
 	/**
 	 *
 	 */
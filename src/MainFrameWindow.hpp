@@ -67,6 +67,14 @@ namespace Application
 			 *
 			 */
 			Panel* initialiseButtonPanel();
+			/**
+			 * A list of all metrics, hidden until it is switched on in the Debug menu
+			 */
+			Panel* initialiseMetricsPanel();
+			/**
+			 * Shows the current values of the metrics in the metrics panel
+			 */
+			void updateMetricsPanel();
 
 		protected:
 
@@ -81,12 +89,24 @@ namespace Application
 			Panel* rhsPanel;
 			LogTextCtrl* logTextCtrl;
 			Panel* buttonPanel;
+			Panel* metricsPanel;
+			wxListCtrl* metricsListCtrl;
+			/**
+			 * Updates the metrics panel once per second while it is shown
+			 */
+			Timer metricsTimer;
 
 			Base::DebugTraceFunction* debugTraceFunction;
 
 			void OnQuit( CommandEvent& anEvent);
 			void OnWidgetDebugTraceFunction( CommandEvent& anEvent);
 			void OnStdOutDebugTraceFunction( CommandEvent& anEvent);
+			void OnFileDebugTraceFunction( CommandEvent& anEvent);
+			void OnSensorStatistics( CommandEvent& anEvent);
+			void OnMetrics( CommandEvent& anEvent);
+			void OnMetricsTimer( TimerEvent& anEvent);
+			void OnSimulationMode( CommandEvent& anEvent);
+			void OnSimulationStep( CommandEvent& anEvent);
 			void OnAbout( CommandEvent& anEvent);
 
 			void OnStartRobot( CommandEvent& anEvent);
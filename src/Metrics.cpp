@@ -0,0 +1,521 @@
+#include "Metrics.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace Base
+{
+	namespace
+	{
+		/**
+		 * The quantiles a Histogram is exported with
+		 */
+		const double Quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+
+		/**
+		 * [a-zA-Z_:][a-zA-Z0-9_:]*
+		 */
+		bool isValidName( const std::string& aName)
+		{
+			if (aName.empty() || (aName[0] >= '0' && aName[0] <= '9'))
+			{
+				return false;
+			}
+			for (char c : aName)
+			{
+				if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == ':'))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+		/**
+		 * A help text with its backslashes and line feeds escaped
+		 */
+		std::string escapeHelp( const std::string& aHelp)
+		{
+			std::string escaped;
+			for (char c : aHelp)
+			{
+				if (c == '\\')
+				{
+					escaped += "\\\\";
+				} else if (c == '\n')
+				{
+					escaped += "\\n";
+				} else
+				{
+					escaped += c;
+				}
+			}
+			return escaped;
+		}
+		/**
+		 *
+		 */
+		void writeHeader(	std::ostream& os,
+							const std::string& aName,
+							const std::string& aHelp,
+							const char* aType)
+		{
+			os << "# HELP " << aName << " " << escapeHelp( aHelp) << "\n";
+			os << "# TYPE " << aName << " " << aType << "\n";
+		}
+	} // namespace
+
+	/**
+	 *
+	 */
+	Counter::Counter(	const std::string& aName,
+						const std::string& aHelp) :
+							name( aName),
+							help( aHelp)
+	{
+		for (Shard& shard : shards)
+		{
+			shard.value.store( 0, std::memory_order_relaxed);
+		}
+	}
+	/**
+	 *
+	 */
+	std::uint64_t Counter::getValue() const
+	{
+		std::uint64_t value = 0;
+		for (const Shard& shard : shards)
+		{
+			value += shard.value.load( std::memory_order_relaxed);
+		}
+		return value;
+	}
+	/**
+	 *
+	 */
+	Gauge::Gauge(	const std::string& aName,
+					const std::string& aHelp) :
+						name( aName),
+						help( aHelp),
+						value( 0.0)
+	{
+	}
+	/**
+	 *
+	 */
+	void Gauge::add( double anAmount)
+	{
+		double current = value.load( std::memory_order_relaxed);
+		while (!value.compare_exchange_weak( current, current + anAmount, std::memory_order_relaxed))
+		{
+		}
+	}
+	/**
+	 *
+	 */
+	/* static */const unsigned Histogram::SubBucketBits;
+	/* static */const std::size_t Histogram::SubBuckets;
+	/* static */const unsigned Histogram::MaximumBits;
+	/* static */const std::size_t Histogram::Buckets;
+	/**
+	 *
+	 */
+	std::uint64_t Histogram::Snapshot::getValueAt( double aQuantile) const
+	{
+		if (count == 0)
+		{
+			return 0;
+		}
+
+		// The rank of the value, 1 is the lowest value and count the highest
+		double rank = std::max( 1.0, std::min( aQuantile, 1.0) * static_cast< double >(count));
+		std::uint64_t seen = 0;
+		for (std::size_t bucket = 0; bucket < buckets.size(); ++bucket)
+		{
+			seen += buckets[bucket];
+			if (static_cast< double >(seen) >= rank)
+			{
+				return std::min( highestValueOf( bucket), maximum);
+			}
+		}
+		return maximum;
+	}
+	/**
+	 *
+	 */
+	double Histogram::Snapshot::getMean() const
+	{
+		return count == 0 ? 0.0 : static_cast< double >(sum) / static_cast< double >(count);
+	}
+	/**
+	 *
+	 */
+	Histogram::Histogram(	const std::string& aName,
+							const std::string& aHelp,
+							double aUnit /*= 1.0*/) :
+								name( aName),
+								help( aHelp),
+								unit( aUnit),
+								shards( new Shard[MetricShards])
+	{
+		for (std::size_t i = 0; i < MetricShards; ++i)
+		{
+			Shard& shard = shards[i];
+			for (std::atomic< std::uint64_t >& bucket : shard.buckets)
+			{
+				bucket.store( 0, std::memory_order_relaxed);
+			}
+			shard.count.store( 0, std::memory_order_relaxed);
+			shard.sum.store( 0, std::memory_order_relaxed);
+			shard.maximum.store( 0, std::memory_order_relaxed);
+		}
+	}
+	/**
+	 *
+	 */
+	void Histogram::record( std::uint64_t aValue)
+	{
+		Shard& shard = shards[currentMetricShard()];
+		shard.buckets[bucketFor( aValue)].fetch_add( 1, std::memory_order_relaxed);
+		shard.sum.fetch_add( aValue, std::memory_order_relaxed);
+		shard.count.fetch_add( 1, std::memory_order_relaxed);
+
+		std::uint64_t maximum = shard.maximum.load( std::memory_order_relaxed);
+		while (aValue > maximum && !shard.maximum.compare_exchange_weak( maximum, aValue, std::memory_order_relaxed))
+		{
+		}
+	}
+	/**
+	 *
+	 */
+	Histogram::Snapshot Histogram::getSnapshot() const
+	{
+		Snapshot snapshot;
+		snapshot.sum = 0;
+		snapshot.maximum = 0;
+		snapshot.buckets.assign( Buckets, 0);
+		for (std::size_t i = 0; i < MetricShards; ++i)
+		{
+			const Shard& shard = shards[i];
+			for (std::size_t bucket = 0; bucket < Buckets; ++bucket)
+			{
+				snapshot.buckets[bucket] += shard.buckets[bucket].load( std::memory_order_relaxed);
+			}
+			snapshot.sum += shard.sum.load( std::memory_order_relaxed);
+			snapshot.maximum = std::max( snapshot.maximum, shard.maximum.load( std::memory_order_relaxed));
+		}
+		// Counted from the buckets so that the quantiles and the count agree while records come in
+		snapshot.count = 0;
+		for (std::uint64_t bucket : snapshot.buckets)
+		{
+			snapshot.count += bucket;
+		}
+		return snapshot;
+	}
+	/**
+	 *
+	 */
+	/* static */std::size_t Histogram::bucketFor( std::uint64_t aValue)
+	{
+		// The values below 2 * SubBuckets get a bucket of their own
+		if (aValue < 2 * SubBuckets)
+		{
+			return static_cast< std::size_t >(aValue);
+		}
+		unsigned highestBit = 63 - static_cast< unsigned >(__builtin_clzll( aValue));
+		if (highestBit >= MaximumBits)
+		{
+			return Buckets - 1;
+		}
+		unsigned shift = highestBit - SubBucketBits;
+		return SubBuckets * shift + static_cast< std::size_t >(aValue >> shift);
+	}
+	/**
+	 *
+	 */
+	/* static */std::uint64_t Histogram::lowestValueOf( std::size_t aBucket)
+	{
+		if (aBucket < 2 * SubBuckets)
+		{
+			return aBucket;
+		}
+		std::size_t shift = aBucket / SubBuckets - 1;
+		return static_cast< std::uint64_t >(aBucket - SubBuckets * shift) << shift;
+	}
+	/**
+	 *
+	 */
+	/* static */std::uint64_t Histogram::highestValueOf( std::size_t aBucket)
+	{
+		if (aBucket >= Buckets - 1)
+		{
+			return std::numeric_limits< std::uint64_t >::max();
+		}
+		return lowestValueOf( aBucket + 1) - 1;
+	}
+	/**
+	 *
+	 */
+	/* static */Metrics& Metrics::getMetrics()
+	{
+		static Metrics metrics;
+		return metrics;
+	}
+	/**
+	 *
+	 */
+	Metrics::Metrics() :
+						dumpInterval( 1000),
+						dumping( false)
+	{
+	}
+	/**
+	 *
+	 */
+	Metrics::~Metrics()
+	{
+		stopDumping();
+	}
+	/**
+	 *
+	 */
+	Counter& Metrics::getCounter(	const std::string& aName,
+									const std::string& aHelp)
+	{
+		std::lock_guard< std::mutex > lock( metricsMutex);
+		auto counter = counters.find( aName);
+		if (counter != counters.end())
+		{
+			return *counter->second;
+		}
+		checkName( aName);
+		return *counters.insert( std::make_pair( aName, std::unique_ptr< Counter >( new Counter( aName, aHelp)))).first->second;
+	}
+	/**
+	 *
+	 */
+	Gauge& Metrics::getGauge(	const std::string& aName,
+								const std::string& aHelp)
+	{
+		std::lock_guard< std::mutex > lock( metricsMutex);
+		auto gauge = gauges.find( aName);
+		if (gauge != gauges.end())
+		{
+			return *gauge->second;
+		}
+		checkName( aName);
+		return *gauges.insert( std::make_pair( aName, std::unique_ptr< Gauge >( new Gauge( aName, aHelp)))).first->second;
+	}
+	/**
+	 *
+	 */
+	Histogram& Metrics::getHistogram(	const std::string& aName,
+										const std::string& aHelp,
+										double aUnit /*= 1.0*/)
+	{
+		std::lock_guard< std::mutex > lock( metricsMutex);
+		auto histogram = histograms.find( aName);
+		if (histogram != histograms.end())
+		{
+			return *histogram->second;
+		}
+		checkName( aName);
+		return *histograms.insert( std::make_pair( aName, std::unique_ptr< Histogram >( new Histogram( aName, aHelp, aUnit)))).first->second;
+	}
+	/**
+	 *
+	 */
+	void Metrics::writePrometheus( std::ostream& os) const
+	{
+		std::lock_guard< std::mutex > lock( metricsMutex);
+		std::ostringstream text;
+		text.precision( 10);
+
+		for (const auto& counter : counters)
+		{
+			writeHeader( text, counter.first, counter.second->getHelp(), "counter");
+			text << counter.first << " " << counter.second->getValue() << "\n";
+		}
+		for (const auto& gauge : gauges)
+		{
+			writeHeader( text, gauge.first, gauge.second->getHelp(), "gauge");
+			text << gauge.first << " " << gauge.second->getValue() << "\n";
+		}
+		for (const auto& histogram : histograms)
+		{
+			const Histogram& h = *histogram.second;
+			Histogram::Snapshot snapshot = h.getSnapshot();
+
+			writeHeader( text, histogram.first, h.getHelp(), "summary");
+			for (double quantile : Quantiles)
+			{
+				text << histogram.first << "{quantile=\"" << quantile << "\"} " << static_cast< double >(snapshot.getValueAt( quantile)) * h.getUnit() << "\n";
+			}
+			text << histogram.first << "_sum " << static_cast< double >(snapshot.sum) * h.getUnit() << "\n";
+			text << histogram.first << "_count " << snapshot.count << "\n";
+		}
+		os << text.str();
+	}
+	/**
+	 *
+	 */
+	void Metrics::dump( const std::string& aFileName) const
+	{
+		std::string temporaryFileName = aFileName + ".tmp";
+		{
+			std::ofstream file( temporaryFileName.c_str(), std::ios::trunc);
+			if (!file)
+			{
+				throw std::runtime_error( "Can not write " + temporaryFileName);
+			}
+			writePrometheus( file);
+			if (!file.flush())
+			{
+				throw std::runtime_error( "Can not write " + temporaryFileName);
+			}
+		}
+		if (std::rename( temporaryFileName.c_str(), aFileName.c_str()) != 0)
+		{
+			throw std::runtime_error( "Can not replace " + aFileName);
+		}
+	}
+	/**
+	 *
+	 */
+	void Metrics::startDumping(	const std::string& aFileName,
+								std::chrono::milliseconds anInterval)
+	{
+		stopDumping();
+
+		std::lock_guard< std::mutex > lock( dumpMutex);
+		dumpFileName = aFileName;
+		dumpInterval = anInterval;
+		dumping = true;
+		dumpThread = std::thread( [this]
+		{
+			std::unique_lock< std::mutex > lock( dumpMutex);
+			while (dumping)
+			{
+				dumpCondition.wait_for( lock, dumpInterval, [this]{ return !dumping;});
+				if (dumping)
+				{
+					std::string fileName = dumpFileName;
+					lock.unlock();
+					try
+					{
+						dump( fileName);
+					}
+					catch (std::exception& e)
+					{
+						std::cerr << __PRETTY_FUNCTION__ << ": " << e.what() << std::endl;
+					}
+					lock.lock();
+				}
+			}
+		});
+	}
+	/**
+	 *
+	 */
+	void Metrics::stopDumping()
+	{
+		{
+			std::lock_guard< std::mutex > lock( dumpMutex);
+			if (!dumping)
+			{
+				return;
+			}
+			dumping = false;
+		}
+		dumpCondition.notify_all();
+		if (dumpThread.joinable())
+		{
+			dumpThread.join();
+		}
+
+		try
+		{
+			dump( dumpFileName);
+		}
+		catch (std::exception& e)
+		{
+			std::cerr << __PRETTY_FUNCTION__ << ": " << e.what() << std::endl;
+		}
+	}
+	/**
+	 *
+	 */
+	std::vector< Metrics::Summary > Metrics::getSummaries() const
+	{
+		std::lock_guard< std::mutex > lock( metricsMutex);
+		std::vector< Summary > summaries;
+
+		for (const auto& counter : counters)
+		{
+			summaries.push_back( std::make_pair( counter.first, std::to_string( counter.second->getValue())));
+		}
+		for (const auto& gauge : gauges)
+		{
+			std::ostringstream os;
+			os << gauge.second->getValue();
+			summaries.push_back( std::make_pair( gauge.first, os.str()));
+		}
+		for (const auto& histogram : histograms)
+		{
+			const Histogram& h = *histogram.second;
+			Histogram::Snapshot snapshot = h.getSnapshot();
+
+			std::ostringstream os;
+			os.precision( 4);
+			os << "n " << snapshot.count;
+			os << ", mean " << snapshot.getMean() * h.getUnit();
+			os << ", p50 " << static_cast< double >(snapshot.getValueAt( 0.5)) * h.getUnit();
+			os << ", p99 " << static_cast< double >(snapshot.getValueAt( 0.99)) * h.getUnit();
+			os << ", max " << static_cast< double >(snapshot.maximum) * h.getUnit();
+			summaries.push_back( std::make_pair( histogram.first, os.str()));
+		}
+
+		std::sort( summaries.begin(), summaries.end());
+		return summaries;
+	}
+	/**
+	 *
+	 */
+	void Metrics::checkName( const std::string& aName) const
+	{
+		if (!isValidName( aName))
+		{
+			throw std::invalid_argument( "Not a valid metric name: " + aName);
+		}
+		if (counters.count( aName) || gauges.count( aName) || histograms.count( aName))
+		{
+			throw std::invalid_argument( "A metric of another type is called " + aName);
+		}
+	}
+	/**
+	 *
+	 */
+	std::string Metrics::asString() const
+	{
+		std::lock_guard< std::mutex > lock( metricsMutex);
+		std::ostringstream os;
+		os << "Metrics: " << counters.size() << " counters, " << gauges.size() << " gauges, " << histograms.size() << " histograms";
+		return os.str();
+	}
+	/**
+	 *
+	 */
+	std::string Metrics::asDebugString() const
+	{
+		std::ostringstream os;
+		os << asString() << "\n";
+		for (const Summary& summary : getSummaries())
+		{
+			os << summary.first << ": " << summary.second << "\n";
+		}
+		return os.str();
+	}
+} // namespace Base
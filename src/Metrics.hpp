@@ -0,0 +1,421 @@
+#ifndef METRICS_HPP_
+#define METRICS_HPP_
+
+#include "Config.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Base
+{
+	/**
+	 * The number of shards of a Counter or Histogram. The threads are spread over the shards so that
+	 * threads that update the same metric seldom write the same cache line.
+	 */
+	const std::size_t MetricShards = 8;
+
+	/**
+	 * The shard of the calling thread
+	 */
+	inline std::size_t currentMetricShard()
+	{
+		static std::atomic< std::size_t > nextShard( 0);
+		thread_local std::size_t shard = nextShard.fetch_add( 1, std::memory_order_relaxed) % MetricShards;
+		return shard;
+	}
+
+	/**
+	 * A value that only goes up, e.g. the number of route searches
+	 */
+	class Counter
+	{
+		public:
+			/**
+			 *
+			 */
+			Counter(	const std::string& aName,
+						const std::string& aHelp);
+			/**
+			 *
+			 */
+			Counter( const Counter& aCounter) = delete;
+			/**
+			 *
+			 */
+			Counter& operator=( const Counter& aCounter) = delete;
+			/**
+			 * May be called from any thread, it takes no lock
+			 */
+			void add( std::uint64_t anAmount = 1)
+			{
+				shards[currentMetricShard()].value.fetch_add( anAmount, std::memory_order_relaxed);
+			}
+			/**
+			 * The sum of the shards
+			 */
+			std::uint64_t getValue() const;
+			/**
+			 *
+			 */
+			const std::string& getName() const
+			{
+				return name;
+			}
+			/**
+			 *
+			 */
+			const std::string& getHelp() const
+			{
+				return help;
+			}
+
+		private:
+			/**
+			 * A cache line of its own for every shard
+			 */
+			struct Shard
+			{
+					std::atomic< std::uint64_t > value;
+					char padding[64 - sizeof( std::atomic< std::uint64_t >)];
+			};
+
+			std::string name;
+			std::string help;
+			Shard shards[MetricShards];
+	};
+	// class Counter
+
+	/**
+	 * A value that goes up and down, e.g. the number of shapes that were drawn in the last frame
+	 */
+	class Gauge
+	{
+		public:
+			/**
+			 *
+			 */
+			Gauge(	const std::string& aName,
+					const std::string& aHelp);
+			/**
+			 *
+			 */
+			Gauge( const Gauge& aGauge) = delete;
+			/**
+			 *
+			 */
+			Gauge& operator=( const Gauge& aGauge) = delete;
+			/**
+			 *
+			 */
+			void set( double aValue)
+			{
+				value.store( aValue, std::memory_order_relaxed);
+			}
+			/**
+			 *
+			 */
+			void add( double anAmount);
+			/**
+			 *
+			 */
+			double getValue() const
+			{
+				return value.load( std::memory_order_relaxed);
+			}
+			/**
+			 *
+			 */
+			const std::string& getName() const
+			{
+				return name;
+			}
+			/**
+			 *
+			 */
+			const std::string& getHelp() const
+			{
+				return help;
+			}
+
+		private:
+			std::string name;
+			std::string help;
+			std::atomic< double > value;
+	};
+	// class Gauge
+
+	/**
+	 * A distribution of values, e.g. the durations of the route searches in microseconds.
+	 *
+	 * Like an HDR histogram the buckets are linear within every power of two and there are
+	 * SubBuckets of them per power of two. So a value is known to within 1/SubBuckets (~3%) of
+	 * itself, from 1 to 2^MaximumBits, in a fixed number of buckets and without knowing the range
+	 * of the values up front. Larger values are counted in the last bucket.
+	 */
+	class Histogram
+	{
+		public:
+			/**
+			 * The sub buckets of a power of two are selected by this many bits below the highest bit
+			 */
+			static const unsigned SubBucketBits = 5;
+			static const std::size_t SubBuckets = 1 << SubBucketBits;
+			static const unsigned MaximumBits = 40;
+			static const std::size_t Buckets = SubBuckets * (MaximumBits - SubBucketBits + 1);
+
+			/**
+			 * What is in a Histogram at some moment
+			 */
+			struct Snapshot
+			{
+					/**
+					 * The value below which aQuantile (0..1) of the values are, in recorded units
+					 */
+					std::uint64_t getValueAt( double aQuantile) const;
+					/**
+					 * In recorded units
+					 */
+					double getMean() const;
+
+					std::uint64_t count;
+					std::uint64_t sum;
+					std::uint64_t maximum;
+					std::vector< std::uint64_t > buckets;
+			};
+
+			/**
+			 * @param aUnit what a recorded 1 is in the unit of the name, e.g. 1e-6 for microseconds that
+			 * are exported as seconds
+			 */
+			Histogram(	const std::string& aName,
+						const std::string& aHelp,
+						double aUnit = 1.0);
+			/**
+			 *
+			 */
+			Histogram( const Histogram& aHistogram) = delete;
+			/**
+			 *
+			 */
+			Histogram& operator=( const Histogram& aHistogram) = delete;
+			/**
+			 * May be called from any thread, it takes no lock
+			 */
+			void record( std::uint64_t aValue);
+			/**
+			 * The shards merged, the shards may be updated while this runs
+			 */
+			Snapshot getSnapshot() const;
+			/**
+			 *
+			 */
+			const std::string& getName() const
+			{
+				return name;
+			}
+			/**
+			 *
+			 */
+			const std::string& getHelp() const
+			{
+				return help;
+			}
+			/**
+			 *
+			 */
+			double getUnit() const
+			{
+				return unit;
+			}
+			/**
+			 *
+			 */
+			static std::size_t bucketFor( std::uint64_t aValue);
+			/**
+			 * The lowest value that is counted in aBucket
+			 */
+			static std::uint64_t lowestValueOf( std::size_t aBucket);
+			/**
+			 * The highest value that is counted in aBucket
+			 */
+			static std::uint64_t highestValueOf( std::size_t aBucket);
+
+		private:
+			/**
+			 *
+			 */
+			struct Shard
+			{
+					std::atomic< std::uint64_t > buckets[Buckets];
+					std::atomic< std::uint64_t > count;
+					std::atomic< std::uint64_t > sum;
+					std::atomic< std::uint64_t > maximum;
+					char padding[64];
+			};
+
+			std::string name;
+			std::string help;
+			double unit;
+			std::unique_ptr< Shard[] > shards;
+	};
+	// class Histogram
+
+	/**
+	 * Records the lifetime of the object in a Histogram, in microseconds
+	 */
+	class ScopedTimer
+	{
+		public:
+			/**
+			 *
+			 */
+			explicit ScopedTimer( Histogram& aHistogram) :
+								histogram( aHistogram),
+								start( std::chrono::steady_clock::now())
+			{
+			}
+			/**
+			 *
+			 */
+			~ScopedTimer()
+			{
+				histogram.record( static_cast< std::uint64_t >(std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::steady_clock::now() - start).count()));
+			}
+			/**
+			 *
+			 */
+			ScopedTimer( const ScopedTimer& aScopedTimer) = delete;
+			/**
+			 *
+			 */
+			ScopedTimer& operator=( const ScopedTimer& aScopedTimer) = delete;
+
+		private:
+			Histogram& histogram;
+			std::chrono::steady_clock::time_point start;
+	};
+	// class ScopedTimer
+
+	/**
+	 * The metrics of the application by name.
+	 *
+	 * A metric is created the first time it is asked for and lives as long as the registry, so the
+	 * code that updates it looks it up once, typically in a function local static reference, and
+	 * from then on only does a relaxed atomic add on the shard of its thread.
+	 *
+	 * The names follow the Prometheus conventions: robotworld_<what>_<unit>, with _total for
+	 * counters. writePrometheus writes the text exposition format, a Histogram as a summary with
+	 * its quantiles.
+	 */
+	class Metrics
+	{
+		public:
+			/**
+			 * A metric and its value as it is shown to the user
+			 */
+			typedef std::pair< std::string, std::string > Summary;
+
+			/**
+			 *
+			 */
+			static Metrics& getMetrics();
+			/**
+			 *
+			 */
+			Metrics( const Metrics& aMetrics) = delete;
+			/**
+			 *
+			 */
+			Metrics& operator=( const Metrics& aMetrics) = delete;
+			/**
+			 * Throws std::invalid_argument if aName is not a valid name or the name of a metric of another type
+			 */
+			Counter& getCounter(	const std::string& aName,
+									const std::string& aHelp);
+			/**
+			 * @see getCounter
+			 */
+			Gauge& getGauge(	const std::string& aName,
+								const std::string& aHelp);
+			/**
+			 * @see getCounter
+			 * @see Histogram::Histogram
+			 */
+			Histogram& getHistogram(	const std::string& aName,
+										const std::string& aHelp,
+										double aUnit = 1.0);
+			/**
+			 * All metrics in the Prometheus text format
+			 */
+			void writePrometheus( std::ostream& os) const;
+			/**
+			 * Writes the Prometheus text to aFileName. It is written to a temporary file that replaces
+			 * aFileName when complete, so a reader never sees half a file.
+			 */
+			void dump( const std::string& aFileName) const;
+			/**
+			 * Dumps to aFileName every anInterval on a thread of its own, until stopDumping
+			 */
+			void startDumping(	const std::string& aFileName,
+								std::chrono::milliseconds anInterval);
+			/**
+			 * Stops the dumping thread after a last dump
+			 */
+			void stopDumping();
+			/**
+			 * All metrics in the order of their names
+			 */
+			std::vector< Summary > getSummaries() const;
+			/**
+			 * @name Debug functions
+			 */
+			//@{
+			/**
+			 * Returns a 1-line description of the object
+			 */
+			std::string asString() const;
+			/**
+			 * Returns a description of the object with all data of the object usable for debugging
+			 */
+			std::string asDebugString() const;
+			//@}
+
+		private:
+			/**
+			 *
+			 */
+			Metrics();
+			/**
+			 *
+			 */
+			~Metrics();
+			/**
+			 * Throws if aName can not be used for a new metric, the caller holds metricsMutex
+			 */
+			void checkName( const std::string& aName) const;
+
+			std::map< std::string, std::unique_ptr< Counter > > counters;
+			std::map< std::string, std::unique_ptr< Gauge > > gauges;
+			std::map< std::string, std::unique_ptr< Histogram > > histograms;
+			mutable std::mutex metricsMutex;
+
+			std::string dumpFileName;
+			std::chrono::milliseconds dumpInterval;
+			bool dumping;
+			std::thread dumpThread;
+			std::condition_variable dumpCondition;
+			std::mutex dumpMutex;
+	};
+	// class Metrics
+} // namespace Base
+#endif // METRICS_HPP_
@@ -7,6 +7,8 @@
 
 #include "ModelObject.hpp"
 #include <sstream>
+#include "EventBus.hpp"
+#include "TraceLog.hpp"
 #include "TypeInfo.hpp"
 
 namespace Model
@@ -23,6 +25,18 @@ namespace Model
 	ModelObject::~ModelObject()
 	{
 	}
+	/**
+	 *
+	 */
+	void ModelObject::notifyObservers( unsigned aChangedFields)
+	{
+		Base::TraceLog::getTraceLog().trace( Base::TraceEvent::ChangeEvent, Base::TracePhase::Instant, objectId.hash(), aChangedFields);
+		if (isEnabledForNotification())
+		{
+			Base::EventBus::getEventBus().publish( Base::ChangeEvent( objectId, aChangedFields));
+		}
+		notifyObservers();
+	}
 	/**
 	 *
 	 */
@@ -74,6 +74,17 @@ namespace Model
 			 * @return the objectId (identity) of the ModelObject
 			 */
 			const Base::ObjectId& getObjectId() const {return  objectId;}
+			/**
+			 * @name Notifier functions
+			 */
+			//@{
+			using Base::Notifier::notifyObservers;
+			/**
+			 * Publishes a Base::ChangeEvent with aChangedFields (see Base::ChangeEvent::Field) for this
+			 * object on the EventBus and notifies the observers
+			 */
+			void notifyObservers( unsigned aChangedFields);
+			//@}
 			/**
 			 * Converts the contained ModelObject to a std::shared_ptr<DestinationType>
 			 *
@@ -1,17 +1,26 @@
 #include "Notifier.hpp"
 #include <boost/foreach.hpp>
+#include <algorithm>
 #include <sstream>
 #include <typeinfo>
 #include "Observer.hpp"
 #include "Logger.hpp"
+#include "TraceLog.hpp"
+#include "Metrics.hpp"
 
 namespace Base
 {
+	/**
+	 * The Notifiers that are notifying on this thread, innermost last
+	 */
+	static thread_local std::vector< const Notifier* > notifyingOnThisThread;
+
 	/**
 	 *
 	 */
 	Notifier::Notifier( bool enable /*= true*/) :
-								notify( enable)
+								notify( enable),
+								removals( 0)
 	{
 	}
 	/**
@@ -46,6 +55,7 @@ namespace Base
 	 */
 	void Notifier::addObserver( Observer& aObserver)
 	{
+		std::lock_guard< std::mutex > lock( observersMutex);
 		for (Observer* observer : observers)
 		{
 			if (*observer == aObserver)
@@ -60,12 +70,14 @@ namespace Base
 	 */
 	void Notifier::removeObserver( Observer& aObserver)
 	{
+		std::unique_lock< std::mutex > lock( observersMutex);
 		for (std::vector< Observer* >::iterator i = observers.begin(); i != observers.end(); ++i)
 		{
 			if (*(*i) == aObserver)
 			{
 				observers.erase( i);
-				break;
+				waitForNotifications( lock);
+				return;
 			}
 		}
 	}
@@ -74,7 +86,9 @@ namespace Base
 	 */
 	void Notifier::removeAllObservers()
 	{
+		std::unique_lock< std::mutex > lock( observersMutex);
 		observers.erase( observers.begin(), observers.end());
+		waitForNotifications( lock);
 	}
 	/**
 	 *
@@ -83,12 +97,68 @@ namespace Base
 	{
 		if (notify)
 		{
-			for (Observer* observer : observers)
+			// A copy, so an observer may add or remove observers and other threads may do so as well.
+			// A removal waits until this notification is done, so the copied observers stay alive.
+			std::vector< Observer* > currentObservers;
+			unsigned long startRemovals;
+			{
+				std::lock_guard< std::mutex > lock( observersMutex);
+				currentObservers = observers;
+				startRemovals = removals;
+				++notifying[startRemovals];
+			}
+			struct InProgress
+			{
+					InProgress(	Notifier& aNotifier,
+								unsigned long aRemovals) :
+									notifier( aNotifier),
+									removals( aRemovals)
+					{
+						notifyingOnThisThread.push_back( &notifier);
+					}
+					~InProgress()
+					{
+						notifyingOnThisThread.pop_back();
+						std::lock_guard< std::mutex > lock( notifier.observersMutex);
+						if (--notifier.notifying[removals] == 0)
+						{
+							notifier.notifying.erase( removals);
+						}
+						// Only a removal after the start can be waiting for this notification
+						if (removals != notifier.removals)
+						{
+							notifier.notificationsDone.notify_all();
+						}
+					}
+					Notifier& notifier;
+					unsigned long removals;
+			} inProgress( *this, startRemovals);
+			Base::TraceScope trace( Base::TraceEvent::Notification, currentObservers.size());
+			static Base::Histogram& fanOut = Base::Metrics::getMetrics().getHistogram( "robotworld_notifier_fanout", "The observers a notification was sent to");
+			fanOut.record( currentObservers.size());
+			for (Observer* observer : currentObservers)
 			{
 				observer->handleNotification();
 			}
 		}
 	}
+	/**
+	 *
+	 */
+	void Notifier::waitForNotifications( std::unique_lock< std::mutex >& aLock)
+	{
+		unsigned long removal = ++removals;
+		unsigned long onThisThread = static_cast< unsigned long >(std::count( notifyingOnThisThread.begin(), notifyingOnThisThread.end(), this));
+		notificationsDone.wait( aLock, [this, removal, onThisThread]
+		{
+			unsigned long earlier = 0;
+			for (auto i = notifying.begin(); i != notifying.end() && i->first < removal; ++i)
+			{
+				earlier += i->second;
+			}
+			return earlier == onThisThread;
+		});
+	}
 	/**
 	 *
 	 */
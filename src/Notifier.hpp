@@ -3,9 +3,12 @@
 
 #include "Config.hpp"
 
+#include <map>
 #include <string>
 #include <vector>
 
+#include "Thread.hpp"
+
 #include "Observer.hpp"
 
 namespace Base
@@ -62,17 +65,19 @@ namespace Base
 			 */
 			virtual void addObserver( Observer& anObserver);
 			/**
-			 * Removes the Observer from the list of Observers if in the list
+			 * Removes the Observer from the list of Observers if in the list. Returns when the notifications
+			 * by other threads that may still call the Observer are done, so the Observer may be destroyed then.
 			 *
 			 * @param anObserver The Observer to remove
 			 */
 			virtual void removeObserver( Observer& anObserver);
 			/**
-			 * Removes all observer from the list of Observers
+			 * Removes all observer from the list of Observers, waiting as removeObserver does
 			 */
 			virtual void removeAllObservers();
 			/**
-			 * Notifies all observers
+			 * Notifies all observers synchronously, on the calling thread. Observers that must not hold
+			 * up the caller subscribe to the EventBus instead.
 			 */
 			virtual void notifyObservers();
 			//@}
@@ -92,8 +97,24 @@ namespace Base
 			//@}
 
 		private:
+			/**
+			 * Waits until the notifications that started before the removal are done, except the ones on
+			 * the calling thread: those can only finish after the caller returns. aLock holds observersMutex.
+			 */
+			void waitForNotifications( std::unique_lock< std::mutex >& aLock);
+
 			bool notify;
 			std::vector< Observer* > observers;
+			mutable std::mutex observersMutex;
+			/**
+			 * The number of removals so far. A notification is counted under the value it started with.
+			 */
+			unsigned long removals;
+			/**
+			 * The notifications in progress per number of removals at their start
+			 */
+			std::map< unsigned long, unsigned long > notifying;
+			std::condition_variable notificationsDone;
 
 	};
 	// class Notifier
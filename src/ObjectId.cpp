@@ -1,138 +1,215 @@
 #include "ObjectId.hpp"
-#include <sys/timeb.h>  // _ftime(), time_t and struct timeb
-#include <ctime>       // localtime()
-#include <climits>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <stdexcept>
+#include <unordered_map>
 #include "Thread.hpp"
 
 namespace Base
 {
-	/**
-	 *
-	 */
-	/* static */ std::string ObjectId::objectIdNamespace = "";
-
-	static std::mutex newObjectIdMutex;
-
-	/* static */ObjectId ObjectId::newObjectId()
+	namespace
 	{
-		std::lock_guard< std::mutex > lock( newObjectIdMutex);
-
-		static time_t seconds = 0;
-		static unsigned long fraction = 0;
-
-		time_t newSeconds = 0;
-		struct timeb timeBuffer;
+		/**
+		 * The number of bits of the count within a second in the sequence number
+		 */
+		const unsigned FractionBits = 24;
+		/**
+		 * The highest count within a second, the most the 6 digits of the string form can hold
+		 */
+		const std::uint64_t MaximumFraction = 999999;
+		/**
+		 * The length of "YYYY-MM-DD-hh-mm-ss-ffffff"
+		 */
+		const std::string::size_type TimeStampLength = 26;
 
-		ftime( &timeBuffer);
-		newSeconds = timeBuffer.time;
-
-		// Reset seconds and fraction if in a new seconds
-		if (seconds < newSeconds)
-		{
-			seconds = newSeconds;
-			fraction = 0;
-		}
-
-		// Prevent overflow to 0 within the second. This should only happen on fast machines
-		// as the creation of the fraction part is processor speed dependent
-		if (fraction == ULONG_MAX)
+		/**
+		 * FNV-1a, never 0 so that a valid ObjectId is never null
+		 */
+		std::uint64_t hashNamespace( const std::string& aNamespace)
 		{
-			ftime( &timeBuffer);
-			newSeconds = timeBuffer.time;
-
-			if (seconds < newSeconds)
-			{
-				seconds = newSeconds;
-				fraction = 0;
-			} else
+			std::uint64_t hash = 14695981039346656037ULL;
+			for (unsigned char c : aNamespace)
 			{
-				while (seconds >= newSeconds)
-				{
-					ftime( &timeBuffer);
-					newSeconds = timeBuffer.time;
-				}
-				seconds = newSeconds;
-				fraction = 0;
+				hash = (hash ^ c) * 1099511628211ULL;
 			}
+			return hash == 0 ? 1 : hash;
 		}
-
-		time_t sec = seconds;
-		struct tm* timeStruct = gmtime( &sec);
-		if (!timeStruct)
+		/**
+		 * The namespaces by their hash, needed to turn an ObjectId into a string again
+		 */
+		std::unordered_map< std::uint64_t, std::string >& getNamespaces()
 		{
-			fprintf( stderr, "timeStruct is nullptr, seconds were %lu\n", seconds);
-			throw std::invalid_argument("timeStruct is nullptr");
+			static std::unordered_map< std::uint64_t, std::string > namespaces;
+			return namespaces;
 		}
+		std::mutex namespacesMutex;
 
-		char objectIdBuffer[27] = {'\0'};
-		sprintf( objectIdBuffer, "%04d-%02d-%02d-%02d-%02d-%02d-%06lu", timeStruct->tm_year + 1900, timeStruct->tm_mon + 1, timeStruct->tm_mday, timeStruct->tm_hour, timeStruct->tm_min, timeStruct->tm_sec, fraction);
-		std::string objectIdString(ObjectId::objectIdNamespace);
-		objectIdString.append(objectIdBuffer);
-		ObjectId objectId( objectIdString);
-
-		fraction++;
-		return objectId;
-	}
+		/**
+		 *
+		 */
+		std::uint64_t registerNamespace( const std::string& aNamespace)
+		{
+			std::uint64_t hash = hashNamespace( aNamespace);
+			std::lock_guard< std::mutex > lock( namespacesMutex);
+			getNamespaces()[hash] = aNamespace;
+			return hash;
+		}
+		/**
+		 * gmtime_r is POSIX, MinGW has gmtime_s
+		 */
+		bool toUtc(	std::time_t aTime,
+					struct tm& aTimeStruct)
+		{
+#ifdef __MINGW32__
+			return gmtime_s( &aTimeStruct, &aTime) == 0;
+#else
+			return gmtime_r( &aTime, &aTimeStruct) != nullptr;
+#endif
+		}
+		/**
+		 * timegm is not standard, MinGW has _mkgmtime
+		 */
+		std::time_t fromUtc( struct tm& aTimeStruct)
+		{
+#ifdef __MINGW32__
+			return _mkgmtime( &aTimeStruct);
+#else
+			return timegm( &aTimeStruct);
+#endif
+		}
+	} // namespace
 
-	ObjectId::~ObjectId()
-	{
-	}
 	/**
 	 *
 	 */
-	bool ObjectId::operator==( const ObjectId& anObjectId) const
+	/* static */ std::string ObjectId::objectIdNamespace = "";
+	/**
+	 *
+	 */
+	/* static */ObjectId ObjectId::newObjectId()
 	{
-		return ((base&)(*this)) == ((base&)anObjectId);
+		// Hashing the namespace is only needed when a thread sees it for the first time
+		thread_local std::string threadNamespace;
+		thread_local std::uint64_t threadNamespaceHash = 0;
+		if (threadNamespaceHash == 0 || threadNamespace != objectIdNamespace)
+		{
+			threadNamespace = objectIdNamespace;
+			threadNamespaceHash = registerNamespace( threadNamespace);
+		}
+
+		// The next sequence number is the start of the current second or, if that has been handed out
+		// already, the one after the last. A count beyond MaximumFraction borrows from the next second.
+		static std::atomic< std::uint64_t > lastSequence( 0);
+		std::uint64_t seconds = static_cast< std::uint64_t >(std::chrono::duration_cast< std::chrono::seconds >( std::chrono::system_clock::now().time_since_epoch()).count());
+		std::uint64_t now = seconds << FractionBits;
+		std::uint64_t last = lastSequence.load();
+		std::uint64_t next;
+		do
+		{
+			next = std::max( last + 1, now);
+			if ((next & ((1ULL << FractionBits) - 1)) > MaximumFraction)
+			{
+				next = ((next >> FractionBits) + 1) << FractionBits;
+			}
+		} while (!lastSequence.compare_exchange_weak( last, next));
+
+		return ObjectId( threadNamespaceHash, next);
 	}
 	/**
 	 *
 	 */
-	bool ObjectId::operator<( const ObjectId& anObjectId) const
+	ObjectId::ObjectId( const std::string& anObjectIdString) :
+							namespaceHash( 0),
+							sequence( 0)
 	{
-		return ((base&)(*this)) < ((base&)anObjectId);
+		fromString( anObjectIdString);
 	}
 	/**
 	 *
 	 */
-	bool ObjectId::isNull() const
+	std::string ObjectId::toString() const
 	{
-		if (base::empty())
+		if (isNull())
+		{
+			return "";
+		}
+
+		std::string objectIdString;
+		{
+			std::lock_guard< std::mutex > lock( namespacesMutex);
+			auto i = getNamespaces().find( namespaceHash);
+			if (i != getNamespaces().end())
+			{
+				objectIdString = i->second;
+			}
+		}
+
+		std::time_t seconds = static_cast< std::time_t >(sequence >> FractionBits);
+		unsigned long fraction = static_cast< unsigned long >(sequence & ((1ULL << FractionBits) - 1));
+		struct tm timeStruct;
+		if (!toUtc( seconds, timeStruct))
 		{
-			return true;
+			throw std::invalid_argument( "Invalid time in ObjectId");
 		}
-		return false;
+
+		char objectIdBuffer[64] = { '\0' };
+		std::snprintf( objectIdBuffer, sizeof(objectIdBuffer), "%04d-%02d-%02d-%02d-%02d-%02d-%06lu", timeStruct.tm_year + 1900, timeStruct.tm_mon + 1, timeStruct.tm_mday, timeStruct.tm_hour, timeStruct.tm_min, timeStruct.tm_sec, fraction);
+		objectIdString.append( objectIdBuffer);
+		return objectIdString;
 	}
 	/**
 	 *
 	 */
-	bool ObjectId::isValid() const
+	void ObjectId::fromString( const std::string& anObjectIdString)
 	{
-		if (isNull())
+		if (anObjectIdString.empty())
+		{
+			namespaceHash = 0;
+			sequence = 0;
+			return;
+		}
+		if (anObjectIdString.size() < TimeStampLength)
+		{
+			throw std::invalid_argument( "Not an ObjectId: " + anObjectIdString);
+		}
+
+		std::string timeStamp = anObjectIdString.substr( anObjectIdString.size() - TimeStampLength);
+		struct tm timeStruct = tm();
+		unsigned long fraction = 0;
+		int length = 0;
+		if (std::sscanf( timeStamp.c_str(), "%4d-%2d-%2d-%2d-%2d-%2d-%6lu%n", &timeStruct.tm_year, &timeStruct.tm_mon, &timeStruct.tm_mday, &timeStruct.tm_hour, &timeStruct.tm_min, &timeStruct.tm_sec, &fraction, &length) != 7 ||
+			static_cast< std::string::size_type >(length) != TimeStampLength ||
+			fraction > MaximumFraction)
 		{
-			return false;
+			throw std::invalid_argument( "Not an ObjectId: " + anObjectIdString);
 		}
-		return true;
+		timeStruct.tm_year -= 1900;
+		timeStruct.tm_mon -= 1;
+		std::time_t seconds = fromUtc( timeStruct);
+
+		namespaceHash = registerNamespace( anObjectIdString.substr( 0, anObjectIdString.size() - TimeStampLength));
+		sequence = (static_cast< std::uint64_t >(seconds) << FractionBits) | fraction;
 	}
 	/**
 	 *
 	 */
-	/*virtual*/std::string ObjectId::asString() const
+	std::string ObjectId::asString() const
 	{
-		if (isNull())
-		{
-			return "";
-		}
-		return std::string( base::begin(), base::end());
+		return toString();
 	}
-
 	/**
 	 *
 	 */
-	/*virtual*/std::string ObjectId::asDebugString() const
+	std::string ObjectId::asDebugString() const
 	{
 		return asString();
 	}
-
+	/**
+	 *
+	 */
 	std::ostream& operator<<( 	std::ostream& os,
 								const ObjectId& anObjectId)
 	{
@@ -3,289 +3,125 @@
 
 #include "Config.hpp"
 
-#include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <iostream>
-#include <iterator>
 #include <string>
-#include <vector>
-
 
 namespace Base
 {
 	/**
-	 * The ObjectId class is also used in Dagda. Therefore it has the required
-	 * PortableServer::ObjectId / unbounded sequence interface.
+	 * The identity of an object: a 64 bit hash of the namespace it was created in and a 64 bit sequence
+	 * number, 16 bytes without any heap allocation. Comparing and hashing an ObjectId is O(1).
 	 *
-	 * The OID class is 16 bytes, this class is 24 bytes. If one is memory constraint
-	 * the OID class may be of some help. Be warned: the OID class is not actively
-	 * maintained anymore (but than, who reeds this besides me, the maintainer).
+	 * The sequence number is the number of seconds since the epoch in the upper 40 bits and a count within
+	 * that second in the lower 24 bits, so the string form is made from it only when asked for
+	 * (for display and on the wire) and is the same as it always was:
+	 * namespace + "YYYY-MM-DD-hh-mm-ss-ffffff" (UTC). The count stays below 1000000 so that it fits the
+	 * 6 digits, more ids in a second take the numbers of the next second.
 	 */
-	class ObjectId : public std::vector< unsigned char >
+	class ObjectId
 	{
 		public:
-			typedef unsigned char value_type;
-			typedef unsigned char* pointer;
-			typedef const unsigned char* const_pointer;
-			typedef unsigned char& reference;
-			typedef const unsigned char& const_reference;
-			typedef std::vector< unsigned char > base;
-
 			/**
 			 * If an ObjectId should be *really* universal unique every application should have its own namespace
 			 */
 			static std::string objectIdNamespace;
-
 			/**
-			 * This function returns an ObjectId that is guaranteed to be unique in the application it
-			 * is generated in. If multiple application use the same library it is the responsibility of
-			 * the applications to ensure uniqueness between applications.
+			 * A new ObjectId in the objectIdNamespace. Lock free, unless the namespace is new to the thread.
 			 */
 			static ObjectId newObjectId();
 
 			/**
-			 * @name CORBA required interface for PortableServer::ObjectId and sequence< T >
-			 */
-			//@{
-			/**
-			 * Default ctor.
-			 *
-			 * Also specified by
+			 * A null ObjectId
 			 */
 			ObjectId() :
-				base()
-			{
-			}
-			/**
-			 * Maximum ctor.
-			 *
-			 * @param max Initial elements reservation
-			 */
-			ObjectId( unsigned long max) :
-				base( max)
-			{
-			}
-			/**
-			 * Data ctor.
-			 *
-			 * @param max 		Initial elements reservation. Is actually ignored
-			 * @param length 	Length of the data
-			 * @param data 		Start of the data
-			 * @param release 	If true the sequences owns and manages any containing pointers
-			 * 				  	Is actually ignored and always true.
-			 */
-			ObjectId( 	unsigned long /*max*/,
-						unsigned long len,
-						unsigned char* aDataPointer,
-						bool /*rel = true-*/) :
-							base( aDataPointer, aDataPointer + len)
-			{
-			}
-			/**
-			 *	Makes a deep copy.
-			 */
-			ObjectId( const ObjectId& anObjectId) :
-				base( anObjectId)
-			{
-			}
-			/**
-			 * Also specified by PortableServer::ObjectId and sequence< T >
-			 */
-			virtual ~ObjectId();
-			/**
-			 * @return The virtual maximum of bytes for this ObjectId. This maximum can safely be ignored.
-			 *
-			 */
-			unsigned long maximum() const
-			{
-				return base::capacity();
-			}
-
-			/**
-			 * If the current length of the sequence is less than the new length we append new elements
-			 * which are created by calling the default constructor.  If the current length is more
-			 * than the new length we just cut of the tail of the sequence.
-			 *
-			 * @param length The new length of the sequence
-			 */
-			void length( unsigned long len)
-			{
-				if (base::size() < len)
-				{
-					base::insert( base::end(), len - base::size(), value_type());
-				} else
-				{
-					base::erase( base::begin() + len, base::end());
-				}
-			}
-
-			/**
-			 *
-			 * @return The current length of the ObjectId
-			 */
-			unsigned long length() const
-			{
-				return base::size();
-			}
-
-			/**
-			 *
-			 * @param index
-			 * @return The mutable character at index.
-			 */
-			reference operator[]( unsigned long index)
+							namespaceHash( 0),
+							sequence( 0)
 			{
-				return base::operator[]( index);
 			}
-
 			/**
 			 *
-			 * @param index
-			 * @return The non-mutable character at index.
-			 */
-			const_reference operator[]( unsigned long index) const
-			{
-				return base::operator[]( index);
-			}
-
-			/**
-			 * This returns always true for a value container
-			 *
-			 * @return true if this container owns the data.
-			 */
-			bool release() const
-			{
-				return true;
-			}
-
-			/**
-			 * @param max Is ignored
-			 * @param rel Is ignored and is treated as true
 			 */
-			void replace( 	unsigned long /*max*/,
-							unsigned long len,
-							pointer newData,
-							bool /*rel = true*/)
+			ObjectId(	std::uint64_t aNamespaceHash,
+						std::uint64_t aSequence) :
+							namespaceHash( aNamespaceHash),
+							sequence( aSequence)
 			{
-				base::erase( base::begin(), base::end());
-				base::insert( base::begin(), newData, newData + len);
 			}
-
 			/**
-			 *
-			 * @param 	orphan
-			 * @return 	The ObjectId as a modifyable continues buffer.
-			 * 			If the buffer is modified as that it expands the buffer this \will
-			 * 			lead to failure eventually
+			 * Parses the string form, see fromString
 			 */
-			pointer get_buffer( bool orphan = false)
-			{
-				if (orphan)
-				{
-					pointer t = allocbuf( base::size());
-					std::copy( base::begin(), base::end(), t);
-					base::erase( base::begin(), base::end());
-					return t;
-				} else
-				{
-					return &base::operator[]( 0);
-				}
-			}
-
+			explicit ObjectId( const std::string& anObjectIdString);
 			/**
 			 *
-			 * @return The ObjectId as a readonly continues buffer.
 			 */
-			const_pointer get_buffer() const
+			bool operator==( const ObjectId& anObjectId) const
 			{
-				return &base::operator[]( 0);
+				return namespaceHash == anObjectId.namespaceHash && sequence == anObjectId.sequence;
 			}
-
 			/**
-			 * Do not use. It always throws an Danu::InvalidRequest exception.
 			 *
-			 * @param nelems
-			 * @return a new-ed buffer
 			 */
-			static pointer allocbuf( unsigned long nelems)
+			bool operator!=( const ObjectId& anObjectId) const
 			{
-				return new value_type[nelems];
+				return !(*this == anObjectId);
 			}
 			/**
-			 * Do not use. It always throws an Danu::InvalidRequest exception.
-			 *
-			 * @param aT The buffer to free
+			 * Orders by namespace and within a namespace by creation
 			 */
-			static void freebuf( pointer aT)
+			bool operator<( const ObjectId& anObjectId) const
 			{
-				delete[] aT;
+				return namespaceHash < anObjectId.namespaceHash || (namespaceHash == anObjectId.namespaceHash && sequence < anObjectId.sequence);
 			}
-			//@} // CORBA required interface
-
 			/**
 			 *
 			 */
-			template< typename InputIterator >
-			ObjectId( 	InputIterator first,
-						InputIterator last) :
-						base( first, last)
+			std::uint64_t getNamespaceHash() const
 			{
+				return namespaceHash;
 			}
 			/**
 			 *
 			 */
-			ObjectId( const std::string& anObjectIdString) :
-				base( anObjectIdString.begin(), anObjectIdString.end())
+			std::uint64_t getSequence() const
 			{
+				return sequence;
 			}
 			/**
 			 *
 			 */
-			ObjectId& operator=( const ObjectId& anObjectId)
+			std::size_t hash() const
 			{
-				if (this != &anObjectId)
-				{
-					base::operator=( anObjectId);
-				}
-				return *this;
+				return static_cast< std::size_t >(namespaceHash ^ (sequence * 0x9E3779B97F4A7C15ULL));
 			}
-
-			/**
-			 * @param anObjectId
-			 * @return True if the Danu::ObjectId part is the same
-			 */
-			bool operator==( const ObjectId& anObjectId) const;
-			/**
-			 * @param anObjectId
-			 * @return True if the Danu::ObjectId part is less
-			 */
-			bool operator<( const ObjectId& anObjectId) const;
 			/**
 			 * Calling obj1.fromString( obj2.toString()) has the same effect as assignment, obj1 = obj2.
 			 *
 			 * @return std::string
 			 */
-			std::string toString() const
-			{
-				return std::string( begin(), end());
-			}
+			std::string toString() const;
 			/**
 			 * Calling obj1.fromString( obj2.toString()) has the same effect as assignment, obj1 = obj2.
 			 *
 			 * @param anObjectIdString A string representation of an ObjectId.
+			 * @throw std::invalid_argument if anObjectIdString is not the string form of an ObjectId
 			 */
-			void fromString( const std::string& anObjectIdString)
-			{
-				clear();
-				insert( begin(), anObjectIdString.begin(), anObjectIdString.end());
-			}
+			void fromString( const std::string& anObjectIdString);
 			/**
 			 *
 			 */
-			bool isNull() const;
+			bool isNull() const
+			{
+				return namespaceHash == 0 && sequence == 0;
+			}
 			/**
 			 *
 			 */
-			bool isValid() const;
+			bool isValid() const
+			{
+				return !isNull();
+			}
 			/**
 			 * @name Debug functions
 			 */
@@ -293,20 +129,35 @@ namespace Base
 			/**
 			 * Returns a 1-line description of the object
 			 */
-			/*virtual*/
 			std::string asString() const;
 			/**
 			 * Returns a description of the object with all data of the object usable for debugging
 			 */
-			/*virtual*/
 			std::string asDebugString() const;
 			//@}
 
-
+		private:
+			std::uint64_t namespaceHash;
+			std::uint64_t sequence;
 	};
 	//	class ObjectId
 
 	std::ostream& operator<<( 	std::ostream& os,
 								const ObjectId& anObjectId);
 } // namespace Base
+
+namespace std
+{
+	/**
+	 * Lets an ObjectId be the key of an unordered container
+	 */
+	template<>
+	struct hash< Base::ObjectId >
+	{
+			std::size_t operator()( const Base::ObjectId& anObjectId) const
+			{
+				return anObjectId.hash();
+			}
+	};
+} // namespace std
 #endif // OBJECTID_HPP_
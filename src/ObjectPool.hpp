@@ -0,0 +1,92 @@
+#ifndef OBJECTPOOL_HPP_
+#define OBJECTPOOL_HPP_
+
+#include "Config.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "AllocationCounter.hpp"
+#include "Thread.hpp"
+
+namespace Base
+{
+	/**
+	 * Hands out shared_ptrs to objects that are reused instead of being allocated for every use.
+	 *
+	 * The pool keeps one reference to every object; an object is free again as soon as the pool holds the
+	 * only reference to it, i.e. when the last user has released its shared_ptr. Handing out a free object
+	 * only copies a shared_ptr and does not allocate; the pool only grows (and allocates) if all objects
+	 * are in use. An acquired object is in the state its previous user left it, so the user has to reset
+	 * it, which typically keeps the capacity of its containers and therefore does not allocate either.
+	 */
+	template< typename ObjectType >
+	class ObjectPool
+	{
+		public:
+			/**
+			 *
+			 */
+			explicit ObjectPool( std::size_t anInitialSize = 0) :
+								next( 0)
+			{
+				objects.reserve( anInitialSize);
+				for (std::size_t i = 0; i < anInitialSize; ++i)
+				{
+					objects.push_back( std::make_shared< ObjectType >());
+				}
+				AllocationCounter::add( anInitialSize);
+			}
+			/**
+			 *
+			 */
+			ObjectPool( const ObjectPool& anObjectPool) = delete;
+			/**
+			 *
+			 */
+			ObjectPool& operator=( const ObjectPool& anObjectPool) = delete;
+			/**
+			 *
+			 */
+			std::shared_ptr< ObjectType > acquire()
+			{
+				std::lock_guard< std::mutex > lock( poolMutex);
+
+				// Objects are usually released in the order they were acquired so searching
+				// from the last acquired object on normally finds a free one right away
+				for (std::size_t i = 0; i < objects.size(); ++i)
+				{
+					std::size_t index = (next + i) % objects.size();
+					if (objects[index].use_count() == 1)
+					{
+						// use_count() is a relaxed read: synchronise with the release of the last user
+						std::atomic_thread_fence( std::memory_order_acquire);
+						next = index + 1;
+						return objects[index];
+					}
+				}
+				objects.push_back( std::make_shared< ObjectType >());
+				AllocationCounter::add();
+				next = 0;
+				return objects.back();
+			}
+			/**
+			 *
+			 * @return the number of objects in the pool, in use or not
+			 */
+			std::size_t size() const
+			{
+				std::lock_guard< std::mutex > lock( poolMutex);
+				return objects.size();
+			}
+
+		private:
+			std::vector< std::shared_ptr< ObjectType > > objects;
+			std::size_t next;
+			mutable std::mutex poolMutex;
+	};
+	// class ObjectPool
+} // namespace Base
+#endif // OBJECTPOOL_HPP_
@@ -8,6 +8,92 @@
  * Author: jkr
  */
 
+#include "Config.hpp"
+
+#ifdef ROBOTWORLD_HEADLESS
+
+namespace Widgets
+{
+	/**
+	 * The headless replacement of wxPoint, it only offers what the model uses
+	 */
+	class Point
+	{
+		public:
+			/**
+			 *
+			 */
+			Point() :
+							x( 0),
+							y( 0)
+			{
+			}
+			/**
+			 *
+			 */
+			Point(	int anX,
+					int anY) :
+							x( anX),
+							y( anY)
+			{
+			}
+			/**
+			 *
+			 */
+			bool operator==( const Point& aPoint) const
+			{
+				return x == aPoint.x && y == aPoint.y;
+			}
+			/**
+			 *
+			 */
+			bool operator!=( const Point& aPoint) const
+			{
+				return !(*this == aPoint);
+			}
+			/**
+			 *
+			 */
+			Point operator+( const Point& aPoint) const
+			{
+				return Point( x + aPoint.x, y + aPoint.y);
+			}
+			/**
+			 *
+			 */
+			Point operator-( const Point& aPoint) const
+			{
+				return Point( x - aPoint.x, y - aPoint.y);
+			}
+			/**
+			 *
+			 */
+			Point& operator+=( const Point& aPoint)
+			{
+				x += aPoint.x;
+				y += aPoint.y;
+				return *this;
+			}
+			/**
+			 *
+			 */
+			Point& operator-=( const Point& aPoint)
+			{
+				x -= aPoint.x;
+				y -= aPoint.y;
+				return *this;
+			}
+
+			int x;
+			int y;
+	};
+	// class Point
+} // namespace Widgets
+
+#define DefaultPosition Widgets::Point( -1, -1)
+
+#else
+
 #include <wx/gdicmn.h>
 
 namespace Widgets
@@ -17,6 +103,11 @@ namespace Widgets
 	 */
 	typedef wxPoint Point;
 } // namespace Widgets
+
+#define DefaultPosition wxDefaultPosition
+
+#endif // ROBOTWORLD_HEADLESS
+
 using namespace Widgets;
 
 
@@ -143,6 +143,13 @@ namespace View
 	{
 		centre = aPoint;
 	}
+	/**
+	 *
+	 */
+	Rect RectangleShape::getBoundingBox() const
+	{
+		return Rect( centre.x - (size.x / 2), centre.y - (size.y / 2), size.x, size.y).Inflate( borderWidth + 1);
+	}
 	/**
 	 *
 	 */
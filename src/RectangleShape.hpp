@@ -84,6 +84,10 @@ namespace View
 			 *
 			 */
 			virtual void setCentre( const Point& aPoint);
+			/**
+			 *
+			 */
+			virtual Rect getBoundingBox() const;
 			/**
 			 *
 			 */
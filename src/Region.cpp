@@ -0,0 +1,92 @@
+#include "Region.hpp"
+#include <cmath>
+
+#ifdef ROBOTWORLD_HEADLESS
+
+namespace Widgets
+{
+	/**
+	 * Twice the signed area, positive for counter clockwise polygons in a y-up coordinate system
+	 */
+	template< typename VertexType >
+	static double signedArea( const std::vector< VertexType >& aPolygon)
+	{
+		double area = 0.0;
+		for (std::size_t i = 0; i < aPolygon.size(); ++i)
+		{
+			const VertexType& current = aPolygon[i];
+			const VertexType& next = aPolygon[(i + 1) % aPolygon.size()];
+			area += current.x * next.y - next.x * current.y;
+		}
+		return area;
+	}
+	/**
+	 *
+	 */
+	Region::Region(	std::size_t aNumberOfPoints,
+					const Point* aPoints)
+	{
+		vertices.reserve( aNumberOfPoints);
+		for (std::size_t i = 0; i < aNumberOfPoints; ++i)
+		{
+			vertices.push_back( Vertex { static_cast< double >(aPoints[i].x), static_cast< double >(aPoints[i].y) });
+		}
+	}
+	/**
+	 * Sutherland-Hodgman: clips this polygon against every edge of aRegion in turn
+	 */
+	bool Region::Intersect( const Region& aRegion)
+	{
+		const std::vector< Vertex >& clipPolygon = aRegion.vertices;
+		// Like a wxRegion a polygon without area is empty
+		if (clipPolygon.size() < 3 || aRegion.IsEmpty())
+		{
+			vertices.clear();
+			return true;
+		}
+		// The inside of an edge is on the left for a counter clockwise clip polygon, on the right otherwise
+		double orientation = signedArea( clipPolygon) >= 0.0 ? 1.0 : -1.0;
+
+		for (std::size_t i = 0; i < clipPolygon.size() && !vertices.empty(); ++i)
+		{
+			const Vertex& edgeStart = clipPolygon[i];
+			const Vertex& edgeEnd = clipPolygon[(i + 1) % clipPolygon.size()];
+			double edgeX = edgeEnd.x - edgeStart.x;
+			double edgeY = edgeEnd.y - edgeStart.y;
+
+			std::vector< Vertex > input;
+			input.swap( vertices);
+			for (std::size_t j = 0; j < input.size(); ++j)
+			{
+				const Vertex& current = input[j];
+				const Vertex& previous = input[(j + input.size() - 1) % input.size()];
+				double currentSide = orientation * (edgeX * (current.y - edgeStart.y) - edgeY * (current.x - edgeStart.x));
+				double previousSide = orientation * (edgeX * (previous.y - edgeStart.y) - edgeY * (previous.x - edgeStart.x));
+
+				if (currentSide >= 0.0)
+				{
+					if (previousSide < 0.0)
+					{
+						double t = previousSide / (previousSide - currentSide);
+						vertices.push_back( Vertex { previous.x + t * (current.x - previous.x), previous.y + t * (current.y - previous.y) });
+					}
+					vertices.push_back( current);
+				} else if (previousSide >= 0.0)
+				{
+					double t = previousSide / (previousSide - currentSide);
+					vertices.push_back( Vertex { previous.x + t * (current.x - previous.x), previous.y + t * (current.y - previous.y) });
+				}
+			}
+		}
+		return true;
+	}
+	/**
+	 *
+	 */
+	bool Region::IsEmpty() const
+	{
+		return vertices.size() < 3 || std::abs( signedArea( vertices)) < 1e-9;
+	}
+} // namespace Widgets
+
+#endif // ROBOTWORLD_HEADLESS
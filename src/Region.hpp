@@ -8,6 +8,66 @@
  * Author: jkr
  */
 
+#include "Config.hpp"
+
+#ifdef ROBOTWORLD_HEADLESS
+
+#include <cstddef>
+#include <vector>
+
+#include "Point.hpp"
+
+namespace Widgets
+{
+	/**
+	 * The headless replacement of wxRegion, it only offers what the model uses.
+	 *
+	 * A Region is a single convex polygon, which is what the model uses regions for: the
+	 * (rotated) rectangles of robots, way points and goals.
+	 */
+	class Region
+	{
+		public:
+			/**
+			 *
+			 */
+			Region()
+			{
+			}
+			/**
+			 *
+			 */
+			Region(	std::size_t aNumberOfPoints,
+					const Point* aPoints);
+			/**
+			 * Replaces the region with its intersection with aRegion, which must be convex.
+			 *
+			 * @return true, as wxRegion::Intersect does if it succeeds. Use IsEmpty to check for an overlap.
+			 */
+			bool Intersect( const Region& aRegion);
+			/**
+			 *
+			 * @return true if the region has no area
+			 */
+			bool IsEmpty() const;
+
+		private:
+			/**
+			 *
+			 */
+			struct Vertex
+			{
+					double x;
+					double y;
+			};
+
+			std::vector< Vertex > vertices;
+	};
+	// class Region
+} // namespace Widgets
+
+#else
+
 #include "wx/region.h"
 
 namespace Widgets
@@ -17,7 +77,10 @@ namespace Widgets
 	 */
 	typedef wxRegion Region;
 } // namespace Widgets
+
+#endif // ROBOTWORLD_HEADLESS
+
 using namespace Widgets;
 
 
-#endif // SIZE_HPP_
+#endif // REGION_HPP_
@@ -0,0 +1,324 @@
+#ifndef RINGBUFFER_HPP_
+#define RINGBUFFER_HPP_
+
+#include "Config.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "Thread.hpp"
+
+namespace Base
+{
+	/**
+	 * What RingBuffer::enqueue does if the buffer is full
+	 */
+	enum class OverflowPolicy
+	{
+		DropOldest, //!< Removes the oldest element to make room for the new one
+		DropNewest, //!< Does not enqueue the new element
+		Block //!< Waits until the consumer has made room
+	};
+	/**
+	 *
+	 */
+	enum class Producers
+	{
+		Single, Multiple
+	};
+
+	/**
+	 * A bounded lock-free queue for one consumer and one (Producers::Single) or more (Producers::Multiple) producers.
+	 *
+	 * Every cell carries a sequence number that tells producers and consumers whether the cell is free
+	 * or filled for the current lap around the buffer (D. Vyukov's bounded queue), so neither side ever
+	 * takes a lock. A single producer claims its cell with a plain store, multiple producers with a CAS.
+	 * The consumer side always uses a CAS because with OverflowPolicy::DropOldest a producer removes the
+	 * oldest element itself.
+	 *
+	 * The capacity is rounded up to a power of 2. The blocking functions spin, yield and then sleep
+	 * a little while waiting; there is no condition variable to signal.
+	 */
+	template< typename ContentType, Producers producers = Producers::Multiple >
+	class RingBuffer
+	{
+		public:
+			/**
+			 *
+			 */
+			explicit RingBuffer(	std::size_t aCapacity,
+									OverflowPolicy anOverflowPolicy = OverflowPolicy::DropOldest) :
+								mask( roundUpToPowerOf2( aCapacity) - 1),
+								overflowPolicy( anOverflowPolicy),
+								buffer( new Cell[mask + 1]),
+								enqueuePosition( 0),
+								dequeuePosition( 0),
+								dropped( 0)
+			{
+				for (std::size_t i = 0; i <= mask; ++i)
+				{
+					buffer[i].sequence.store( i, std::memory_order_relaxed);
+				}
+			}
+			/**
+			 *
+			 */
+			RingBuffer( const RingBuffer& aRingBuffer) = delete;
+			/**
+			 *
+			 */
+			RingBuffer& operator=( const RingBuffer& aRingBuffer) = delete;
+			/**
+			 *
+			 * @return false if anElement was dropped (OverflowPolicy::DropNewest and the buffer was full)
+			 */
+			bool enqueue( const ContentType& anElement)
+			{
+				return emplace( anElement);
+			}
+			/**
+			 *
+			 * @return false if anElement was dropped (OverflowPolicy::DropNewest and the buffer was full)
+			 */
+			bool enqueue( ContentType&& anElement)
+			{
+				return emplace( std::move( anElement));
+			}
+			/**
+			 *
+			 * @return false if the buffer was empty
+			 */
+			bool tryDequeue( ContentType& anElement)
+			{
+				std::size_t position = dequeuePosition.load( std::memory_order_relaxed);
+				for (;;)
+				{
+					Cell& cell = buffer[position & mask];
+					std::size_t sequence = cell.sequence.load( std::memory_order_acquire);
+					std::intptr_t difference = static_cast< std::intptr_t >(sequence) - static_cast< std::intptr_t >(position + 1);
+					if (difference == 0)
+					{
+						if (dequeuePosition.compare_exchange_weak( position, position + 1, std::memory_order_relaxed))
+						{
+							anElement = std::move( cell.element);
+							// Do not keep e.g. the object of a shared_ptr alive until the cell is reused
+							cell.element = ContentType();
+							cell.sequence.store( position + mask + 1, std::memory_order_release);
+							return true;
+						}
+					} else if (difference < 0)
+					{
+						return false;
+					} else
+					{
+						position = dequeuePosition.load( std::memory_order_relaxed);
+					}
+				}
+			}
+			/**
+			 * Blocks until an element is available
+			 */
+			ContentType dequeue()
+			{
+				ContentType element;
+				for (unsigned long attempt = 0; !tryDequeue( element); ++attempt)
+				{
+					backOff( attempt);
+				}
+				return element;
+			}
+			/**
+			 * Dequeues up to aMaximum elements with a single claim on the buffer and writes them to anOutput.
+			 *
+			 * @return the number of elements dequeued, 0 if the buffer was empty
+			 */
+			template< typename OutputIterator >
+			std::size_t dequeue(	OutputIterator anOutput,
+									std::size_t aMaximum)
+			{
+				std::size_t position = dequeuePosition.load( std::memory_order_relaxed);
+				for (;;)
+				{
+					std::size_t count = 0;
+					while (count < aMaximum && count <= mask && buffer[(position + count) & mask].sequence.load( std::memory_order_acquire) == position + count + 1)
+					{
+						++count;
+					}
+					if (count == 0)
+					{
+						std::size_t sequence = buffer[position & mask].sequence.load( std::memory_order_acquire);
+						if (static_cast< std::intptr_t >(sequence) - static_cast< std::intptr_t >(position + 1) < 0)
+						{
+							return 0;
+						}
+						position = dequeuePosition.load( std::memory_order_relaxed);
+						continue;
+					}
+					if (dequeuePosition.compare_exchange_weak( position, position + count, std::memory_order_relaxed))
+					{
+						for (std::size_t i = 0; i < count; ++i)
+						{
+							Cell& cell = buffer[(position + i) & mask];
+							*anOutput++ = std::move( cell.element);
+							cell.element = ContentType();
+							cell.sequence.store( position + i + mask + 1, std::memory_order_release);
+						}
+						return count;
+					}
+				}
+			}
+			/**
+			 * Approximate if there are concurrent producers or consumers
+			 */
+			std::size_t size() const
+			{
+				std::size_t dequeued = dequeuePosition.load( std::memory_order_relaxed);
+				std::size_t enqueued = enqueuePosition.load( std::memory_order_relaxed);
+				return enqueued > dequeued ? std::min( enqueued - dequeued, capacity()) : 0;
+			}
+			/**
+			 *
+			 */
+			bool empty() const
+			{
+				return size() == 0;
+			}
+			/**
+			 *
+			 */
+			std::size_t capacity() const
+			{
+				return mask + 1;
+			}
+			/**
+			 *
+			 */
+			OverflowPolicy getOverflowPolicy() const
+			{
+				return overflowPolicy;
+			}
+			/**
+			 * @return the number of elements that were dropped because of the overflow policy
+			 */
+			unsigned long getDropped() const
+			{
+				return dropped.load( std::memory_order_relaxed);
+			}
+
+		private:
+			/**
+			 *
+			 */
+			struct Cell
+			{
+					std::atomic< std::size_t > sequence;
+					ContentType element;
+			};
+			/**
+			 *
+			 */
+			template< typename ElementType >
+			bool emplace( ElementType&& anElement)
+			{
+				std::size_t position = enqueuePosition.load( std::memory_order_relaxed);
+				for (unsigned long attempt = 0;; ++attempt)
+				{
+					Cell& cell = buffer[position & mask];
+					std::size_t sequence = cell.sequence.load( std::memory_order_acquire);
+					std::intptr_t difference = static_cast< std::intptr_t >(sequence) - static_cast< std::intptr_t >(position);
+					if (difference == 0)
+					{
+						if (producers == Producers::Single)
+						{
+							enqueuePosition.store( position + 1, std::memory_order_relaxed);
+						} else if (!enqueuePosition.compare_exchange_weak( position, position + 1, std::memory_order_relaxed))
+						{
+							continue;
+						}
+						cell.element = std::forward< ElementType >( anElement);
+						cell.sequence.store( position + 1, std::memory_order_release);
+						return true;
+					} else if (difference < 0)
+					{
+						// Full
+						switch (overflowPolicy)
+						{
+							case OverflowPolicy::DropNewest:
+							{
+								dropped.fetch_add( 1, std::memory_order_relaxed);
+								return false;
+							}
+							case OverflowPolicy::DropOldest:
+							{
+								ContentType oldest;
+								if (tryDequeue( oldest))
+								{
+									dropped.fetch_add( 1, std::memory_order_relaxed);
+								}
+								break;
+							}
+							case OverflowPolicy::Block:
+							{
+								backOff( attempt);
+								break;
+							}
+						}
+						position = enqueuePosition.load( std::memory_order_relaxed);
+					} else
+					{
+						position = enqueuePosition.load( std::memory_order_relaxed);
+					}
+				}
+			}
+			/**
+			 *
+			 */
+			static void backOff( unsigned long anAttempt)
+			{
+				if (anAttempt < 64)
+				{
+					std::this_thread::yield();
+				} else
+				{
+					std::this_thread::sleep_for( std::chrono::microseconds( 100));
+				}
+			}
+			/**
+			 *
+			 */
+			static std::size_t roundUpToPowerOf2( std::size_t aCapacity)
+			{
+				if (aCapacity < 2)
+				{
+					throw std::invalid_argument( "RingBuffer: capacity must be at least 2");
+				}
+				std::size_t capacity = 1;
+				while (capacity < aCapacity)
+				{
+					capacity <<= 1;
+				}
+				return capacity;
+			}
+
+			const std::size_t mask;
+			const OverflowPolicy overflowPolicy;
+			std::unique_ptr< Cell[] > buffer;
+			/**
+			 * The producer and consumer positions live on their own cache line so that producers and
+			 * the consumer do not invalidate each other's cache line on every operation
+			 */
+			char padding1[64];
+			std::atomic< std::size_t > enqueuePosition;
+			char padding2[64 - sizeof( std::atomic< std::size_t >)];
+			std::atomic< std::size_t > dequeuePosition;
+			char padding3[64 - sizeof( std::atomic< std::size_t >)];
+			std::atomic< unsigned long > dropped;
+	};
+	// class RingBuffer
+} // namespace Base
+#endif // RINGBUFFER_HPP_
@@ -1,4 +1,5 @@
 #include "Robot.hpp"
+#include <algorithm>
 #include <sstream>
 #include <ctime>
 #include <chrono>
@@ -13,9 +14,12 @@
 #include "CommunicationService.hpp"
 #include "Client.hpp"
 #include "Message.hpp"
-#include "MainFrameWindow.hpp"
-#include "MainApplication.hpp"
+#include "CommandlineArguments.hpp"
 #include "LaserDistanceSensor.hpp"
+#include "WorkStealingPool.hpp"
+#include "EventBus.hpp"
+#include "TraceLog.hpp"
+#include "Metrics.hpp"
 
 namespace Model {
 
@@ -23,8 +27,11 @@ namespace Model {
  *
  */
 Robot::Robot() :
-		name(""), size( DefaultSize), position( DefaultPosition), front(0, 0), speed(
-				0.0), acting(false), driving(false), communicating(false) {
+		robotWorld(&RobotWorld::getRobotWorld()), robotStateStore(
+				robotWorld->getRobotStateStore()), state(
+				robotStateStore->allocate()), name(""), size( DefaultSize), astar(
+				*robotWorld), acting(false), driving(false), communicating(false) {
+	state.setPosition( DefaultPosition);
 	std::shared_ptr<AbstractSensor> laserSensor(new LaserDistanceSensor(this));
 	attachSensor(laserSensor);
 }
@@ -33,9 +40,11 @@ Robot::Robot() :
  *
  */
 Robot::Robot(const std::string& aName) :
-		name(aName), size( DefaultSize), position( DefaultPosition), front(0,
-				0), speed(0.0), acting(false), driving(false), communicating(
-				false) {
+		robotWorld(&RobotWorld::getRobotWorld()), robotStateStore(
+				robotWorld->getRobotStateStore()), state(
+				robotStateStore->allocate()), name(aName), size( DefaultSize), astar(
+				*robotWorld), acting(false), driving(false), communicating(false) {
+	state.setPosition( DefaultPosition);
 	std::shared_ptr<AbstractSensor> laserSensor(new LaserDistanceSensor(this));
 	attachSensor(laserSensor);
 }
@@ -44,8 +53,25 @@ Robot::Robot(const std::string& aName) :
  *
  */
 Robot::Robot(const std::string& aName, const Point& aPosition) :
-		name(aName), size( DefaultSize), position(aPosition), front(0, 0), speed(
-				0.0), acting(false), driving(false), communicating(false) {
+		robotWorld(&RobotWorld::getRobotWorld()), robotStateStore(
+				robotWorld->getRobotStateStore()), state(
+				robotStateStore->allocate()), name(aName), size( DefaultSize), astar(
+				*robotWorld), acting(false), driving(false), communicating(false) {
+	state.setPosition(aPosition);
+	std::shared_ptr<AbstractSensor> laserSensor(new LaserDistanceSensor(this));
+	attachSensor(laserSensor);
+}
+
+/**
+ *
+ */
+Robot::Robot(const std::string& aName, const Point& aPosition,
+		RobotWorld& aRobotWorld) :
+		robotWorld(&aRobotWorld), robotStateStore(
+				aRobotWorld.getRobotStateStore()), state(
+				robotStateStore->allocate()), name(aName), size( DefaultSize), astar(
+				aRobotWorld), acting(false), driving(false), communicating(false) {
+	state.setPosition(aPosition);
 	std::shared_ptr<AbstractSensor> laserSensor(new LaserDistanceSensor(this));
 	attachSensor(laserSensor);
 }
@@ -54,6 +80,8 @@ Robot::Robot(const std::string& aName, const Point& aPosition) :
  *
  */
 Robot::~Robot() {
+	// A task of the behaviour may still use the robot, it must be over before anything is destroyed
+	stopBehaviour();
 	if (driving) {
 		stopDriving();
 	}
@@ -63,6 +91,7 @@ Robot::~Robot() {
 	if (communicating) {
 		stopCommunicating();
 	}
+	robotStateStore->release(state);
 }
 
 /**
@@ -70,9 +99,11 @@ Robot::~Robot() {
  */
 void Robot::setName(const std::string& aName,
 		bool aNotifyObservers /*= true*/) {
+	std::string oldName = name;
 	name = aName;
+	getRobotWorld().updateNameIndex(getObjectId(), oldName);
 	if (aNotifyObservers == true) {
-		notifyObservers();
+		notifyObservers(Base::ChangeEvent::Name);
 	}
 
 }
@@ -90,7 +121,7 @@ Size Robot::getSize() const {
 void Robot::setSize(const Size& aSize, bool aNotifyObservers /*= true*/) {
 	size = aSize;
 	if (aNotifyObservers == true) {
-		notifyObservers();
+		notifyObservers(Base::ChangeEvent::Size);
 	}
 }
 
@@ -99,9 +130,9 @@ void Robot::setSize(const Size& aSize, bool aNotifyObservers /*= true*/) {
  */
 void Robot::setPosition(const Point& aPosition,
 		bool aNotifyObservers /*= true*/) {
-	position = aPosition;
+	state.setPosition(aPosition);
 	if (aNotifyObservers == true) {
-		notifyObservers();
+		notifyObservers(Base::ChangeEvent::Position);
 	}
 }
 
@@ -109,7 +140,7 @@ void Robot::setPosition(const Point& aPosition,
  *
  */
 BoundedVector Robot::getFront() const {
-	return front;
+	return state.getFront();
 }
 
 /**
@@ -117,9 +148,9 @@ BoundedVector Robot::getFront() const {
  */
 void Robot::setFront(const BoundedVector& aVector,
 		bool aNotifyObservers /*= true*/) {
-	front = aVector;
+	state.setFront(aVector);
 	if (aNotifyObservers == true) {
-		notifyObservers();
+		notifyObservers(Base::ChangeEvent::Front);
 	}
 }
 
@@ -127,16 +158,16 @@ void Robot::setFront(const BoundedVector& aVector,
  *
  */
 float Robot::getSpeed() const {
-	return speed;
+	return state.getSpeed();
 }
 
 /**
  *
  */
 void Robot::setSpeed(float aNewSpeed, bool aNotifyObservers /*= true*/) {
-	speed = aNewSpeed;
+	state.setSpeed(aNewSpeed);
 	if (aNotifyObservers == true) {
-		notifyObservers();
+		notifyObservers(Base::ChangeEvent::Speed);
 	}
 }
 
@@ -145,8 +176,18 @@ void Robot::setSpeed(float aNewSpeed, bool aNotifyObservers /*= true*/) {
  */
 void Robot::startActing() {
 	acting = true;
-	std::thread newRobotThread([this] {startDriving();});
-	robotThread.swap(newRobotThread);
+	std::shared_ptr<std::promise<void> > started = std::make_shared<
+			std::promise<void> >();
+	actingStarted = started->get_future();
+	Base::WorkStealingPool::getWorkStealingPool().submit([this, started] {
+		try {
+			startDriving();
+			started->set_value();
+		} catch (...) {
+			started->set_exception(std::current_exception());
+			throw;
+		}
+	}, "robot");
 }
 
 /**
@@ -154,8 +195,11 @@ void Robot::startActing() {
  */
 void Robot::stopActing() {
 	acting = false;
-	driving = false;
-	robotThread.join();
+	if (actingStarted.valid()) {
+		// An exception of startDriving was already reported by the pool
+		actingStarted.wait();
+	}
+	stopDriving();
 }
 
 /**
@@ -164,10 +208,22 @@ void Robot::stopActing() {
 void Robot::startDriving() {
 	driving = true;
 
-	goal = RobotWorld::getRobotWorld().getGoal("Goal");
+	routeCalculations = 0;
+	collisions = 0;
+	planningTime = 0.0;
+
+	goal = getRobotWorld().getGoal("Goal");
 	calculateRoute(goal);
 
-	drive();
+	if (state.getSpeed() == 0.0) {
+		state.setSpeed(10.0);
+	}
+	cruiseSpeed = state.getSpeed();
+	state.setPathCursor(0);
+	moved = false;
+	driveState = DriveState::Driving;
+
+	startBehaviour(getRobotWorld().getSimulationClock());
 }
 
 /**
@@ -175,6 +231,19 @@ void Robot::startDriving() {
  */
 void Robot::stopDriving() {
 	driving = false;
+	stopBehaviour();
+	state.setMoving(false);
+}
+
+/**
+ *
+ */
+Behaviour::Await Robot::resume(unsigned long aTick) {
+	Base::TraceScope trace(Base::TraceEvent::RobotTick, aTick, getObjectId().hash());
+	if (!driving) {
+		return done();
+	}
+	return drive();
 }
 
 /**
@@ -185,13 +254,13 @@ void Robot::startCommunicating() {
 		communicating = true;
 
 		std::string localPort = "12345";
-		if (Application::MainApplication::isArgGiven("-local_port")) {
+		if (Application::CommandlineArguments::isArgGiven("-local_port")) {
 			localPort =
-					Application::MainApplication::getArg("-local_port").value;
+					Application::CommandlineArguments::getArg("-local_port").value;
 		}
 
-		if (Application::MainApplication::isArgGiven("-robot_type")) {
-			if (Application::MainApplication::getArg("-robot_type").value
+		if (Application::CommandlineArguments::isArgGiven("-robot_type")) {
+			if (Application::CommandlineArguments::getArg("-robot_type").value
 					== "client") {
 				localPort = "12346";
 			}
@@ -212,9 +281,9 @@ void Robot::stopCommunicating() {
 		communicating = false;
 
 		std::string localPort = "12345";
-		if (Application::MainApplication::isArgGiven("-local_port")) {
+		if (Application::CommandlineArguments::isArgGiven("-local_port")) {
 			localPort =
-					Application::MainApplication::getArg("-local_port").value;
+					Application::CommandlineArguments::getArg("-local_port").value;
 		}
 
 		Messaging::Client c1ient("localhost", localPort, toPtr<Robot>());
@@ -245,12 +314,13 @@ bool Robot::intersects(const Region& aRegion) const {
  *
  */
 Point Robot::getFrontLeft() const {
+	Point position = getPosition();
 	// x and y are pointing to top left now
 	int x = position.x - (size.x / 2);
 	int y = position.y - (size.y / 2);
 
 	Point originalFrontLeft(x, y);
-	double angle = Utils::Shape2DUtils::getAngle(front) + 0.5 * Utils::PI;
+	double angle = state.getHeading() + 0.5 * Utils::PI;
 
 	Point frontLeft(
 			(originalFrontLeft.x - position.x) * std::cos(angle)
@@ -267,12 +337,13 @@ Point Robot::getFrontLeft() const {
  *
  */
 Point Robot::getFrontRight() const {
+	Point position = getPosition();
 	// x and y are pointing to top left now
 	int x = position.x - (size.x / 2);
 	int y = position.y - (size.y / 2);
 
 	Point originalFrontRight(x + size.x, y);
-	double angle = Utils::Shape2DUtils::getAngle(front) + 0.5 * Utils::PI;
+	double angle = state.getHeading() + 0.5 * Utils::PI;
 
 	Point frontRight(
 			(originalFrontRight.x - position.x) * std::cos(angle)
@@ -289,13 +360,14 @@ Point Robot::getFrontRight() const {
  *
  */
 Point Robot::getBackLeft() const {
+	Point position = getPosition();
 	// x and y are pointing to top left now
 	int x = position.x - (size.x / 2);
 	int y = position.y - (size.y / 2);
 
 	Point originalBackLeft(x, y + size.y);
 
-	double angle = Utils::Shape2DUtils::getAngle(front) + 0.5 * Utils::PI;
+	double angle = state.getHeading() + 0.5 * Utils::PI;
 
 	Point backLeft(
 			(originalBackLeft.x - position.x) * std::cos(angle)
@@ -313,13 +385,14 @@ Point Robot::getBackLeft() const {
  *
  */
 Point Robot::getBackRight() const {
+	Point position = getPosition();
 	// x and y are pointing to top left now
 	int x = position.x - (size.x / 2);
 	int y = position.y - (size.y / 2);
 
 	Point originalBackRight(x + size.x, y + size.y);
 
-	double angle = Utils::Shape2DUtils::getAngle(front) + 0.5 * Utils::PI;
+	double angle = state.getHeading() + 0.5 * Utils::PI;
 
 	Point backRight(
 			(originalBackRight.x - position.x) * std::cos(angle)
@@ -336,12 +409,13 @@ Point Robot::getBackRight() const {
  *
  */
 Point Robot::getSafetyFrontLeft(unsigned short safetyMeasure) const {
+	Point position = getPosition();
 	// x and y are pointing to top left now
 	int x = position.x - (size.x / 2);
 	int y = position.y - (size.y / 2);
 
 	Point originalFrontLeft(x - 2, y - safetyMeasure);
-	double angle = Utils::Shape2DUtils::getAngle(front) + 0.5 * Utils::PI;
+	double angle = state.getHeading() + 0.5 * Utils::PI;
 
 	Point frontLeft(
 			(originalFrontLeft.x - position.x) * std::cos(angle)
@@ -358,12 +432,13 @@ Point Robot::getSafetyFrontLeft(unsigned short safetyMeasure) const {
  *
  */
 Point Robot::getSafetyFrontRight(unsigned short safetyMeasure) const {
+	Point position = getPosition();
 	// x and y are pointing to top left now
 	int x = position.x - (size.x / 2);
 	int y = position.y - (size.y / 2);
 
 	Point originalFrontRight(x + size.x + 2, y - safetyMeasure);
-	double angle = Utils::Shape2DUtils::getAngle(front) + 0.5 * Utils::PI;
+	double angle = state.getHeading() + 0.5 * Utils::PI;
 
 	Point frontRight(
 			(originalFrontRight.x - position.x) * std::cos(angle)
@@ -380,13 +455,14 @@ Point Robot::getSafetyFrontRight(unsigned short safetyMeasure) const {
  *
  */
 Point Robot::getSafetyBackLeft(unsigned short safetyMeasure) const {
+	Point position = getPosition();
 	// x and y are pointing to top left now
 	int x = position.x - (size.x / 2);
 	int y = position.y - (size.y / 2);
 
 	Point originalBackLeft(x - safetyMeasure, y + size.y + safetyMeasure);
 
-	double angle = Utils::Shape2DUtils::getAngle(front) + 0.5 * Utils::PI;
+	double angle = state.getHeading() + 0.5 * Utils::PI;
 
 	Point backLeft(
 			(originalBackLeft.x - position.x) * std::cos(angle)
@@ -404,6 +480,7 @@ Point Robot::getSafetyBackLeft(unsigned short safetyMeasure) const {
  *
  */
 Point Robot::getSafetyBackRight(unsigned short safetyMeasure) const {
+	Point position = getPosition();
 	// x and y are pointing to top left now
 	int x = position.x - (size.x / 2);
 	int y = position.y - (size.y / 2);
@@ -411,7 +488,7 @@ Point Robot::getSafetyBackRight(unsigned short safetyMeasure) const {
 	Point originalBackRight(x + size.x + safetyMeasure,
 			y + size.y + safetyMeasure);
 
-	double angle = Utils::Shape2DUtils::getAngle(front) + 0.5 * Utils::PI;
+	double angle = state.getHeading() + 0.5 * Utils::PI;
 
 	Point backRight(
 			(originalBackRight.x - position.x) * std::cos(angle)
@@ -430,9 +507,8 @@ Point Robot::getSafetyBackRight(unsigned short safetyMeasure) const {
 void Robot::handleNotification() {
 	//	std::unique_lock<std::recursive_mutex> lock(robotMutex);
 
-	static int update = 0;
-	if ((++update % 200) == 0) {
-		notifyObservers();
+	if ((++plannerNotifications % 200) == 0) {
+		notifyObservers(Base::ChangeEvent::Path);
 	}
 }
 
@@ -442,17 +518,14 @@ void Robot::handleNotification() {
 void Robot::handleRequest(Messaging::Message& aMessage) {
 	switch (aMessage.getMessageType()) {
 	case EchoRequest: {
-		Application::Logger::log(
-				__PRETTY_FUNCTION__ + std::string(": EchoRequest"));
+		LOG_DEBUG(__PRETTY_FUNCTION__ << ": EchoRequest");
 
 		aMessage.setMessageType(EchoResponse);
 		aMessage.setBody(": case 1 " + aMessage.asString());
 		break;
 	}
 	case RequestWorld: {
-		Application::Logger::log(
-				__PRETTY_FUNCTION__
-						+ std::string(": Ik ga dit request nu verwerken."));
+		LOG_DEBUG(__PRETTY_FUNCTION__ << ": Ik ga dit request nu verwerken.");
 
 		parseWorld(aMessage.getBody());
 
@@ -460,9 +533,9 @@ void Robot::handleRequest(Messaging::Message& aMessage) {
 		//TO COMPILE THIS WAS DELETED
 		aMessage.setBody(
 				getRobotData() + "&" + getGoalData() + "&"
-						+ RobotWorld::getRobotWorld().getWallData());
+						+ getRobotWorld().getWallData());
 		/*
-		 Model::RobotPtr robot = Model::RobotWorld::getRobotWorld().getRobot( "Robot");
+		 Model::RobotPtr robot = getRobotWorld().getRobot( "Robot");
 		 if (robot)
 		 {
 		 robot->sync(robot);
@@ -474,10 +547,8 @@ void Robot::handleRequest(Messaging::Message& aMessage) {
 	case SendRobotLocation: {
 		updateAlienRobot(aMessage.getBody());
 
-		Application::Logger::log(
-				__PRETTY_FUNCTION__
-						+ std::string(": De robot bevindt zich hier: .")
-						+ aMessage.asString());
+		LOG_DEBUG(
+				__PRETTY_FUNCTION__ << ": De robot bevindt zich hier: ." << aMessage.asString());
 
 		aMessage.setMessageType(SendRobotLocation);
 		aMessage.setBody("OK");
@@ -485,7 +556,7 @@ void Robot::handleRequest(Messaging::Message& aMessage) {
 	}
 
 	case SendStopMessage: {
-		Application::Logger::log("De andere robot stop nu ook .");
+		LOG_DEBUG("De andere robot stop nu ook .");
 		//driving = false;
 		recalc = true;
 		aMessage.setMessageType(SendStopMessage);
@@ -495,8 +566,7 @@ void Robot::handleRequest(Messaging::Message& aMessage) {
 		break;
 	}
 	default: {
-		Application::Logger::log(
-				__PRETTY_FUNCTION__ + std::string(": default"));
+		LOG_DEBUG(__PRETTY_FUNCTION__ << ": default");
 
 		aMessage.setBody(" default  Goodbye cruel world!");
 		break;
@@ -510,28 +580,21 @@ void Robot::handleRequest(Messaging::Message& aMessage) {
 void Robot::handleResponse(const Messaging::Message& aMessage) {
 	switch (aMessage.getMessageType()) {
 	case EchoResponse: {
-		Application::Logger::log(
-				__PRETTY_FUNCTION__
-						+ std::string(": case EchoResponse: not implemented, ")
-						+ aMessage.asString());
+		LOG_DEBUG(
+				__PRETTY_FUNCTION__ << ": case EchoResponse: not implemented, " << aMessage.asString());
 
 		break;
 	}
 
 	case RequestWorld: {
 		parseWorld(aMessage.getBody());
-		Application::Logger::log(
-				__PRETTY_FUNCTION__
-						+ std::string(
-								": De response is op dit adres aangekomen. ")
-						+ aMessage.getBody());
+		LOG_DEBUG(
+				__PRETTY_FUNCTION__ << ": De response is op dit adres aangekomen. " << aMessage.getBody());
 		break;
 	}
 	case SendRobotLocation: {
-		Application::Logger::log(
-				__PRETTY_FUNCTION__
-						+ std::string(": De robotdata is goed overgestuurd: ")
-						+ aMessage.getBody());
+		LOG_DEBUG(
+				__PRETTY_FUNCTION__ << ": De robotdata is goed overgestuurd: " << aMessage.getBody());
 		break;
 	}
 	case SendStopMessage: {
@@ -539,9 +602,8 @@ void Robot::handleResponse(const Messaging::Message& aMessage) {
 	}
 
 	default: {
-		Application::Logger::log(
-				__PRETTY_FUNCTION__ + std::string(": default not implemented, ")
-						+ aMessage.asString());
+		LOG_DEBUG(
+				__PRETTY_FUNCTION__ << ": default not implemented, " << aMessage.asString());
 		break;
 	}
 	}
@@ -553,7 +615,7 @@ void Robot::handleResponse(const Messaging::Message& aMessage) {
 std::string Robot::asString() const {
 	std::ostringstream os;
 
-	os << "Robot " << name << " at (" << position.x << "," << position.y << ")";
+	os << "Robot " << name << " at (" << getPosition().x << "," << getPosition().y << ")";
 
 	return os.str();
 }
@@ -566,7 +628,7 @@ std::string Robot::asDebugString() const {
 
 	os << "Robot:\n";
 	os << AbstractAgent::asDebugString();
-	os << "Robot " << name << " at (" << position.x << "," << position.y
+	os << "Robot " << name << " at (" << getPosition().x << "," << getPosition().y
 			<< ")\n";
 
 	return os.str();
@@ -575,81 +637,94 @@ std::string Robot::asDebugString() const {
 /**
  *
  */
-void Robot::drive() {
+Behaviour::Await Robot::drive() {
+	static Base::Histogram& driveTime = Base::Metrics::getMetrics().getHistogram("robotworld_robot_drive_seconds", "The time a robot takes for a tick of driving", 1e-6);
+	static Base::Counter& replans = Base::Metrics::getMetrics().getCounter("robotworld_robot_replans_total", "The times a robot stopped to plan its route again");
+	Base::ScopedTimer timer(driveTime);
 	try {
+		// The step decided in the previous tick has been made by the RobotStateStore
+		if (moved) {
+			moved = false;
+
+			bool hasArrived = arrived(goal);
+			bool hasCollided = !hasArrived && collision();
+			if (hasCollided) {
+				++collisions;
+			}
+			if (hasArrived || hasCollided) {
+				LOG_DEBUG(__PRETTY_FUNCTION__ << ": arrived or collision");
+
+				sendLocation();
+				notifyObservers(Base::ChangeEvent::Position | Base::ChangeEvent::Front);
+				stopDriving();
+				return done();
+			}
+
+			notifyObservers(Base::ChangeEvent::Position | Base::ChangeEvent::Front);
 
-		if (speed == 0.0) {
-			speed = 10.0;
+			sendLocation();
 		}
 
-		unsigned pathPoint = 0;
-		while (position.x > 0 && position.x < 500 && position.y > 0
-				&& position.y < 500 && pathPoint < path.size()) {
+		Point position = getPosition();
+		if (!(position.x > 0 && position.x < 500 && position.y > 0
+				&& position.y < 500 && state.getPathCursor() < path.size())) {
+			stopDriving();
+			return done();
+		}
 
+		if (driveState == DriveState::WaitingForRobot) {
+			driveState = DriveState::Driving;
+			state.setSpeed(cruiseSpeed);
+			recalc = false;
+			LOG_DEBUG("non-Triggered robot being handled");
+			notifyObservers(Base::ChangeEvent::Speed);
+		} else if (driveState == DriveState::Replanning) {
+			driveState = DriveState::Driving;
+			recalc = false;
+			state.setSpeed(cruiseSpeed);
+			state.setPathCursor(0);
+			LOG_DEBUG("Triggered robot being handled");
+			notifyObservers(Base::ChangeEvent::Speed | Base::ChangeEvent::Path);
+		} else {
 			if (robotCollision()) {
+				++collisions;
 				recalc = true;
 				sendStopMessage();
 
-				Application::Logger::log("Stop de robot");
+				LOG_DEBUG("Stop de robot");
 			}
 
 			if (recalc) {
-				Application::Logger::log("recalculating route");
-				speed = 0.0;
-				if (Application::MainApplication::isArgGiven("-robot_type")
-						&& Application::MainApplication::getArg("-robot_type").value
+				LOG_DEBUG("recalculating route");
+				replans.add();
+				state.setSpeed(0.0);
+				notifyObservers(Base::ChangeEvent::Speed);
+				if (Application::CommandlineArguments::isArgGiven("-robot_type")
+						&& Application::CommandlineArguments::getArg("-robot_type").value
 								== "client") {
-					recalcRoute();
-					recalc = false;
-					speed = 10.0;
-					pathPoint = 0;
-					Application::Logger::log("Triggered robot being handled");
-				} else {
-					std::this_thread::sleep_for(
-							std::chrono::milliseconds(3000));
-					speed = 10.0;
-					recalc = false;
-					Application::Logger::log(
-							"non-Triggered robot being handled");
+					// The robot stands still while the route is planned on the pool
+					driveState = DriveState::Replanning;
+					return runAsync([this] {recalcRoute();}, "plan");
 				}
-				notifyObservers();
-			}
-
-			if (!recalc) {
-				const PathAlgorithm::Vertex& vertex = path[pathPoint += speed];
-				front = BoundedVector(vertex.asPoint(), position);
-				position.x = vertex.x;
-				position.y = vertex.y;
-			}
-
-			if (arrived(goal) || collision()) {
-				Application::Logger::log(
-						__PRETTY_FUNCTION__
-								+ std::string(": arrived or collision"));
-
-				sendLocation();
-				notifyObservers();
-				break;
-			}
-
-			notifyObservers();
-
-			sendLocation();
-
-			std::this_thread::sleep_for(std::chrono::milliseconds(100));
-
-			// this should be the last thing in the loop
-			if (driving == false) {
-				return;
+				// The robot waits 3 seconds of simulated time for the other robot
+				driveState = DriveState::WaitingForRobot;
+				return waitTicks(std::max(1UL,
+						static_cast<unsigned long>(std::chrono::milliseconds(3000)
+								/ getRobotWorld().getSimulationClock().getTimeStep())));
 			}
+		}
 
-		} // while
-
+		if (!recalc) {
+			// The RobotStateStore moves all robots at once at the end of the tick
+			state.setMoving(true);
+			moved = true;
+		}
 	} catch (std::exception& e) {
 		std::cerr << __PRETTY_FUNCTION__ << ": " << e.what() << std::endl;
 	} catch (...) {
 		std::cerr << __PRETTY_FUNCTION__ << ": unknown exception" << std::endl;
 	}
+	return nextTick();
 }
 
 /**
@@ -657,19 +732,40 @@ void Robot::drive() {
  */
 void Robot::calculateRoute(GoalPtr aGoal) {
 	path.clear();
+	state.setPath(path);
+	publishPath();
 	if (aGoal) {
 		// Turn off logging if not debugging AStar
 		Application::Logger::setDisable();
 
-		front = BoundedVector(aGoal->getPosition(), position);
+		std::chrono::steady_clock::time_point start =
+				std::chrono::steady_clock::now();
+
+		state.setFront(BoundedVector(aGoal->getPosition(), getPosition()));
 		handleNotificationsFor(astar);
-		path = astar.search(position, aGoal->getPosition(), size);
+		path = astar.search(getPosition(), aGoal->getPosition(), size);
 		stopHandlingNotificationsFor(astar);
+		state.setPath(path);
+		publishPath();
+
+		++routeCalculations;
+		planningTime += std::chrono::duration<double, std::milli>(
+				std::chrono::steady_clock::now() - start).count();
 
 		Application::Logger::setDisable(false);
 	}
 }
 
+/**
+ *
+ */
+void Robot::publishPath() {
+	std::atomic_store(&pathView,
+			PathAlgorithm::VertexViewPtr(
+					std::make_shared<PathAlgorithm::VertexView>(++pathVersion,
+							path)));
+}
+
 /**
  *
  */
@@ -689,8 +785,8 @@ bool Robot::collision() {
 	Point backLeft = getBackLeft();
 	Point backRight = getBackRight();
 
-	const std::vector<WallPtr>& walls = RobotWorld::getRobotWorld().getWalls();
-	for (WallPtr wall : walls) {
+	RobotWorld::SnapshotPtr snapshot = getRobotWorld().getSnapshot();
+	for (const WallPtr& wall : snapshot->walls) {
 		if (Utils::Shape2DUtils::intersect(frontLeft, frontRight,
 				wall->getPoint1(), wall->getPoint2())
 				|| Utils::Shape2DUtils::intersect(frontLeft, backLeft,
@@ -704,9 +800,9 @@ bool Robot::collision() {
 }
 
 bool Robot::robotCollision() {
-	unsigned short safetyMeasure = 80;
-	RobotPtr robot = RobotWorld::getRobotWorld().getRobot("Robot");
-	RobotPtr robo2 = RobotWorld::getRobotWorld().getRobot("Robo2");
+	unsigned short safetyMeasure = safetyMargin;
+	RobotPtr robot = getRobotWorld().getRobot("Robot");
+	RobotPtr robo2 = getRobotWorld().getRobot("Robo2");
 	Point robotPoly[] = { robot->getSafetyFrontLeft(safetyMeasure),
 			robot->getSafetyFrontRight(safetyMeasure), robot->getFrontLeft(),
 			robot->getFrontRight() };
@@ -720,7 +816,7 @@ bool Robot::robotCollision() {
 						robo2->getBackLeft())
 				|| Utils::Shape2DUtils::isInsidePolygon(robotPoly, 4,
 						robo2->getBackRight())) {
-			Application::Logger::log(std::string("Robot detected to close"));
+			LOG_DEBUG("Robot detected to close");
 			return true;
 		}
 	}
@@ -729,15 +825,17 @@ bool Robot::robotCollision() {
 
 std::string Robot::getRobotData() const {
 	std::ostringstream os;
+	Point position = getPosition();
+	BoundedVector front = getFront();
 	os << std::to_string(position.x) << "," << std::to_string(position.y) << ","
 			<< std::to_string(front.x) << "," << std::to_string(front.y) << ","
-			<< std::to_string(speed);
+			<< std::to_string(getSpeed());
 	return os.str();
 }
 
 std::string Robot::getGoalData() const {
 	std::ostringstream os;
-	GoalPtr goal = RobotWorld::getRobotWorld().getGoal("Goal");
+	GoalPtr goal = getRobotWorld().getGoal("Goal");
 	if (goal != nullptr) {
 		os << std::to_string(goal->getPosition().x) << ","
 				<< std::to_string(goal->getPosition().y);
@@ -746,52 +844,72 @@ std::string Robot::getGoalData() const {
 }
 
 void Robot::sendLocation() {
-	Model::RobotPtr robot = Model::RobotWorld::getRobotWorld().getRobot(
-			"Robot");
-	std::string remoteIpAdres = "localhost";
-	std::string remotePort = "12346";
-
-	if (Application::MainApplication::isArgGiven("-robot_type")) {
-		if (Application::MainApplication::getArg("-robot_type").value
-				== "client") {
-			remotePort = "12345";
-		}
-	}
-	if (Application::MainApplication::isArgGiven("-remote_ip")) {
-		remoteIpAdres =
-				Application::MainApplication::getArg("-remote_ip").value;
+	// Nobody would ever handle the message without a running communication service
+	if (!Messaging::CommunicationService::getCommunicationService().isRunning()) {
+		return;
 	}
-
-	// We will request an echo message. The response will be "Hello World", if all goes OK,
-	// "Goodbye cruel world!" if something went wrong.
-	Messaging::Client c1ient(remoteIpAdres, remotePort, robot);
 	Messaging::Message message(Model::Robot::MessageType::SendRobotLocation,
 			getRobotData());
-	c1ient.dispatchMessage(message);
+	sendAsync(message);
 }
 
 void Robot::sendStopMessage() {
-	Model::RobotPtr robot = Model::RobotWorld::getRobotWorld().getRobot(
+	// Nobody would ever handle the message without a running communication service
+	if (!Messaging::CommunicationService::getCommunicationService().isRunning()) {
+		return;
+	}
+	Messaging::Message message(Model::Robot::MessageType::SendStopMessage);
+	sendAsync(message);
+}
+
+void Robot::sendAsync(const Messaging::Message& aMessage) {
+	{
+		std::lock_guard<std::mutex> lock(outgoingMutex);
+		outgoing.push_back(aMessage);
+		if (sending) {
+			// sendNext takes it when the exchange in progress is over
+			return;
+		}
+		sending = true;
+	}
+	sendNext();
+}
+
+void Robot::sendNext() {
+	std::unique_lock<std::mutex> lock(outgoingMutex);
+	if (outgoing.empty()) {
+		sending = false;
+		return;
+	}
+	Messaging::Message message(outgoing.front());
+	outgoing.pop_front();
+	lock.unlock();
+
+	Model::RobotPtr robot = getRobotWorld().getRobot(
 			"Robot");
 	std::string remoteIpAdres = "localhost";
 	std::string remotePort = "12346";
 
-	if (Application::MainApplication::isArgGiven("-robot_type")) {
-		if (Application::MainApplication::getArg("-robot_type").value
+	if (Application::CommandlineArguments::isArgGiven("-robot_type")) {
+		if (Application::CommandlineArguments::getArg("-robot_type").value
 				== "client") {
 			remotePort = "12345";
 		}
 	}
-	if (Application::MainApplication::isArgGiven("-remote_ip")) {
+	if (Application::CommandlineArguments::isArgGiven("-remote_ip")) {
 		remoteIpAdres =
-				Application::MainApplication::getArg("-remote_ip").value;
+				Application::CommandlineArguments::getArg("-remote_ip").value;
 	}
 
-	// We will request an echo message. The response will be "Hello World", if all goes OK,
-	// "Goodbye cruel world!" if something went wrong.
-	Messaging::Client c1ient(remoteIpAdres, remotePort, robot);
-	Messaging::Message message(Model::Robot::MessageType::SendStopMessage);
-	c1ient.dispatchMessage(message);
+	// The next message goes when this exchange is over, whether it got its response or failed,
+	// so the other robot handles the messages in the order they were sent
+	RobotPtr sender = toPtr<Robot>();
+	Base::WorkStealingPool::getWorkStealingPool().submit(
+			[robot, sender, remoteIpAdres, remotePort, message]() {
+				Messaging::Client c1ient(remoteIpAdres, remotePort, robot);
+				Messaging::Message toSend(message);
+				c1ient.dispatchMessage(toSend, [sender] {sender->sendNext();});
+			}, "send");
 }
 
 void Robot::recalcRoute() {
@@ -799,31 +917,39 @@ void Robot::recalcRoute() {
 
 	Application::Logger::log("Recalc function");
 
-	RobotPtr robo2 = RobotWorld::getRobotWorld().getRobot("Robo2");
-
-	tempWalls.push_back(
-			RobotWorld::getRobotWorld().newWall(robo2->getFrontLeft(),
-					robo2->getFrontRight(), false));
-	tempWalls.push_back(
-			RobotWorld::getRobotWorld().newWall(robo2->getFrontRight(),
-					robo2->getBackRight(), false));
-	tempWalls.push_back(
-			RobotWorld::getRobotWorld().newWall(robo2->getBackRight(),
-					robo2->getBackLeft(), false));
-	tempWalls.push_back(
-			RobotWorld::getRobotWorld().newWall(robo2->getBackLeft(),
-					robo2->getFrontLeft(), false));
+	RobotPtr robo2 = getRobotWorld().getRobot("Robo2");
+
+	// The batches only cover the changes to the world: the planner reads the published walls and
+	// the world must not stay in a batch while the route is calculated
+	{
+		RobotWorld::Batch batch(getRobotWorld());
+		tempWalls.push_back(
+				getRobotWorld().newWall(robo2->getFrontLeft(),
+						robo2->getFrontRight(), false));
+		tempWalls.push_back(
+				getRobotWorld().newWall(robo2->getFrontRight(),
+						robo2->getBackRight(), false));
+		tempWalls.push_back(
+				getRobotWorld().newWall(robo2->getBackRight(),
+						robo2->getBackLeft(), false));
+		tempWalls.push_back(
+				getRobotWorld().newWall(robo2->getBackLeft(),
+						robo2->getFrontLeft(), false));
+	}
 
 	//Recalc route
-	goal = RobotWorld::getRobotWorld().getGoal("Goal");
+	goal = getRobotWorld().getGoal("Goal");
 	calculateRoute(goal);
 
 	Application::Logger::log("Start driving has been called");
 
 	//remove walls
-	while (!tempWalls.empty()) {
-		RobotWorld::getRobotWorld().deleteWall(tempWalls.at(0));
-		tempWalls.erase(tempWalls.begin());
+	{
+		RobotWorld::Batch batch(getRobotWorld());
+		while (!tempWalls.empty()) {
+			getRobotWorld().deleteWall(tempWalls.at(0));
+			tempWalls.erase(tempWalls.begin());
+		}
 	}
 
 	Application::Logger::log("End of recalc");
@@ -834,12 +960,14 @@ void Robot::parseWorld(const std::string& message) {
 
 	data = tokeniseString(message, '&');
 
+	// One notification by the world for the whole alien world
+	RobotWorld::Batch batch(getRobotWorld());
 	createAlienRobot(data.at(0));
 	createAlienGoal(data.at(1));
 	createAlienWalls(data.at(2));
 
 	//Once everyone is added it's time to update the view
-	notifyObservers();
+	notifyObservers(Base::ChangeEvent::Other);
 }
 
 void Robot::createAlienRobot(const std::string& message) {
@@ -847,8 +975,8 @@ void Robot::createAlienRobot(const std::string& message) {
 
 	data = tokeniseString(message, ',');
 
-	if (RobotWorld::getRobotWorld().getRobot("Robo2") == nullptr) {
-		RobotWorld::getRobotWorld().newRobot("Robo2",
+	if (getRobotWorld().getRobot("Robo2") == nullptr) {
+		getRobotWorld().newRobot("Robo2",
 				Point(stoi(data.at(0)), stoi(data.at(1))), false);
 		Application::Logger::log("Make alien robot");
 	} else {
@@ -865,7 +993,7 @@ void Robot::createAlienWalls(const std::string& message) {
 		std::vector<std::string> walls;
 
 		walls = tokeniseString(d, ',');
-		RobotWorld::getRobotWorld().newWall(
+		getRobotWorld().newWall(
 				Point(stoi(walls.at(0)), stoi(walls.at(1))),
 				Point(stoi(walls.at(2)), stoi(walls.at(3))), false);
 	}
@@ -874,8 +1002,8 @@ void Robot::createAlienWalls(const std::string& message) {
 void Robot::createAlienGoal(const std::string& message) {
 	std::vector<std::string> data = tokeniseString(message, ',');
 
-	if (RobotWorld::getRobotWorld().getGoal("Goa2") == nullptr) {
-		RobotWorld::getRobotWorld().newGoal("Goa2",
+	if (getRobotWorld().getGoal("Goa2") == nullptr) {
+		getRobotWorld().newGoal("Goa2",
 				Point(stoi(data.at(0)), stoi(data.at(1))), false);
 	} else {
 		Application::Logger::log("Goal already exists");
@@ -885,15 +1013,16 @@ void Robot::createAlienGoal(const std::string& message) {
 void Robot::updateAlienRobot(const std::string& message) {
 	std::vector<std::string> data = tokeniseString(message, ',');
 
-	RobotPtr alien = RobotWorld::getRobotWorld().getRobot("Robo2");
+	RobotPtr alien = getRobotWorld().getRobot("Robo2");
 
 	if (alien) {
 		alien->setPosition(Point(stoi(data.at(0)), stoi(data.at(1))), true);
 		alien->setFront(BoundedVector(stof(data.at(2)), stof(data.at(3))),
 				true);
+		getRobotWorld().notifyMoved(alien->getObjectId(), false);
 	}
 
-	notifyObservers();
+	notifyObservers(Base::ChangeEvent::Other);
 }
 
 std::vector<std::string> Robot::tokeniseString(const std::string& message,
@@ -913,12 +1042,12 @@ void Robot::sync(Model::RobotPtr robot) {
 	std::string remoteIpAdres = "localhost";
 	std::string remotePort = "12346";
 
-	if (Application::MainApplication::isArgGiven("-robot_type")) {
+	if (Application::CommandlineArguments::isArgGiven("-robot_type")) {
 		remotePort = "12345";
 	}
-	if (Application::MainApplication::isArgGiven("-remote_ip")) {
+	if (Application::CommandlineArguments::isArgGiven("-remote_ip")) {
 		remoteIpAdres =
-				Application::MainApplication::getArg("-remote_ip").value;
+				Application::CommandlineArguments::getArg("-remote_ip").value;
 	}
 
 	Messaging::Client c1ient(remoteIpAdres, remotePort, robot);
@@ -928,7 +1057,7 @@ void Robot::sync(Model::RobotPtr robot) {
 	//TO COMPILE THIS WAS DELETED
 	message.setBody(
 			getRobotData() + "&" + getGoalData() + "&"
-					+ RobotWorld::getRobotWorld().getWallData());
+					+ getRobotWorld().getWallData());
 	message.setMessageType(RequestWorld);
 	c1ient.dispatchMessage(message);
 }
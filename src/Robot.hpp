@@ -3,6 +3,9 @@
 
 #include "Config.hpp"
 
+#include <atomic>
+#include <deque>
+#include <future>
 #include <iostream>
 #include <memory>
 #include <mutex>
@@ -11,6 +14,7 @@
 
 #include "AbstractAgent.hpp"
 #include "AStar.hpp"
+#include "Behaviour.hpp"
 #include "BoundedVector.hpp"
 #include "Message.hpp"
 #include "MessageHandler.hpp"
@@ -18,6 +22,8 @@
 #include "Point.hpp"
 #include "Size.hpp"
 #include "Region.hpp"
+#include "RobotStateStore.hpp"
+#include "SimulationClock.hpp"
 
 namespace Messaging
 {
@@ -32,9 +38,12 @@ namespace Model
 	class Goal;
 	typedef std::shared_ptr<Goal> GoalPtr;
 
+	class RobotWorld;
+
 	class Robot :	public AbstractAgent,
 					public Messaging::MessageHandler,
-					public Base::Observer
+					public Base::Observer,
+					public Behaviour
 	{
 		public:
 			/**
@@ -50,10 +59,23 @@ namespace Model
 			 */
 			Robot(	const std::string& aName,
 					const Point& aPosition);
+			/**
+			 * The other constructors put the robot in the default RobotWorld
+			 */
+			Robot(	const std::string& aName,
+					const Point& aPosition,
+					RobotWorld& aRobotWorld);
 			/**
 			 *
 			 */
 			virtual ~Robot();
+			/**
+			 *
+			 */
+			RobotWorld& getRobotWorld() const
+			{
+				return *robotWorld;
+			}
 			/**
 			 *
 			 */
@@ -80,7 +102,7 @@ namespace Model
 			 */
 			Point getPosition() const
 			{
-				return position;
+				return state.getPosition();
 			}
 			/**
 			 *
@@ -105,6 +127,21 @@ namespace Model
 			 */
 			void setSpeed( float aNewSpeed,
 						   bool aNotifyObservers = true);
+			/**
+			 *
+			 * @return the distance to another robot at which the robot stops or replans
+			 */
+			unsigned short getSafetyMargin() const
+			{
+				return safetyMargin;
+			}
+			/**
+			 *
+			 */
+			void setSafetyMargin( unsigned short aSafetyMargin)
+			{
+				safetyMargin = aSafetyMargin;
+			}
 			/**
 			 *
 			 * @return true if the robot is acting, i.e. either planning or driving
@@ -114,11 +151,11 @@ namespace Model
 				return acting;
 			}
 			/**
-			 *
+			 * Plans the route and starts driving in a task on the shared WorkStealingPool
 			 */
 			virtual void startActing();
 			/**
-			 *
+			 * Waits for the planning started by startActing and stops driving
 			 */
 			virtual void stopActing();
 			/**
@@ -208,6 +245,15 @@ namespace Model
 			 */
 			virtual void handleNotification();
 			//@}
+			/**
+			 * @name Behaviour functions
+			 */
+			//@{
+			/**
+			 * Drives one step along the path
+			 */
+			virtual Await resume( unsigned long aTick);
+			//@}
 			/**
 			 *
 			 */
@@ -222,6 +268,49 @@ namespace Model
 			{
 				return path;
 			}
+			/**
+			 * The open set of the planner without copying it, for the renderer
+			 */
+			PathAlgorithm::VertexViewPtr getOpenSetView() const
+			{
+				return astar.getOpenSetView();
+			}
+			/**
+			 * The path without copying it, for the renderer. A new version is published whenever the route is calculated.
+			 */
+			PathAlgorithm::VertexViewPtr getPathView() const
+			{
+				return std::atomic_load( &pathView);
+			}
+			/**
+			 * @name Statistics of the current or last drive
+			 */
+			//@{
+			/**
+			 *
+			 * @return the number of times the robot hit a wall or came within the safety margin of another robot
+			 */
+			unsigned long getCollisions() const
+			{
+				return collisions;
+			}
+			/**
+			 *
+			 * @return the number of routes calculated after the first one
+			 */
+			unsigned long getReplans() const
+			{
+				return routeCalculations > 0 ? routeCalculations - 1 : 0;
+			}
+			/**
+			 *
+			 * @return the wall-clock time spent calculating routes in milliseconds
+			 */
+			double getPlanningTime() const
+			{
+				return planningTime;
+			}
+			//@}
 			/**
 			 * @name Messaging::MessageHandler functions
 			 */
@@ -281,6 +370,17 @@ namespace Model
 			 *
 			 */
 			void sendStopMessage();
+			/**
+			 * Queues aMessage for the other robot. The messages of a robot are sent one at a time, in the
+			 * order they were queued, so a stop never overtakes a location and an old location never a new one.
+			 */
+			void sendAsync( const Messaging::Message& aMessage);
+			/**
+			 * Dispatches the oldest queued message in a task on the shared WorkStealingPool, so resolving
+			 * the address and connecting do not hold up the tick. The exchange calls sendNext again when
+			 * it is over.
+			 */
+			void sendNext();
 			/**
 			 *
 			 */
@@ -303,13 +403,19 @@ namespace Model
 
 		protected:
 			/**
+			 * One step along the path, called once per tick of the SimulationClock
 			 *
+			 * @return what the robot waits for before the next step
 			 */
-			void drive();
+			Await drive();
 			/**
 			 *
 			 */
 			void calculateRoute(GoalPtr aGoal);
+			/**
+			 * Publishes a copy of the path as a new version of the path view
+			 */
+			void publishPath();
 			/**
 			 *
 			 */
@@ -350,25 +456,71 @@ namespace Model
 			 */
 			std::vector<std::string> tokeniseString (const std::string& message, char seperator);
 
+			RobotWorld* robotWorld;
+			/**
+			 * The position, front, speed and path cursor of the robot live in the store of its world
+			 */
+			std::shared_ptr< RobotStateStore > robotStateStore;
+			RobotState state;
+
 			std::string name;
 
 			Size size;
-			Point position;
-
-			BoundedVector front;
-			float speed;
+			/**
+			 * The speed the robot resumes after it stopped for another robot
+			 */
+			float cruiseSpeed = 10.0;
+			unsigned short safetyMargin = 80;
 
 			GoalPtr goal;
 			PathAlgorithm::AStar astar;
 			PathAlgorithm::Path path;
+			/**
+			 * Only accessed with std::atomic_load and std::atomic_store
+			 */
+			PathAlgorithm::VertexViewPtr pathView;
+			unsigned long pathVersion = 0;
 
-			bool acting;
-			bool driving;
+			/**
+			 * Set by the GUI and by the tasks of the pool
+			 */
+			std::atomic< bool > acting;
+			std::atomic< bool > driving;
 			bool communicating;
 			bool recalc = false;
+			/**
+			 * What drive() resumes from
+			 */
+			enum class DriveState
+			{
+				Driving, WaitingForRobot, Replanning
+			};
+			DriveState driveState = DriveState::Driving;
+			/**
+			 * True if drive() has let the RobotStateStore move the robot at the end of the previous tick
+			 */
+			bool moved = false;
+			/**
+			 * Only every 200th notification of the planner is passed on to the observers
+			 */
+			unsigned long plannerNotifications = 0;
+
+			unsigned long routeCalculations = 0;
+			unsigned long collisions = 0;
+			double planningTime = 0.0;
 
-			std::thread robotThread;
+			/**
+			 * Ready when the task submitted by startActing is done
+			 */
+			std::future< void > actingStarted;
 			mutable std::recursive_mutex robotMutex;
+
+			/**
+			 * The messages for the other robot that wait for the exchange in progress, if sending
+			 */
+			std::deque< Messaging::Message > outgoing;
+			bool sending = false;
+			std::mutex outgoingMutex;
 	};
 } // namespace Model
 #endif // ROBOT_HPP_
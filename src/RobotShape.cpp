@@ -1,4 +1,5 @@
 #include "RobotShape.hpp"
+#include <algorithm>
 #include <cmath>
 #include "Notifier.hpp"
 #include "Robot.hpp"
@@ -10,6 +11,28 @@
 
 namespace View
 {
+	namespace
+	{
+		/**
+		 * The smallest rectangle that contains someVertices, which must not be empty
+		 */
+		Rect boundingBoxOf( const std::vector< PathAlgorithm::Vertex >& someVertices)
+		{
+			int left = someVertices.front().x;
+			int top = someVertices.front().y;
+			int right = left;
+			int bottom = top;
+			for (const PathAlgorithm::Vertex& vertex : someVertices)
+			{
+				left = std::min( left, vertex.x);
+				top = std::min( top, vertex.y);
+				right = std::max( right, vertex.x);
+				bottom = std::max( bottom, vertex.y);
+			}
+			return Rect( Point( left, top), Point( right, bottom));
+		}
+	} // namespace
+
 	/**
 	 *
 	 */
@@ -42,7 +65,7 @@ namespace View
 	 */
 	void RobotShape::handleActivated()
 	{
-		Model::GoalPtr goal = Model::RobotWorld::getRobotWorld().getGoal( "Goal");
+		Model::GoalPtr goal = getRobot()->getRobotWorld().getGoal( "Goal");
 		if (goal)
 		{
 			Point goalPosition = goal->getPosition();
@@ -68,8 +91,8 @@ namespace View
 	 */
 	void RobotShape::handleNotification()
 	{
-		setCentre( getRobot()->getPosition());
-		robotWorldCanvas->handleNotification();
+		// Called on the thread of the robot: the canvas moves the shape when it gets the
+		// ChangeEvent of the robot from the EventBus on the main thread
 	}
 	/**
 	 *
@@ -91,23 +114,39 @@ namespace View
 			getRobot()->setSize( size, false);
 		}
 
-		PathAlgorithm::OpenSet openSet = getRobot()->getOpenSet();
-		if (openSet.size() != 0)
+		// The views are shared with the planner, they are only converted when a new version is published
+		PathAlgorithm::VertexViewPtr openSetView = getRobot()->getOpenSetView();
+		if (openSetView && !openSetView->vertices.empty())
 		{
-			dc.SetPen( wxPen( WXSTRING( "PALE GREEN"), borderWidth, wxSOLID));
-			for (const PathAlgorithm::Vertex& vertex : openSet)
+			if (openSetView->version != openSetVersion)
 			{
-				dc.DrawPoint( vertex.asPoint());
+				rasteriseOpenSet( *openSetView);
 			}
+			dc.DrawBitmap( openSetBitmap, openSetOrigin, true);
 		}
 
-		PathAlgorithm::Path path = getRobot()->getPath();
-		if (path.size() != 0)
+		PathAlgorithm::VertexViewPtr pathView = getRobot()->getPathView();
+		if (pathView && !pathView->vertices.empty())
 		{
+			if (pathView->version != pathVersion)
+			{
+				pathPoints.clear();
+				pathPoints.reserve( pathView->vertices.size());
+				for (const PathAlgorithm::Vertex& vertex : pathView->vertices)
+				{
+					pathPoints.push_back( vertex.asPoint());
+				}
+				pathVersion = pathView->version;
+			}
+
+			// The vertices of a path are neighbours, so one polyline draws the same as a point per vertex
 			dc.SetPen( wxPen( WXSTRING( "BLACK"), borderWidth, wxSOLID));
-			for (const PathAlgorithm::Vertex& vertex : path)
+			if (pathPoints.size() == 1)
 			{
-				dc.DrawPoint( vertex.asPoint());
+				dc.DrawPoint( pathPoints.front());
+			} else
+			{
+				dc.DrawLines( static_cast< int >(pathPoints.size()), pathPoints.data());
 			}
 		}
 
@@ -142,6 +181,32 @@ namespace View
 		// with the front of the robot, while text centre being displayed in the
 		// centre of the robot, bottom of the text to the back of the robot.
 		dc.DrawRotatedText( WXSTRING( title), centre.x - titleSize.x / 2, centre.y - titleSize.y / 2, angle - Utils::PI);
+
+		drawnBodyBoundingBox = getBodyBoundingBox();
+	}
+	/**
+	 *
+	 */
+	void RobotShape::drawSimplified( wxDC& dc)
+	{
+		// A dot of a few pixels, whatever the scale
+		double scaleX;
+		double scaleY;
+		dc.GetUserScale( &scaleX, &scaleY);
+		int radius = std::max( 1, static_cast< int >(2 / scaleX));
+
+		if (isSelected())
+		{
+			dc.SetPen( wxPen( WXSTRING( getSelectionColour()), 1, wxSOLID));
+			dc.SetBrush( wxBrush( WXSTRING( getSelectionColour())));
+		} else
+		{
+			dc.SetPen( wxPen( WXSTRING( getNormalColour()), 1, wxSOLID));
+			dc.SetBrush( wxBrush( WXSTRING( getNormalColour())));
+		}
+		dc.DrawCircle( centre, radius);
+
+		drawnBodyBoundingBox = getBodyBoundingBox().Union( Rect( centre.x - radius, centre.y - radius, 2 * radius + 1, 2 * radius + 1));
 	}
 	/**
 	 *
@@ -151,6 +216,80 @@ namespace View
 		Point cornerPoints[] = { getRobot()->getFrontRight(), getRobot()->getFrontLeft(), getRobot()->getBackLeft(), getRobot()->getBackRight() };
 		return Utils::Shape2DUtils::isInsidePolygon( cornerPoints, 4, aPoint);
 	}
+	/**
+	 *
+	 */
+	void RobotShape::rasteriseOpenSet( const PathAlgorithm::VertexView& anOpenSetView)
+	{
+		Rect extents = boundingBoxOf( anOpenSetView.vertices);
+		openSetOrigin = Point( extents.x - borderWidth, extents.y - borderWidth);
+
+		// White is the transparent background of the bitmap
+		Bitmap bitmap( extents.width + 2 * borderWidth, extents.height + 2 * borderWidth);
+		{
+			MemoryDC dc( bitmap);
+			dc.SetBackground( *wxWHITE_BRUSH);
+			dc.Clear();
+			dc.SetPen( wxPen( WXSTRING( "PALE GREEN"), borderWidth, wxSOLID));
+			for (const PathAlgorithm::Vertex& vertex : anOpenSetView.vertices)
+			{
+				dc.DrawPoint( vertex.x - openSetOrigin.x, vertex.y - openSetOrigin.y);
+			}
+		}
+		bitmap.SetMask( new wxMask( bitmap, *wxWHITE));
+
+		openSetBitmap = bitmap;
+		openSetVersion = anOpenSetView.version;
+	}
+	/**
+	 *
+	 */
+	Rect RobotShape::getBoundingBox() const
+	{
+		Rect boundingBox = getBodyBoundingBox();
+
+		PathAlgorithm::VertexViewPtr pathView = getRobot()->getPathView();
+		if (pathView && !pathView->vertices.empty())
+		{
+			if (pathView->version != pathBoundingBoxVersion)
+			{
+				pathBoundingBox = boundingBoxOf( pathView->vertices).Inflate( borderWidth);
+				pathBoundingBoxVersion = pathView->version;
+			}
+			boundingBox.Union( pathBoundingBox);
+		}
+
+		PathAlgorithm::VertexViewPtr openSetView = getRobot()->getOpenSetView();
+		if (openSetView && !openSetView->vertices.empty())
+		{
+			if (openSetView->version != openSetBoundingBoxVersion)
+			{
+				openSetBoundingBox = boundingBoxOf( openSetView->vertices).Inflate( borderWidth);
+				openSetBoundingBoxVersion = openSetView->version;
+			}
+			boundingBox.Union( openSetBoundingBox);
+		}
+
+		return boundingBox;
+	}
+	/**
+	 *
+	 */
+	Rect RobotShape::getBodyBoundingBox() const
+	{
+		Point cornerPoints[] = { getRobot()->getFrontRight(), getRobot()->getFrontLeft(), getRobot()->getBackLeft(), getRobot()->getBackRight() };
+		Rect boundingBox( cornerPoints[0], cornerPoints[0]);
+		for (const Point& cornerPoint : cornerPoints)
+		{
+			boundingBox.Union( Rect( cornerPoint, cornerPoint));
+		}
+
+		// The front line is 25 pixels long. The title rotates around its top left corner which is half a
+		// diagonal from the centre, so it stays within one and a half diagonal of the centre.
+		int radius = std::max( 25, 3 * (titleSize.x + titleSize.y) / 2);
+		boundingBox.Union( Rect( centre.x - radius, centre.y - radius, 2 * radius, 2 * radius));
+		return boundingBox.Inflate( borderWidth + 1);
+	}
 	/**
 	 *
 	 */
@@ -4,6 +4,7 @@
 #include "Config.hpp"
 
 #include <string>
+#include <vector>
 
 #include "RectangleShape.hpp"
 #include "Robot.hpp"
@@ -97,7 +98,27 @@ namespace View
 			 *
 			 */
 			virtual void setCentre( const Point& aPoint);
+			/**
+			 * The body of the robot together with its path and open set
+			 */
+			virtual Rect getBoundingBox() const;
 			//@}
+			/**
+			 * Draws the robot as a dot
+			 */
+			virtual void drawSimplified( wxDC& dc);
+			/**
+			 * The rectangle the robot covers when drawn now: its body, front line and (rotated) title.
+			 * The path and the open set are not included, they only change with a full refresh.
+			 */
+			Rect getBodyBoundingBox() const;
+			/**
+			 * The body bounding box at the previous draw, i.e. what must be redrawn to erase the robot
+			 */
+			Rect getDrawnBodyBoundingBox() const
+			{
+				return drawnBodyBoundingBox;
+			}
 			/**
 			 * @name Debug functions
 			 */
@@ -117,9 +138,33 @@ namespace View
 				robotWorldCanvas = aRobotWorldCanvas;
 			}
 		protected:
+			/**
+			 * Draws the open set once into openSetBitmap, which is then drawn with a single call
+			 * until the planner publishes a new version
+			 */
+			void rasteriseOpenSet( const PathAlgorithm::VertexView& anOpenSetView);
 
 		private:
 			RobotWorldCanvas* robotWorldCanvas;
+			Rect drawnBodyBoundingBox;
+			/**
+			 * The open set of openSetVersion, with white as transparent background
+			 */
+			Bitmap openSetBitmap;
+			Point openSetOrigin;
+			unsigned long openSetVersion = 0;
+			/**
+			 * The path of pathVersion as points for a single DrawLines
+			 */
+			std::vector< Point > pathPoints;
+			unsigned long pathVersion = 0;
+			/**
+			 * The extents of the path and the open set, cached per version by getBoundingBox
+			 */
+			mutable Rect pathBoundingBox;
+			mutable unsigned long pathBoundingBoxVersion = 0;
+			mutable Rect openSetBoundingBox;
+			mutable unsigned long openSetBoundingBoxVersion = 0;
 	};
 } // namespace View
 #endif // ROBOTSHAPE_HPP_
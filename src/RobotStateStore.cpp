@@ -0,0 +1,145 @@
+#include "RobotStateStore.hpp"
+#include <algorithm>
+#include <sstream>
+#include "Shape2DUtils.hpp"
+
+namespace Model
+{
+	/**
+	 *
+	 */
+	void RobotState::setFront( const BoundedVector& aFront)
+	{
+		block->frontX[lane] = aFront.x;
+		block->frontY[lane] = aFront.y;
+		block->heading[lane] = Utils::Shape2DUtils::getAngle( aFront);
+	}
+	/**
+	 *
+	 */
+	RobotStateStore::RobotStateStore()
+	{
+	}
+	/**
+	 *
+	 */
+	RobotStateStore::~RobotStateStore()
+	{
+	}
+	/**
+	 *
+	 */
+	RobotState RobotStateStore::allocate()
+	{
+		std::lock_guard< std::mutex > lock( storeMutex);
+
+		if (freeStates.empty())
+		{
+			blocks.push_back( std::unique_ptr< RobotStateBlock >( new RobotStateBlock()));
+			// Backwards, so that the first lane is handed out first
+			for (std::size_t lane = RobotStateBlock::BlockSize; lane > 0; --lane)
+			{
+				freeStates.push_back( RobotState( blocks.back().get(), lane - 1));
+			}
+		}
+		RobotState robotState = freeStates.back();
+		freeStates.pop_back();
+
+		RobotStateBlock& block = *robotState.block;
+		std::size_t lane = robotState.lane;
+		block.x[lane] = 0;
+		block.y[lane] = 0;
+		block.frontX[lane] = 0.0;
+		block.frontY[lane] = 0.0;
+		block.heading[lane] = 0.0;
+		block.speed[lane] = 0.0;
+		block.pathCursor[lane] = 0;
+		block.path[lane] = nullptr;
+		block.pathLength[lane] = 0;
+		block.moving[lane] = 0;
+		block.used[lane] = 1;
+		return robotState;
+	}
+	/**
+	 *
+	 */
+	void RobotStateStore::release( RobotState& aRobotState)
+	{
+		if (!aRobotState.isValid())
+		{
+			return;
+		}
+
+		std::lock_guard< std::mutex > lock( storeMutex);
+		aRobotState.block->used[aRobotState.lane] = 0;
+		aRobotState.block->moving[aRobotState.lane] = 0;
+		aRobotState.block->path[aRobotState.lane] = nullptr;
+		freeStates.push_back( aRobotState);
+		aRobotState = RobotState();
+	}
+	/**
+	 *
+	 */
+	void RobotStateStore::advance()
+	{
+		std::lock_guard< std::mutex > lock( storeMutex);
+
+		for (const std::unique_ptr< RobotStateBlock >& blockPtr : blocks)
+		{
+			RobotStateBlock& block = *blockPtr;
+
+			// Branch free, so this loop vectorises
+			for (std::size_t lane = 0; lane < RobotStateBlock::BlockSize; ++lane)
+			{
+				block.pathCursor[lane] += block.moving[lane] * static_cast< unsigned long >(block.speed[lane]);
+			}
+
+			for (std::size_t lane = 0; lane < RobotStateBlock::BlockSize; ++lane)
+			{
+				if (!block.moving[lane])
+				{
+					continue;
+				}
+				block.moving[lane] = 0;
+				if (block.pathLength[lane] == 0)
+				{
+					continue;
+				}
+
+				const PathAlgorithm::Vertex& vertex = block.path[lane][std::min( block.pathCursor[lane], block.pathLength[lane] - 1)];
+				BoundedVector front( static_cast< float >(vertex.x - block.x[lane]), static_cast< float >(vertex.y - block.y[lane]));
+				block.frontX[lane] = front.x;
+				block.frontY[lane] = front.y;
+				block.heading[lane] = Utils::Shape2DUtils::getAngle( front);
+				block.x[lane] = vertex.x;
+				block.y[lane] = vertex.y;
+			}
+		}
+	}
+	/**
+	 *
+	 */
+	std::size_t RobotStateStore::getNumberOfRobots() const
+	{
+		std::lock_guard< std::mutex > lock( storeMutex);
+		return blocks.size() * RobotStateBlock::BlockSize - freeStates.size();
+	}
+	/**
+	 *
+	 */
+	void RobotStateStore::handleTick( unsigned long UNUSEDPARAM(aTick))
+	{
+		advance();
+	}
+	/**
+	 *
+	 */
+	std::string RobotStateStore::asString() const
+	{
+		std::ostringstream os;
+		std::size_t numberOfRobots = getNumberOfRobots();
+		std::lock_guard< std::mutex > lock( storeMutex);
+		os << "RobotStateStore: " << numberOfRobots << " robots in " << blocks.size() << " blocks of " << RobotStateBlock::BlockSize;
+		return os.str();
+	}
+} // namespace Model
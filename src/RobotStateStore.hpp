@@ -0,0 +1,248 @@
+#ifndef ROBOTSTATESTORE_HPP_
+#define ROBOTSTATESTORE_HPP_
+
+#include "Config.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "AStar.hpp"
+#include "BoundedVector.hpp"
+#include "Point.hpp"
+#include "SimulationClock.hpp"
+#include "Thread.hpp"
+
+namespace Model
+{
+	class RobotStateStore;
+
+	/**
+	 * The hot state of the robots of a RobotWorld as a structure of arrays.
+	 *
+	 * The state of BlockSize robots is kept in one Block with an array per field, so a pass over one field
+	 * of all robots reads contiguous memory and the compiler can vectorise it. The blocks never move, so a
+	 * RobotState stays valid while robots are added and removed.
+	 */
+	struct RobotStateBlock
+	{
+			static const std::size_t BlockSize = 64;
+
+			int x[BlockSize];
+			int y[BlockSize];
+			float frontX[BlockSize];
+			float frontY[BlockSize];
+			/**
+			 * The angle of the front in radians, [0, 2 * PI)
+			 */
+			double heading[BlockSize];
+			float speed[BlockSize];
+			/**
+			 * The index in the path of the current position
+			 */
+			unsigned long pathCursor[BlockSize];
+			const PathAlgorithm::Vertex* path[BlockSize];
+			unsigned long pathLength[BlockSize];
+			/**
+			 * Set by the robot for the next RobotStateStore::advance, which clears it
+			 */
+			unsigned char moving[BlockSize];
+			unsigned char used[BlockSize];
+	};
+	// struct RobotStateBlock
+
+	/**
+	 * The handle of the state of one robot in a RobotStateStore.
+	 *
+	 * The fields of one robot are only written by that robot or by RobotStateStore::advance,
+	 * which runs after all TickHandlers of a tick.
+	 */
+	class RobotState
+	{
+		public:
+			/**
+			 *
+			 */
+			RobotState() :
+							block( nullptr),
+							lane( 0)
+			{
+			}
+			/**
+			 *
+			 */
+			RobotState(	RobotStateBlock* aBlock,
+						std::size_t aLane) :
+							block( aBlock),
+							lane( aLane)
+			{
+			}
+			/**
+			 *
+			 */
+			bool isValid() const
+			{
+				return block != nullptr;
+			}
+			/**
+			 *
+			 */
+			Point getPosition() const
+			{
+				return Point( block->x[lane], block->y[lane]);
+			}
+			/**
+			 *
+			 */
+			void setPosition( const Point& aPosition)
+			{
+				block->x[lane] = aPosition.x;
+				block->y[lane] = aPosition.y;
+			}
+			/**
+			 *
+			 */
+			BoundedVector getFront() const
+			{
+				return BoundedVector( block->frontX[lane], block->frontY[lane]);
+			}
+			/**
+			 * Sets the heading as well
+			 */
+			void setFront( const BoundedVector& aFront);
+			/**
+			 *
+			 */
+			double getHeading() const
+			{
+				return block->heading[lane];
+			}
+			/**
+			 *
+			 */
+			float getSpeed() const
+			{
+				return block->speed[lane];
+			}
+			/**
+			 *
+			 */
+			void setSpeed( float aSpeed)
+			{
+				block->speed[lane] = aSpeed;
+			}
+			/**
+			 *
+			 */
+			unsigned long getPathCursor() const
+			{
+				return block->pathCursor[lane];
+			}
+			/**
+			 *
+			 */
+			void setPathCursor( unsigned long aPathCursor)
+			{
+				block->pathCursor[lane] = aPathCursor;
+			}
+			/**
+			 * aPath must stay as it is while the robot is moving
+			 */
+			void setPath( const PathAlgorithm::Path& aPath)
+			{
+				block->path[lane] = aPath.empty() ? nullptr : aPath.data();
+				block->pathLength[lane] = aPath.size();
+			}
+			/**
+			 * Lets the next RobotStateStore::advance move the robot speed path points along its path
+			 */
+			void setMoving( bool aMoving)
+			{
+				block->moving[lane] = aMoving ? 1 : 0;
+			}
+			/**
+			 *
+			 */
+			bool isMoving() const
+			{
+				return block->moving[lane] != 0;
+			}
+
+		private:
+			friend class RobotStateStore;
+
+			RobotStateBlock* block;
+			std::size_t lane;
+	};
+	// class RobotState
+
+	/**
+	 * The RobotStateBlocks of a RobotWorld. It is attached to the SimulationClock of the world as a
+	 * post tick handler: after the robots have decided what to do in a tick, advance moves all robots
+	 * that are moving in one pass over the blocks. During the tick all robots therefore see the
+	 * positions of the others as they were at the start of the tick.
+	 */
+	class RobotStateStore : public TickHandler
+	{
+		public:
+			/**
+			 *
+			 */
+			RobotStateStore();
+			/**
+			 *
+			 */
+			virtual ~RobotStateStore();
+			/**
+			 *
+			 */
+			RobotStateStore( const RobotStateStore& aRobotStateStore) = delete;
+			/**
+			 *
+			 */
+			RobotStateStore& operator=( const RobotStateStore& aRobotStateStore) = delete;
+			/**
+			 * @return the state of a new robot at (0,0) that is not moving
+			 */
+			RobotState allocate();
+			/**
+			 * aRobotState is invalid afterwards
+			 */
+			void release( RobotState& aRobotState);
+			/**
+			 * Moves every robot that is moving along its path: the path cursor is advanced by the speed,
+			 * the position becomes the vertex at the cursor (or the last one) and the front points from the
+			 * old to the new position.
+			 */
+			void advance();
+			/**
+			 *
+			 */
+			std::size_t getNumberOfRobots() const;
+			/**
+			 * @name TickHandler functions
+			 */
+			//@{
+			/**
+			 * Calls advance
+			 */
+			virtual void handleTick( unsigned long aTick);
+			//@}
+			/**
+			 * @name Debug functions
+			 */
+			//@{
+			/**
+			 * Returns a 1-line description of the object
+			 */
+			std::string asString() const;
+			//@}
+
+		private:
+			std::vector< std::unique_ptr< RobotStateBlock > > blocks;
+			std::vector< RobotState > freeStates;
+			mutable std::mutex storeMutex;
+	};
+	// class RobotStateStore
+} // namespace Model
+#endif // ROBOTSTATESTORE_HPP_
@@ -4,26 +4,290 @@
 #include "WayPoint.hpp"
 #include "Goal.hpp"
 #include "Wall.hpp"
-#include "MainApplication.hpp"
+#include "CommandlineArguments.hpp"
+#include "SegmentGrid.hpp"
+#include "SimulationClock.hpp"
+#include "RobotStateStore.hpp"
+#include "EventBus.hpp"
 #include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
 
 namespace Model
 {
+namespace
+{
+typedef RobotWorld::Snapshot::IdIndex IdIndex;
+typedef RobotWorld::Snapshot::NameIndex NameIndex;
+
+/**
+ * The distance between the parallel walls of populate
+ */
+const double WallSpacing = 60.0;
+
+/**
+ * Appends anObject to someObjects and indexes it by ObjectId
+ */
+template<typename ObjectPtr>
+void addObject(std::vector<ObjectPtr>& someObjects, IdIndex& someIds, const ObjectPtr& anObject)
+{
+	someIds[anObject->getObjectId()] = someObjects.size();
+	someObjects.push_back(anObject);
+}
+/**
+ * Appends anObject to someObjects and indexes it by ObjectId and by name
+ */
+template<typename ObjectPtr>
+void addObject(std::vector<ObjectPtr>& someObjects, IdIndex& someIds, NameIndex& someNames, const ObjectPtr& anObject)
+{
+	someNames.insert(std::make_pair(anObject->getName(), someObjects.size()));
+	addObject(someObjects, someIds, anObject);
+}
+/**
+ * Removes the object with anObjectId by moving the last object into its place
+ *
+ * @return the removed object or nullptr if there is none
+ */
+template<typename ObjectPtr>
+ObjectPtr removeObject(std::vector<ObjectPtr>& someObjects, IdIndex& someIds, const Base::ObjectId& anObjectId)
+{
+	auto i = someIds.find(anObjectId);
+	if (i == someIds.end())
+	{
+		return nullptr;
+	}
+	std::size_t index = i->second;
+	ObjectPtr object = someObjects[index];
+	someIds.erase(i);
+	if (index != someObjects.size() - 1)
+	{
+		someObjects[index] = someObjects.back();
+		someIds[someObjects[index]->getObjectId()] = index;
+	}
+	someObjects.pop_back();
+	return object;
+}
+/**
+ * Changes the index of the entry for aName from anOldIndex to aNewIndex or removes it if aNewIndex is npos
+ */
+void reindexName(NameIndex& someNames, const std::string& aName, std::size_t anOldIndex, std::size_t aNewIndex)
+{
+	auto range = someNames.equal_range(aName);
+	for (auto i = range.first; i != range.second; ++i)
+	{
+		if (i->second == anOldIndex)
+		{
+			if (aNewIndex == std::string::npos)
+			{
+				someNames.erase(i);
+			} else
+			{
+				i->second = aNewIndex;
+			}
+			return;
+		}
+	}
+}
+/**
+ * As above, keeping the name index up to date as well
+ */
+template<typename ObjectPtr>
+ObjectPtr removeObject(std::vector<ObjectPtr>& someObjects, IdIndex& someIds, NameIndex& someNames, const Base::ObjectId& anObjectId)
+{
+	auto i = someIds.find(anObjectId);
+	if (i == someIds.end())
+	{
+		return nullptr;
+	}
+	std::size_t index = i->second;
+	std::size_t last = someObjects.size() - 1;
+	reindexName(someNames, someObjects[index]->getName(), index, std::string::npos);
+	if (index != last)
+	{
+		reindexName(someNames, someObjects[last]->getName(), last, index);
+	}
+	return removeObject(someObjects, someIds, anObjectId);
+}
+/**
+ *
+ */
+template<typename ObjectPtr>
+ObjectPtr findObject(const std::vector<ObjectPtr>& someObjects, const IdIndex& someIds, const Base::ObjectId& anObjectId)
+{
+	auto i = someIds.find(anObjectId);
+	return i == someIds.end() ? nullptr : someObjects[i->second];
+}
+/**
+ * An object is renamed just before the index is, so the name of a hit is checked
+ */
+template<typename ObjectPtr>
+ObjectPtr findObject(const std::vector<ObjectPtr>& someObjects, const NameIndex& someNames, const std::string& aName)
+{
+	auto range = someNames.equal_range(aName);
+	for (auto i = range.first; i != range.second; ++i)
+	{
+		if (i->second < someObjects.size() && someObjects[i->second]->getName() == aName)
+		{
+			return someObjects[i->second];
+		}
+	}
+	return nullptr;
+}
+/**
+ * Moves the entry of the object with anObjectId in the name index from anOldName to its current name
+ */
+template<typename ObjectPtr>
+bool renameObject(const std::vector<ObjectPtr>& someObjects, const IdIndex& someIds, NameIndex& someNames, const Base::ObjectId& anObjectId, const std::string& anOldName)
+{
+	auto i = someIds.find(anObjectId);
+	if (i == someIds.end())
+	{
+		return false;
+	}
+	reindexName(someNames, anOldName, i->second, std::string::npos);
+	someNames.insert(std::make_pair(someObjects[i->second]->getName(), i->second));
+	return true;
+}
+/**
+ * Rebuilds the indexes of someObjects
+ */
+template<typename ObjectPtr>
+void reindex(const std::vector<ObjectPtr>& someObjects, IdIndex& someIds)
+{
+	someIds.clear();
+	for (std::size_t index = 0; index < someObjects.size(); ++index)
+	{
+		someIds[someObjects[index]->getObjectId()] = index;
+	}
+}
+/**
+ *
+ */
+template<typename ObjectPtr>
+void reindex(const std::vector<ObjectPtr>& someObjects, IdIndex& someIds, NameIndex& someNames)
+{
+	reindex(someObjects, someIds);
+	someNames.clear();
+	for (std::size_t index = 0; index < someObjects.size(); ++index)
+	{
+		someNames.insert(std::make_pair(someObjects[index]->getName(), index));
+	}
+}
+} // namespace
+
 /**
  *
  */
 /* static */RobotWorld& RobotWorld::RobotWorld::getRobotWorld()
 {
-	static RobotWorld robotWorld;
+	static RobotWorld robotWorld(SimulationClock::getSimulationClock());
 	return robotWorld;
 }
+/**
+ *
+ */
+void RobotWorld::Diff::recordAdded(const Base::ObjectId& anObjectId)
+{
+	added.push_back(anObjectId);
+}
+/**
+ *
+ */
+void RobotWorld::Diff::recordRemoved(const Base::ObjectId& anObjectId)
+{
+	auto i = std::find(added.begin(), added.end(), anObjectId);
+	if (i != added.end())
+	{
+		added.erase(i);
+		return;
+	}
+	moved.erase(std::remove(moved.begin(), moved.end(), anObjectId), moved.end());
+	removed.push_back(anObjectId);
+}
+/**
+ *
+ */
+void RobotWorld::Diff::recordMoved(const Base::ObjectId& anObjectId)
+{
+	if (std::find(added.begin(), added.end(), anObjectId) == added.end() &&
+		std::find(moved.begin(), moved.end(), anObjectId) == moved.end())
+	{
+		moved.push_back(anObjectId);
+	}
+}
+/**
+ *
+ */
+bool RobotWorld::Diff::isEmpty() const
+{
+	return added.empty() && removed.empty() && moved.empty();
+}
+/**
+ *
+ */
+std::string RobotWorld::Diff::asString() const
+{
+	std::ostringstream os;
+	os << "Diff: " << added.size() << " added, " << removed.size() << " removed, " << moved.size() << " moved";
+	return os.str();
+}
+/**
+ *
+ */
+RobotWorld::Batch::Batch(RobotWorld& aRobotWorld) :
+		robotWorld(aRobotWorld)
+{
+	robotWorld.beginBatch();
+}
+/**
+ *
+ */
+RobotWorld::Batch::~Batch()
+{
+	try
+	{
+		robotWorld.commitBatch();
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << __PRETTY_FUNCTION__ << ": " << e.what() << std::endl;
+	}
+	catch (...)
+	{
+		std::cerr << __PRETTY_FUNCTION__ << ": unknown exception" << std::endl;
+	}
+}
+/**
+ *
+ */
+RobotWorld::Snapshot::Snapshot() :
+		version(0)
+{
+}
+/**
+ *
+ */
+RobotWorld::SnapshotPtr RobotWorld::getSnapshot() const
+{
+	return std::atomic_load(&snapshot);
+}
 /**
  *
  */
 RobotPtr RobotWorld::newRobot(const std::string& aName /*= "New Robot"*/, const Point& aPosition /*= Point(-1,-1)*/, bool aNotifyObservers /*= true*/)
 {
-	RobotPtr robot(new Robot(aName, aPosition));
-	robots.push_back(robot);
+	RobotPtr robot(new Robot(aName, aPosition, *this));
+	{
+		std::lock_guard<std::mutex> lock(writerMutex);
+		std::shared_ptr<Snapshot> newSnapshot = editSnapshot();
+		addObject(newSnapshot->robots, newSnapshot->robotIds, newSnapshot->robotNames, robot);
+		publish(newSnapshot);
+	}
+	{
+		std::lock_guard<std::mutex> lock(changeMutex);
+		pendingDiff.recordAdded(robot->getObjectId());
+	}
 	if (aNotifyObservers == true)
 	{
 		notifyObservers();
@@ -37,7 +301,17 @@ WayPointPtr RobotWorld::newWayPoint(const std::string& aName /*= "new WayPoint"*
 		bool aNotifyObservers /*= true*/)
 {
 	WayPointPtr wayPoint(new WayPoint(aName, aPosition));
-	wayPoints.push_back(wayPoint);
+	wayPoint->setRobotWorld(this);
+	{
+		std::lock_guard<std::mutex> lock(writerMutex);
+		std::shared_ptr<Snapshot> newSnapshot = editSnapshot();
+		addObject(newSnapshot->wayPoints, newSnapshot->wayPointIds, newSnapshot->wayPointNames, wayPoint);
+		publish(newSnapshot);
+	}
+	{
+		std::lock_guard<std::mutex> lock(changeMutex);
+		pendingDiff.recordAdded(wayPoint->getObjectId());
+	}
 	if (aNotifyObservers == true)
 	{
 		notifyObservers();
@@ -50,7 +324,17 @@ WayPointPtr RobotWorld::newWayPoint(const std::string& aName /*= "new WayPoint"*
 GoalPtr RobotWorld::newGoal(const std::string& aName /*= "New Goal"*/, const Point& aPosition /*= Point(-1,-1)*/, bool aNotifyObservers /*= true*/)
 {
 	GoalPtr goal(new Goal(aName, aPosition));
-	goals.push_back(goal);
+	goal->setRobotWorld(this);
+	{
+		std::lock_guard<std::mutex> lock(writerMutex);
+		std::shared_ptr<Snapshot> newSnapshot = editSnapshot();
+		addObject(newSnapshot->goals, newSnapshot->goalIds, newSnapshot->goalNames, goal);
+		publish(newSnapshot);
+	}
+	{
+		std::lock_guard<std::mutex> lock(changeMutex);
+		pendingDiff.recordAdded(goal->getObjectId());
+	}
 	if (aNotifyObservers == true)
 	{
 		notifyObservers();
@@ -63,7 +347,17 @@ GoalPtr RobotWorld::newGoal(const std::string& aName /*= "New Goal"*/, const Poi
 WallPtr RobotWorld::newWall(const Point& aPoint1, const Point& aPoint2, bool aNotifyObservers /*= true*/)
 {
 	WallPtr wall(new Wall(aPoint1, aPoint2));
-	walls.push_back(wall);
+	wall->setRobotWorld(this);
+	{
+		std::lock_guard<std::mutex> lock(writerMutex);
+		std::shared_ptr<Snapshot> newSnapshot = editSnapshot();
+		addObject(newSnapshot->walls, newSnapshot->wallIds, wall);
+		publish(newSnapshot, true);
+	}
+	{
+		std::lock_guard<std::mutex> lock(changeMutex);
+		pendingDiff.recordAdded(wall->getObjectId());
+	}
 	if (aNotifyObservers == true)
 	{
 		notifyObservers();
@@ -75,13 +369,17 @@ WallPtr RobotWorld::newWall(const Point& aPoint1, const Point& aPoint2, bool aNo
  */
 void RobotWorld::deleteRobot(RobotPtr aRobot, bool aNotifyObservers /*= true*/)
 {
-	auto i = std::find_if(robots.begin(), robots.end(), [aRobot](RobotPtr r)
-	{
-		return aRobot->getName() == r->getName();
-	});
-	if (i != robots.end())
+	std::unique_lock<std::mutex> lock(writerMutex);
+	std::shared_ptr<Snapshot> newSnapshot = editSnapshot();
+	if (removeObject(newSnapshot->robots, newSnapshot->robotIds, newSnapshot->robotNames, aRobot->getObjectId()))
 	{
-		robots.erase(i);
+		{
+			std::lock_guard<std::mutex> lock(changeMutex);
+			pendingDiff.recordRemoved(aRobot->getObjectId());
+		}
+		publish(newSnapshot);
+		lock.unlock();
+
 		if (aNotifyObservers == true)
 		{
 			notifyObservers();
@@ -93,13 +391,18 @@ void RobotWorld::deleteRobot(RobotPtr aRobot, bool aNotifyObservers /*= true*/)
  */
 void RobotWorld::deleteWayPoint(WayPointPtr aWayPoint, bool aNotifyObservers /*= true*/)
 {
-	auto i = std::find_if(wayPoints.begin(), wayPoints.end(), [aWayPoint]( WayPointPtr w)
-	{
-		return aWayPoint->getName() == w->getName();
-	});
-	if (i != wayPoints.end())
+	std::unique_lock<std::mutex> lock(writerMutex);
+	std::shared_ptr<Snapshot> newSnapshot = editSnapshot();
+	if (removeObject(newSnapshot->wayPoints, newSnapshot->wayPointIds, newSnapshot->wayPointNames, aWayPoint->getObjectId()))
 	{
-		wayPoints.erase(i);
+		{
+			std::lock_guard<std::mutex> lock(changeMutex);
+			pendingDiff.recordRemoved(aWayPoint->getObjectId());
+		}
+		publish(newSnapshot);
+		aWayPoint->setRobotWorld(nullptr);
+		lock.unlock();
+
 		if (aNotifyObservers == true)
 		{
 			notifyObservers();
@@ -111,13 +414,17 @@ void RobotWorld::deleteWayPoint(WayPointPtr aWayPoint, bool aNotifyObservers /*=
  */
 void RobotWorld::deleteGoal(GoalPtr aGoal, bool aNotifyObservers /*= true*/)
 {
-	auto i = std::find_if(goals.begin(), goals.end(), [aGoal]( GoalPtr g)
+	std::unique_lock<std::mutex> lock(writerMutex);
+	std::shared_ptr<Snapshot> newSnapshot = editSnapshot();
+	if (removeObject(newSnapshot->goals, newSnapshot->goalIds, newSnapshot->goalNames, aGoal->getObjectId()))
 	{
-		return aGoal->getName() == g->getName();
-	});
-	if (i != goals.end())
-	{
-		goals.erase(i);
+		{
+			std::lock_guard<std::mutex> lock(changeMutex);
+			pendingDiff.recordRemoved(aGoal->getObjectId());
+		}
+		publish(newSnapshot);
+		aGoal->setRobotWorld(nullptr);
+		lock.unlock();
 
 		if (aNotifyObservers == true)
 		{
@@ -130,15 +437,17 @@ void RobotWorld::deleteGoal(GoalPtr aGoal, bool aNotifyObservers /*= true*/)
  */
 void RobotWorld::deleteWall(WallPtr aWall, bool aNotifyObservers /*= true*/)
 {
-	auto i = std::find_if(walls.begin(), walls.end(), [aWall]( WallPtr w)
-	{
-		return
-		aWall->getPoint1() == w->getPoint1() &&
-		aWall->getPoint2() == w->getPoint2();
-	});
-	if (i != walls.end())
+	std::unique_lock<std::mutex> lock(writerMutex);
+	std::shared_ptr<Snapshot> newSnapshot = editSnapshot();
+	if (removeObject(newSnapshot->walls, newSnapshot->wallIds, aWall->getObjectId()))
 	{
-		walls.erase(i);
+		{
+			std::lock_guard<std::mutex> lock(changeMutex);
+			pendingDiff.recordRemoved(aWall->getObjectId());
+		}
+		publish(newSnapshot, true);
+		aWall->setRobotWorld(nullptr);
+		lock.unlock();
 
 		if (aNotifyObservers == true)
 		{
@@ -151,162 +460,263 @@ void RobotWorld::deleteWall(WallPtr aWall, bool aNotifyObservers /*= true*/)
  */
 RobotPtr RobotWorld::getRobot(const std::string& aName) const
 {
-	for (RobotPtr robot : robots)
-	{
-		if (robot->getName() == aName)
-		{
-			return robot;
-		}
-	}
-	return nullptr;
+	SnapshotPtr snapshot = getSnapshot();
+	return findObject(snapshot->robots, snapshot->robotNames, aName);
 }
 /**
  *
  */
 RobotPtr RobotWorld::getRobot(const Base::ObjectId& anObjectId) const
 {
-	for (RobotPtr robot : robots)
-	{
-		if (robot->getObjectId() == anObjectId)
-		{
-			return robot;
-		}
-	}
-	return nullptr;
+	SnapshotPtr snapshot = getSnapshot();
+	return findObject(snapshot->robots, snapshot->robotIds, anObjectId);
 }
 /**
  *
  */
 WayPointPtr RobotWorld::getWayPoint(const std::string& aName) const
 {
-	for (WayPointPtr wayPoint : wayPoints)
-	{
-		if (wayPoint->getName() == aName)
-		{
-			return wayPoint;
-		}
-	}
-	return nullptr;
+	SnapshotPtr snapshot = getSnapshot();
+	return findObject(snapshot->wayPoints, snapshot->wayPointNames, aName);
 }
 /**
  *
  */
 WayPointPtr RobotWorld::getWayPoint(const Base::ObjectId& anObjectId) const
 {
-	for (WayPointPtr wayPoint : wayPoints)
-	{
-		if (wayPoint->getObjectId() == anObjectId)
-		{
-			return wayPoint;
-		}
-	}
-	return nullptr;
+	SnapshotPtr snapshot = getSnapshot();
+	return findObject(snapshot->wayPoints, snapshot->wayPointIds, anObjectId);
 }
 /**
  *
  */
 GoalPtr RobotWorld::getGoal(const std::string& aName) const
 {
-	for (GoalPtr goal : goals)
+	SnapshotPtr snapshot = getSnapshot();
+	return findObject(snapshot->goals, snapshot->goalNames, aName);
+}
+/**
+ *
+ */
+GoalPtr RobotWorld::getGoal(const Base::ObjectId& anObjectId) const
+{
+	SnapshotPtr snapshot = getSnapshot();
+	return findObject(snapshot->goals, snapshot->goalIds, anObjectId);
+}
+/**
+ *
+ */
+WallPtr RobotWorld::getWall(const Base::ObjectId& anObjectId) const
+{
+	SnapshotPtr snapshot = getSnapshot();
+	return findObject(snapshot->walls, snapshot->wallIds, anObjectId);
+}
+/**
+ *
+ */
+std::vector<RobotPtr> RobotWorld::getRobots() const
+{
+	return getSnapshot()->robots;
+}
+/**
+ *
+ */
+std::vector<WayPointPtr> RobotWorld::getWayPoints() const
+{
+	return getSnapshot()->wayPoints;
+}
+/**
+ *
+ */
+std::vector<GoalPtr> RobotWorld::getGoals() const
+{
+	return getSnapshot()->goals;
+}
+/**
+ *
+ */
+std::vector<WallPtr> RobotWorld::getWalls() const
+{
+	return getSnapshot()->walls;
+}
+/**
+ *
+ */
+std::shared_ptr<const Utils::SegmentGrid> RobotWorld::getWallGrid() const
+{
+	std::lock_guard<std::mutex> lock(wallGridMutex);
+
+	if (!wallGrid || wallGridRevision != wallRevision)
 	{
-		if (goal->getName() == aName)
+		// Read the revision before the walls: a change during the rebuild makes the next call rebuild again
+		wallGridRevision = wallRevision;
+
+		std::shared_ptr<Utils::SegmentGrid> grid(new Utils::SegmentGrid());
+		for (WallPtr wall : getSnapshot()->walls)
 		{
-			return goal;
+			grid->addSegment(wall->getPoint1(), wall->getPoint2());
 		}
+		grid->build();
+		wallGrid = grid;
 	}
-	return nullptr;
+	return wallGrid;
 }
 /**
  *
  */
-GoalPtr RobotWorld::getGoal(const Base::ObjectId& anObjectId) const
+void RobotWorld::updateNameIndex(const Base::ObjectId& anObjectId, const std::string& anOldName)
 {
-	for (GoalPtr goal : goals)
+	std::lock_guard<std::mutex> lock(writerMutex);
+	std::shared_ptr<Snapshot> newSnapshot = editSnapshot();
+	if (renameObject(newSnapshot->robots, newSnapshot->robotIds, newSnapshot->robotNames, anObjectId, anOldName) ||
+		renameObject(newSnapshot->wayPoints, newSnapshot->wayPointIds, newSnapshot->wayPointNames, anObjectId, anOldName) ||
+		renameObject(newSnapshot->goals, newSnapshot->goalIds, newSnapshot->goalNames, anObjectId, anOldName))
 	{
-		if (goal->getObjectId() == anObjectId)
-		{
-			return goal;
-		}
+		publish(newSnapshot);
 	}
-	return nullptr;
 }
 /**
  *
  */
-WallPtr RobotWorld::getWall(const Base::ObjectId& anObjectId) const
+void RobotWorld::wallMoved()
+{
+	++wallRevision;
+}
+/**
+ *
+ */
+void RobotWorld::notifyMoved(const Base::ObjectId& anObjectId, bool aNotifyObservers /*= true*/)
 {
-	for (WallPtr wall : walls)
 	{
-		if (wall->getObjectId() == anObjectId)
-		{
-			return wall;
-		}
+		std::lock_guard<std::mutex> lock(changeMutex);
+		pendingDiff.recordMoved(anObjectId);
+	}
+	if (aNotifyObservers == true)
+	{
+		notifyObservers();
 	}
-	return nullptr;
 }
-
 /**
  *
  */
-const std::vector<RobotPtr>& RobotWorld::getRobots() const
+void RobotWorld::beginBatch()
 {
-	return robots;
+	std::lock_guard<std::mutex> lock(changeMutex);
+	++batchDepth;
 }
 /**
  *
  */
-const std::vector<WayPointPtr>& RobotWorld::getWayPoints() const
+void RobotWorld::commitBatch()
 {
-	return wayPoints;
+	{
+		// In the order of the writers
+		std::lock_guard<std::mutex> writerLock(writerMutex);
+		std::lock_guard<std::mutex> lock(changeMutex);
+		if (batchDepth == 0)
+		{
+			throw std::logic_error("RobotWorld::commitBatch without beginBatch");
+		}
+		if (--batchDepth > 0)
+		{
+			return;
+		}
+		if (workingSnapshot)
+		{
+			std::atomic_store(&snapshot, SnapshotPtr(workingSnapshot));
+			if (workingWallsChanged)
+			{
+				++wallRevision;
+			}
+			workingSnapshot.reset();
+			workingWallsChanged = false;
+		}
+		if (pendingDiff.isEmpty())
+		{
+			return;
+		}
+	}
+	notifyObservers();
 }
 /**
  *
  */
-const std::vector<GoalPtr>& RobotWorld::getGoals() const
+RobotWorld::Diff RobotWorld::getLastDiff() const
 {
-	return goals;
+	std::lock_guard<std::mutex> lock(changeMutex);
+	return lastDiff;
 }
 /**
  *
  */
-const std::vector<WallPtr>& RobotWorld::getWalls() const
+void RobotWorld::notifyObservers()
 {
-	return walls;
+	Diff diff;
+	{
+		std::lock_guard<std::mutex> lock(changeMutex);
+		if (batchDepth > 0)
+		{
+			return;
+		}
+		lastDiff = pendingDiff;
+		pendingDiff = Diff();
+		diff = lastDiff;
+	}
+
+	if (isEnabledForNotification())
+	{
+		Base::EventBus& eventBus = Base::EventBus::getEventBus();
+		for (const Base::ObjectId& objectId : diff.added)
+		{
+			eventBus.publish(Base::ChangeEvent(objectId, Base::ChangeEvent::Added));
+		}
+		for (const Base::ObjectId& objectId : diff.removed)
+		{
+			eventBus.publish(Base::ChangeEvent(objectId, Base::ChangeEvent::Removed));
+		}
+		for (const Base::ObjectId& objectId : diff.moved)
+		{
+			eventBus.publish(Base::ChangeEvent(objectId, Base::ChangeEvent::Position));
+		}
+	}
+	ModelObject::notifyObservers();
 }
 /**
  *
  */
-void RobotWorld::populate(int aNumberOfWalls /*= 2*/)
+void RobotWorld::populate(int aNumberOfWalls /*= 1*/)
 {
 
-	static Point coordinates[2];
-	static Point goalPoint;
+	Point coordinates[2];
+	Point goalPoint;
+
+	Batch batch(*this);
 
 	std::string robotType = "notclient";
-	if (Application::MainApplication::isArgGiven("-robot_type"))
+	if (Application::CommandlineArguments::isArgGiven("-robot_type"))
 	{
-		robotType = Application::MainApplication::getArg("-robot_type").value;
+		robotType = Application::CommandlineArguments::getArg("-robot_type").value;
 
-		std::cout<<"Populate get ARG: "<<robotType<<std::endl;
+		Application::Logger::log("Populate get ARG: " + robotType);
 
 	}
 
 	if (robotType == "client")
 	{
-		RobotWorld::getRobotWorld().newRobot("Robot", Point(50, 50), false);
+		newRobot("Robot", Point(50, 50), false);
 
 		coordinates[0] = Point(100, 100);
 		coordinates[1] = Point(400, 400);
 
-		std::cout<<"Populate client "<<std::endl;
+		Application::Logger::log("Populate client");
 
 		goalPoint = Point(450, 450);
 	}
 	else
 	{
-		RobotWorld::getRobotWorld().newRobot("Robot", Point(450, 50), false);
+		newRobot("Robot", Point(450, 50), false);
 
-		std::cout<<"Populate non client"<<std::endl;
+		Application::Logger::log("Populate non client");
 
 		coordinates[0] = Point(100, 400);
 		coordinates[1] = Point(400, 100);
@@ -314,35 +724,86 @@ void RobotWorld::populate(int aNumberOfWalls /*= 2*/)
 		goalPoint = Point(50, 450);
 	}
 
-	//for (int i = 0; i < 2 * aNumberOfWalls; i += 2)
-	//{
-		RobotWorld::getRobotWorld().newWall(coordinates[0], coordinates[1], false);
-	//}
-
-	RobotWorld::getRobotWorld().newGoal("Goal", goalPoint, false);
+	// The first wall lies across the way to the goal, the others are half as long and parallel
+	// to it, alternately on either side of it, so that the robot can always get round them
+	double dx = coordinates[1].x - coordinates[0].x;
+	double dy = coordinates[1].y - coordinates[0].y;
+	double length = std::sqrt(dx * dx + dy * dy);
+	for (int i = 0; i < aNumberOfWalls; ++i)
+	{
+		if (i == 0)
+		{
+			newWall(coordinates[0], coordinates[1], false);
+			continue;
+		}
+		double offset = ((i + 1) / 2) * WallSpacing * (i % 2 == 1 ? 1.0 : -1.0);
+		double normalX = -dy / length * offset;
+		double normalY = dx / length * offset;
+		newWall(Point(static_cast<int>(coordinates[0].x + dx / 4 + normalX), static_cast<int>(coordinates[0].y + dy / 4 + normalY)),
+				Point(static_cast<int>(coordinates[0].x + 3 * dx / 4 + normalX), static_cast<int>(coordinates[0].y + 3 * dy / 4 + normalY)),
+				false);
+	}
 
-	notifyObservers();
+	newGoal("Goal", goalPoint, false);
 }
 /**
  *
  */
 void RobotWorld::unpopulate(bool aNotifyObservers /*= true*/)
 {
-	robots.clear();
-	wayPoints.clear();
-	goals.clear();
-	walls.clear();
-
-	if (aNotifyObservers)
-	{
-		notifyObservers();
-	}
+	unpopulate(std::vector<Base::ObjectId>(), aNotifyObservers);
 }
 /**
  *
  */
 void RobotWorld::unpopulate(const std::vector<Base::ObjectId>& aKeepObjects, bool aNotifyObservers /*= true*/)
 {
+	std::unique_lock<std::mutex> lock(writerMutex);
+	std::shared_ptr<Snapshot> newSnapshot = editSnapshot();
+	{
+		std::lock_guard<std::mutex> lock(changeMutex);
+		auto recordRemoved = [this, &aKeepObjects](const Base::ObjectId& anObjectId)
+		{
+			if (std::find( aKeepObjects.begin(), aKeepObjects.end(), anObjectId) == aKeepObjects.end())
+			{
+				pendingDiff.recordRemoved( anObjectId);
+				return true;
+			}
+			return false;
+		};
+		for (RobotPtr robot : newSnapshot->robots)
+		{
+			recordRemoved(robot->getObjectId());
+		}
+		for (WayPointPtr wayPoint : newSnapshot->wayPoints)
+		{
+			if (recordRemoved(wayPoint->getObjectId()))
+			{
+				wayPoint->setRobotWorld(nullptr);
+			}
+		}
+		for (GoalPtr goal : newSnapshot->goals)
+		{
+			if (recordRemoved(goal->getObjectId()))
+			{
+				goal->setRobotWorld(nullptr);
+			}
+		}
+		for (WallPtr wall : newSnapshot->walls)
+		{
+			if (recordRemoved(wall->getObjectId()))
+			{
+				wall->setRobotWorld(nullptr);
+			}
+		}
+	}
+
+	std::vector<RobotPtr>& robots = newSnapshot->robots;
+	std::vector<WayPointPtr>& wayPoints = newSnapshot->wayPoints;
+	std::vector<GoalPtr>& goals = newSnapshot->goals;
+	std::vector<WallPtr>& walls = newSnapshot->walls;
+	bool wallsRemoved = !walls.empty();
+
 	if (robots.size() > 0)
 	{
 		robots.erase(std::remove_if(robots.begin(), robots.end(), [&aKeepObjects](RobotPtr aRobot)
@@ -379,12 +840,54 @@ void RobotWorld::unpopulate(const std::vector<Base::ObjectId>& aKeepObjects, boo
 					aWall->getObjectId()) == aKeepObjects.end();
 		}), walls.end());
 	}
+	reindex(robots, newSnapshot->robotIds, newSnapshot->robotNames);
+	reindex(wayPoints, newSnapshot->wayPointIds, newSnapshot->wayPointNames);
+	reindex(goals, newSnapshot->goalIds, newSnapshot->goalNames);
+	reindex(walls, newSnapshot->wallIds);
+	publish(newSnapshot, wallsRemoved);
+	lock.unlock();
 
 	if (aNotifyObservers)
 	{
 		notifyObservers();
 	}
 }
+/**
+ *
+ */
+std::shared_ptr<RobotWorld::Snapshot> RobotWorld::editSnapshot()
+{
+	std::lock_guard<std::mutex> lock(changeMutex);
+	if (batchDepth > 0 && workingSnapshot)
+	{
+		return workingSnapshot;
+	}
+	std::shared_ptr<Snapshot> newSnapshot(new Snapshot(*std::atomic_load(&snapshot)));
+	++newSnapshot->version;
+	if (batchDepth > 0)
+	{
+		// The first change of the batch: one copy for the whole batch
+		workingSnapshot = newSnapshot;
+	}
+	return newSnapshot;
+}
+/**
+ *
+ */
+void RobotWorld::publish(const std::shared_ptr<Snapshot>& aSnapshot, bool aWallsChanged /*= false*/)
+{
+	if (aSnapshot == workingSnapshot)
+	{
+		// Published by commitBatch
+		workingWallsChanged = workingWallsChanged || aWallsChanged;
+		return;
+	}
+	std::atomic_store(&snapshot, SnapshotPtr(aSnapshot));
+	if (aWallsChanged)
+	{
+		++wallRevision;
+	}
+}
 /**
  *
  */
@@ -401,19 +904,20 @@ std::string RobotWorld::asDebugString() const
 
 	os << asString() << '\n';
 
-	for (RobotPtr ptr : robots)
+	SnapshotPtr snapshot = getSnapshot();
+	for (RobotPtr ptr : snapshot->robots)
 	{
 		os << ptr->asDebugString() << '\n';
 	}
-	for (WayPointPtr ptr : wayPoints)
+	for (WayPointPtr ptr : snapshot->wayPoints)
 	{
 		os << ptr->asDebugString() << '\n';
 	}
-	for (GoalPtr ptr : goals)
+	for (GoalPtr ptr : snapshot->goals)
 	{
 		os << ptr->asDebugString() << '\n';
 	}
-	for (WallPtr ptr : walls)
+	for (WallPtr ptr : snapshot->walls)
 	{
 		os << ptr->asDebugString() << '\n';
 	}
@@ -424,7 +928,7 @@ std::string RobotWorld::asDebugString() const
 std::string RobotWorld::getWallData() const {
 	std::ostringstream os;
 
-	for(WallPtr w : walls) {
+	for(WallPtr w : getSnapshot()->walls) {
 		os	<<w->getPoint1().x << ","
 			<<w->getPoint1().y << ","
 			<<w->getPoint2().x << ","
@@ -435,8 +939,31 @@ std::string RobotWorld::getWallData() const {
 /**
  *
  */
-RobotWorld::RobotWorld()
+RobotWorld::RobotWorld() :
+		ownSimulationClock(new SimulationClock()),
+		simulationClock(*ownSimulationClock),
+		robotStateStore(std::make_shared<RobotStateStore>()),
+		snapshot(std::make_shared<Snapshot>()),
+		workingWallsChanged(false),
+		wallRevision(0),
+		wallGridRevision(0),
+		batchDepth(0)
 {
+	simulationClock.attachPostTickHandler(robotStateStore.get());
+}
+/**
+ *
+ */
+RobotWorld::RobotWorld(SimulationClock& aSimulationClock) :
+		simulationClock(aSimulationClock),
+		robotStateStore(std::make_shared<RobotStateStore>()),
+		snapshot(std::make_shared<Snapshot>()),
+		workingWallsChanged(false),
+		wallRevision(0),
+		wallGridRevision(0),
+		batchDepth(0)
+{
+	simulationClock.attachPostTickHandler(robotStateStore.get());
 }
 /**
  *
@@ -445,6 +972,18 @@ RobotWorld::~RobotWorld()
 {
 	// No notification while I am in the destruction mode!
 	disableNotification();
+	// A robot that outlives its world must not be driven by the clock of the world anymore
+	for (RobotPtr robot : getSnapshot()->robots)
+	{
+		if (robot->isActing())
+		{
+			robot->stopActing();
+		} else if (robot->isDriving())
+		{
+			robot->stopDriving();
+		}
+	}
+	simulationClock.detachPostTickHandler(robotStateStore.get());
 	unpopulate();
 }
 
@@ -2,10 +2,20 @@
 #define ROBOTWORLD_HPP_
 
 #include "Config.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include "ModelObject.hpp"
 #include "Point.hpp"
 
+namespace Utils
+{
+	class SegmentGrid;
+}
+
 namespace Model
 {
 	class Robot;
@@ -23,16 +33,184 @@ namespace Model
 	class RobotWorld;
 	typedef std::shared_ptr<RobotWorld> RobotWorldPtr;
 
+	class SimulationClock;
+	class RobotStateStore;
+
 	/**
-	 *
+	 * A world with robots, way points, goals and walls. Everything in a world, including the
+	 * SimulationClock its robots drive on, is independent of any other world so that several worlds
+	 * can run in parallel in one process. The GUI shows the default world, getRobotWorld().
 	 */
 	class RobotWorld : 	public ModelObject
 	{
 		public:
 			/**
+			 * What changed in the world since the previous notification by the world.
+			 *
+			 * Changes are coalesced: an object that is added and removed again does not show up at all,
+			 * an object that is added and moved only as added and an object that is moved and removed
+			 * only as removed.
+			 */
+			class Diff
+			{
+				public:
+					/**
+					 *
+					 */
+					void recordAdded( const Base::ObjectId& anObjectId);
+					/**
+					 *
+					 */
+					void recordRemoved( const Base::ObjectId& anObjectId);
+					/**
+					 *
+					 */
+					void recordMoved( const Base::ObjectId& anObjectId);
+					/**
+					 *
+					 */
+					bool isEmpty() const;
+					/**
+					 * @name Debug functions
+					 */
+					//@{
+					/**
+					 * Returns a 1-line description of the object
+					 */
+					std::string asString() const;
+					//@}
+
+					std::vector< Base::ObjectId > added;
+					std::vector< Base::ObjectId > removed;
+					std::vector< Base::ObjectId > moved;
+			};
+			// class Diff
+
+			/**
+			 * Begins a batch on construction and commits it on destruction:
+			 *
+			 * {
+			 *     RobotWorld::Batch batch( robotWorld);
+			 *     robotWorld.newWall( ...);
+			 *     robotWorld.deleteWall( ...);
+			 * } // One notification for both walls
+			 */
+			class Batch
+			{
+				public:
+					/**
+					 *
+					 */
+					explicit Batch( RobotWorld& aRobotWorld);
+					/**
+					 *
+					 */
+					~Batch();
+					/**
+					 *
+					 */
+					Batch( const Batch& aBatch) = delete;
+					/**
+					 *
+					 */
+					Batch& operator=( const Batch& aBatch) = delete;
+
+				private:
+					RobotWorld& robotWorld;
+			};
+			// class Batch
+
+			/**
+			 * An immutable version of the contents of the world.
 			 *
+			 * Every change to the world, or every batch of changes, publishes a new Snapshot, a copy of the
+			 * previous one with the changes applied, so a reader that holds a Snapshot sees a consistent
+			 * world for as long as it likes without any lock, while the objects in it are kept alive by the
+			 * Snapshot.
+			 */
+			class Snapshot
+			{
+				public:
+					/**
+					 * The position of an object in its vector by ObjectId
+					 */
+					typedef std::unordered_map< Base::ObjectId, std::size_t > IdIndex;
+					/**
+					 * The position of an object in its vector by name, updated by updateNameIndex when the
+					 * object is renamed. The name changes before the index does, so the name of a hit must
+					 * be checked.
+					 */
+					typedef std::unordered_multimap< std::string, std::size_t > NameIndex;
+
+					/**
+					 *
+					 */
+					Snapshot();
+
+					/**
+					 * Incremented with every published Snapshot
+					 */
+					unsigned long version;
+					std::vector< RobotPtr > robots;
+					std::vector< WayPointPtr > wayPoints;
+					std::vector< GoalPtr > goals;
+					std::vector< WallPtr > walls;
+
+					IdIndex robotIds;
+					NameIndex robotNames;
+					IdIndex wayPointIds;
+					NameIndex wayPointNames;
+					IdIndex goalIds;
+					NameIndex goalNames;
+					IdIndex wallIds;
+			};
+			// class Snapshot
+			typedef std::shared_ptr< const Snapshot > SnapshotPtr;
+
+			/**
+			 * The default world, it uses SimulationClock::getSimulationClock()
 			 */
 			static RobotWorld& getRobotWorld();
+			/**
+			 * A world with its own SimulationClock without workers: its robots are driven on the
+			 * thread that steps or runs the clock
+			 */
+			RobotWorld();
+			/**
+			 * A world whose robots drive on aSimulationClock, which must outlive the world
+			 */
+			explicit RobotWorld( SimulationClock& aSimulationClock);
+			/**
+			 *
+			 */
+			virtual ~RobotWorld();
+			/**
+			 *
+			 */
+			RobotWorld( const RobotWorld& aRobotWorld) = delete;
+			/**
+			 *
+			 */
+			RobotWorld& operator=( const RobotWorld& aRobotWorld) = delete;
+			/**
+			 *
+			 */
+			SimulationClock& getSimulationClock() const
+			{
+				return simulationClock;
+			}
+			/**
+			 * The hot state of the robots of this world, moved after every tick of its clock
+			 */
+			const std::shared_ptr< RobotStateStore >& getRobotStateStore() const
+			{
+				return robotStateStore;
+			}
+			/**
+			 * @return the current contents of the world, to be used by everyone that iterates the world
+			 * while others may change it, e.g. the planner, the sensors and the rendering
+			 */
+			SnapshotPtr getSnapshot() const;
 			/**
 			 *
 			 */
@@ -106,25 +284,70 @@ namespace Model
 			 */
 			WallPtr getWall( const Base::ObjectId& anObjectId) const;
 			/**
-			 *
+			 * A copy of the robots of the current Snapshot
 			 */
-			const std::vector< RobotPtr >& getRobots() const;
+			std::vector< RobotPtr > getRobots() const;
 			/**
-			 *
+			 * A copy of the way points of the current Snapshot
 			 */
-			const std::vector< WayPointPtr >& getWayPoints() const;
+			std::vector< WayPointPtr > getWayPoints() const;
 			/**
-			 *
+			 * A copy of the goals of the current Snapshot
 			 */
-			const std::vector< GoalPtr >& getGoals() const;
+			std::vector< GoalPtr > getGoals() const;
 			/**
-			 *
+			 * A copy of the walls of the current Snapshot
 			 */
-			const std::vector< WallPtr >& getWalls() const;
+			std::vector< WallPtr > getWalls() const;
 			/**
-			 *
+			 * A spatial index over all walls, used for ray casting by the LaserDistanceSensor.
+			 * The index is rebuilt on first use after a wall is added, deleted or moved.
+			 */
+			std::shared_ptr< const Utils::SegmentGrid > getWallGrid() const;
+			/**
+			 * Called by the setName of a robot, way point or goal of the world, the name index is kept
+			 * up to date so that an object is found by its name with a single lookup
+			 */
+			void updateNameIndex(	const Base::ObjectId& anObjectId,
+									const std::string& anOldName);
+			/**
+			 * Called by a wall of the world whose end points changed, only the wall grid of this world is rebuilt
+			 */
+			void wallMoved();
+			/**
+			 * Tells the observers that the object with anObjectId has moved
+			 */
+			void notifyMoved(	const Base::ObjectId& anObjectId,
+								bool aNotifyObservers = true);
+			/**
+			 * Defers the notifications by the world and the publication of the changes until the matching
+			 * commitBatch. Batches nest, only the outermost commit publishes and notifies. A batch is world
+			 * wide: changes by other threads during the batch are part of it. Until the commit the readers,
+			 * the one that makes the changes included, see the world as it was before the batch.
 			 */
-			void populate( int aNumberOfWalls = 2);
+			void beginBatch();
+			/**
+			 * Notifies the observers once if anything changed during the batch
+			 */
+			void commitBatch();
+			/**
+			 * @return the changes that the current (or the last) notification by the world is about
+			 */
+			Diff getLastDiff() const;
+			/**
+			 * @name Notifier functions
+			 */
+			//@{
+			/**
+			 * Deferred during a batch. Otherwise the changes since the previous notification become
+			 * the last Diff, which is published on the EventBus, before the observers are notified.
+			 */
+			virtual void notifyObservers();
+			//@}
+			/**
+			 * A robot, a goal and aNumberOfWalls walls between them
+			 */
+			void populate( int aNumberOfWalls = 1);
 			/**
 			 *
 			 */
@@ -156,24 +379,61 @@ namespace Model
 			 */
 			std::string getWallData() const;
 
-		protected:
+		private:
 			/**
-			 *
+			 * The Snapshot to change: a copy of the current Snapshot with the next version or, during a
+			 * batch, the working Snapshot of the batch. writerMutex must be held.
 			 */
-			RobotWorld();
+			std::shared_ptr< Snapshot > editSnapshot();
 			/**
+			 * Makes aSnapshot the current Snapshot, unless it is the working Snapshot of a batch, which is
+			 * published by commitBatch. writerMutex must be held.
 			 *
+			 * @param aWallsChanged true if walls were added or removed
 			 */
-			virtual ~RobotWorld();
+			void publish(	const std::shared_ptr< Snapshot >& aSnapshot,
+							bool aWallsChanged = false);
+
+			/**
+			 * Set if the world owns its clock
+			 */
+			std::unique_ptr< SimulationClock > ownSimulationClock;
+			SimulationClock& simulationClock;
+			/**
+			 * Shared with the robots, which may outlive the world
+			 */
+			std::shared_ptr< RobotStateStore > robotStateStore;
+
+			/**
+			 * Only accessed with std::atomic_load and std::atomic_store
+			 */
+			SnapshotPtr snapshot;
+			/**
+			 * Serialises the writers, which copy the current Snapshot and publish the changed copy
+			 */
+			std::mutex writerMutex;
+			/**
+			 * The Snapshot the changes of the current batch are made to, so that a batch copies the world
+			 * once instead of once per change. Guarded by writerMutex.
+			 */
+			std::shared_ptr< Snapshot > workingSnapshot;
+			bool workingWallsChanged;
+
+			/**
+			 * Incremented whenever a wall is added to, removed from or moved in the world
+			 */
+			std::atomic< unsigned long > wallRevision;
+			mutable std::shared_ptr< const Utils::SegmentGrid > wallGrid;
+			mutable unsigned long wallGridRevision;
+			mutable std::mutex wallGridMutex;
 
-		private:
 			/**
-			 * The vectors are mutable to allow for lazy instantiation
+			 * Guards batchDepth and the diffs
 			 */
-			mutable std::vector< RobotPtr > robots;
-			mutable std::vector< WayPointPtr > wayPoints;
-			mutable std::vector< GoalPtr > goals;
-			mutable std::vector< WallPtr > walls;
+			mutable std::mutex changeMutex;
+			unsigned long batchDepth;
+			Diff pendingDiff;
+			Diff lastDiff;
 	};
 } // namespace Model
 #endif // ROBOTWORLD_HPP_
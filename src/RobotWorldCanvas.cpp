@@ -1,5 +1,6 @@
 #include "RobotWorldCanvas.hpp"
 #include "Logger.hpp"
+#include "Metrics.hpp"
 #include "RectangleShape.hpp"
 #include "LineShape.hpp"
 #include "RobotShape.hpp"
@@ -13,6 +14,11 @@
 #include "RobotWorld.hpp"
 #include "NotificationEvent.hpp"
 #include <algorithm>
+#include <deque>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
 
 namespace View
 {
@@ -35,6 +41,19 @@ namespace View
 		ID_WORLD_INFO
 	};
 
+	/**
+	 *
+	 */
+	/* static */ const double RobotWorldCanvas::MinimumZoom = 0.1;
+	/**
+	 *
+	 */
+	/* static */ const double RobotWorldCanvas::MaximumZoom = 4.0;
+	/**
+	 *
+	 */
+	/* static */ const double RobotWorldCanvas::LevelOfDetailZoom = 0.5;
+
 	/**
 	 *
 	 */
@@ -52,7 +71,21 @@ namespace View
 								selectionEnabled( false),
 								menuItemEnabled( false),
 								dandEnabled( true),
-								notificationHandler( nullptr)
+								notificationHandler( nullptr),
+								refreshTimer( this),
+								framesPerSecond( 30),
+								refreshPending( false),
+								shapesChanged( false),
+								notificationPending( false),
+								mergedRefreshes( 0),
+								repaints( 0),
+								staticLayerValid( false),
+								viewOrigin( 0, 0),
+								zoom( 1.0),
+								panning( false),
+								panStartPoint( DefaultPosition),
+								panStartOrigin( DefaultPosition),
+								shapeIndexValid( true)
 	{
 		initialise();
 	}
@@ -77,7 +110,21 @@ namespace View
 									selectionEnabled( false),
 									menuItemEnabled( false),
 									dandEnabled( true),
-									notificationHandler( nullptr)
+									notificationHandler( nullptr),
+									refreshTimer( this),
+									framesPerSecond( 30),
+									refreshPending( false),
+									shapesChanged( false),
+									notificationPending( false),
+									mergedRefreshes( 0),
+									repaints( 0),
+									staticLayerValid( false),
+									viewOrigin( 0, 0),
+									zoom( 1.0),
+									panning( false),
+									panStartPoint( DefaultPosition),
+									panStartOrigin( DefaultPosition),
+									shapeIndexValid( true)
 	{
 		initialise();
 	}
@@ -86,7 +133,11 @@ namespace View
 	 */
 	RobotWorldCanvas::~RobotWorldCanvas()
 	{
+		Base::EventBus::getEventBus().unsubscribe( subscription);
+		refreshTimer.Stop();
+
 		shapes.clear();
+		shapeIndex.clear();
 
 		PopEventHandler();
 
@@ -102,7 +153,8 @@ namespace View
 	{
 		Point devicePoint;
 		/*owner->getCanvas()->*/CalcUnscrolledPosition( aScreenPoint.x, aScreenPoint.y, &devicePoint.x, &devicePoint.y);
-		return devicePoint;
+		return Point(	viewOrigin.x + static_cast< int >(std::floor( devicePoint.x / zoom)),
+						viewOrigin.y + static_cast< int >(std::floor( devicePoint.y / zoom)));
 	}
 	/**
 	 *
@@ -110,9 +162,50 @@ namespace View
 	Point RobotWorldCanvas::screenPointFor( const Point& aDevicePoint) const
 	{
 		Point screenPoint;
-		CalcScrolledPosition( aDevicePoint.x, aDevicePoint.y, &screenPoint.x, &screenPoint.y);
+		CalcScrolledPosition(	static_cast< int >(std::floor( (aDevicePoint.x - viewOrigin.x) * zoom)),
+								static_cast< int >(std::floor( (aDevicePoint.y - viewOrigin.y) * zoom)),
+								&screenPoint.x,
+								&screenPoint.y);
 		return screenPoint;
 	}
+	/**
+	 *
+	 */
+	Rect RobotWorldCanvas::screenRectFor( const Rect& aDeviceRect) const
+	{
+		// One pixel extra for the rounding
+		return Rect( screenPointFor( aDeviceRect.GetTopLeft()), screenPointFor( aDeviceRect.GetBottomRight() + Point( 1, 1))).Inflate( 1);
+	}
+	/**
+	 *
+	 */
+	void RobotWorldCanvas::setZoom(	double aZoom,
+									const Point& aScreenPoint /*= Point( 0, 0)*/)
+	{
+		Point devicePoint = devicePointFor( aScreenPoint);
+		zoom = std::min( std::max( aZoom, MinimumZoom), MaximumZoom);
+
+		Point unscrolledPoint;
+		CalcUnscrolledPosition( aScreenPoint.x, aScreenPoint.y, &unscrolledPoint.x, &unscrolledPoint.y);
+		setViewOrigin( Point(	devicePoint.x - static_cast< int >(std::floor( unscrolledPoint.x / zoom)),
+								devicePoint.y - static_cast< int >(std::floor( unscrolledPoint.y / zoom))));
+	}
+	/**
+	 *
+	 */
+	void RobotWorldCanvas::setViewOrigin( const Point& aViewOrigin)
+	{
+		viewOrigin = aViewOrigin;
+		Refresh();
+	}
+	/**
+	 *
+	 */
+	Rect RobotWorldCanvas::getVisibleArea() const
+	{
+		Size clientSize = GetClientSize();
+		return Rect( devicePointFor( Point( 0, 0)), devicePointFor( Point( clientSize.x, clientSize.y)));
+	}
 	/**
 	 *
 	 */
@@ -269,6 +362,19 @@ namespace View
 			Disconnect( wxEVT_MOTION, wxMouseEventHandler( RobotWorldCanvas::OnMouseMotion));
 		}
 	}
+	/**
+	 *
+	 */
+	void RobotWorldCanvas::enableMouseWheelHandling( bool enable /* = true */)
+	{
+		if (enable == true)
+		{
+			Connect( wxEVT_MOUSEWHEEL, wxMouseEventHandler( RobotWorldCanvas::OnMouseWheel));
+		} else
+		{
+			Disconnect( wxEVT_MOUSEWHEEL, wxMouseEventHandler( RobotWorldCanvas::OnMouseWheel));
+		}
+	}
 	/**
 	 *
 	 */
@@ -361,9 +467,10 @@ namespace View
 	 */
 	bool RobotWorldCanvas::isShapeAt( const Point& aPoint) const
 	{
-		for (ShapePtr shape : shapes)
+		Point devicePoint = devicePointFor( aPoint);
+		for (ShapePtr shape : findShapes( Rect( devicePoint, Size( 1, 1))))
 		{
-			if (shape->occupies( aPoint))
+			if (shape->occupies( devicePoint))
 			{
 				return true;
 			}
@@ -375,9 +482,10 @@ namespace View
 	 */
 	ShapePtr RobotWorldCanvas::getShapeAt( const Point& aPoint) const
 	{
-		for (ShapePtr shape : shapes)
+		Point devicePoint = devicePointFor( aPoint);
+		for (ShapePtr shape : findShapes( Rect( devicePoint, Size( 1, 1))))
 		{
-			if (shape->occupies( aPoint))
+			if (shape->occupies( devicePoint))
 			{
 				return shape;
 			}
@@ -389,9 +497,10 @@ namespace View
 	 */
 	bool RobotWorldCanvas::selectShapeAt( const Point& aPoint)
 	{
-		for (ShapePtr shape : shapes)
+		Point devicePoint = devicePointFor( aPoint);
+		for (ShapePtr shape : findShapes( Rect( devicePoint, Size( 1, 1))))
 		{
-			if (shape->occupies( aPoint))
+			if (shape->occupies( devicePoint))
 			{
 				setSelectedShape( shape);
 				return true;
@@ -425,6 +534,13 @@ namespace View
 	 */
 	void RobotWorldCanvas::handleBackGroundNotification()
 	{
+		// One posted event is enough for any number of notifications until it is handled
+		if (notificationPending.exchange( true))
+		{
+			++mergedRefreshes;
+			return;
+		}
+
 		// Posting the message will put the notification event in the applications
 		// message loop, hence making sure it is handled in the main thread.
 		NotifyEvent event( Base::EVT_NOTIFICATIONEVENT, 1000);
@@ -435,7 +551,7 @@ namespace View
 	/**
 	 *
 	 */
-	void RobotWorldCanvas::populate( int aNumberOfWalls /*= 2*/)
+	void RobotWorldCanvas::populate( int aNumberOfWalls /*= 1*/)
 	{
 		Model::RobotWorld::getRobotWorld().populate(aNumberOfWalls);
 	}
@@ -445,8 +561,46 @@ namespace View
 	void RobotWorldCanvas::unpopulate()
 	{
 		shapes.clear();
+		shapeIndex.clear();
 		Model::RobotWorld::getRobotWorld().unpopulate();
 	}
+	/**
+	 *
+	 */
+	void RobotWorldCanvas::setFramesPerSecond( unsigned short aFramesPerSecond)
+	{
+		if (aFramesPerSecond == 0)
+		{
+			throw std::invalid_argument( "The canvas needs at least 1 frame per second");
+		}
+		framesPerSecond = aFramesPerSecond;
+	}
+	/**
+	 *
+	 */
+	void RobotWorldCanvas::Refresh(	bool eraseBackground /*= true*/,
+									const Rect* rect /*= nullptr*/)
+	{
+		// Anything may have changed, e.g. a wall that was dragged or a shape that was selected
+		if (rect == nullptr)
+		{
+			staticLayerValid = false;
+		}
+		ScrolledCanvas::Refresh( eraseBackground, rect);
+	}
+	/**
+	 *
+	 */
+	std::string RobotWorldCanvas::asRefreshString() const
+	{
+		std::ostringstream os;
+		os << "Canvas: " << framesPerSecond << " fps, zoom " << zoom << ", " << repaints << " repaints, " << mergedRefreshes << " merged refreshes";
+		if (subscription)
+		{
+			os << ", events: " << subscription->getDeliveries() << " deliveries/" << subscription->getMerged() << " merged/" << subscription->getDropped() << " dropped";
+		}
+		return os.str();
+	}
 
 	/**
 	 *
@@ -460,8 +614,11 @@ namespace View
 
 		Connect( wxEVT_PAINT, wxPaintEventHandler( RobotWorldCanvas::OnPaint));
 		Connect( wxEVT_SIZE, SizeEventHandler( RobotWorldCanvas::OnSize));
+		Bind( wxEVT_TIMER, [this](TimerEvent& anEvent){ this->OnRefreshTimer(anEvent);}, refreshTimer.GetId());
 
 		SetBackgroundColour( WXSTRING( "WHITE"));
+		// handlePaint paints every pixel from the layers, erasing first would only flicker
+		SetBackgroundStyle( wxBG_STYLE_PAINT);
 		SetFocus();
 
 		enableHandlePaint();
@@ -480,6 +637,7 @@ namespace View
 		enableRightDClickHandling();
 
 		enableMouseMotionHandling();
+		enableMouseWheelHandling();
 
 		enableKeyHandling();
 
@@ -488,18 +646,91 @@ namespace View
 
 		enableItemMenuHandling();
 
-		handleNotificationsFor( Model::RobotWorld::getRobotWorld());
+		// The robots and the world publish their changes from the threads they run on, the
+		// canvas gets them merged per object on the main thread
+		subscription = Base::EventBus::getEventBus().subscribe( [this](const Base::EventBus::ChangeEvents& someChangeEvents)
+																{
+																	handleChangeEvents( someChangeEvents);
+																},
+																[this](const Base::EventBus::Delivery& aDelivery)
+																{
+																	CallAfter( aDelivery);
+																});
 	}
 	/**
 	 *
 	 */
 	void RobotWorldCanvas::render( wxDC& dc)
 	{
-		for (ShapePtr shape : shapes)
+		renderStaticLayer( dc);
+		renderDynamicLayer( dc);
+	}
+	/**
+	 *
+	 */
+	void RobotWorldCanvas::renderStaticLayer( wxDC& dc)
+	{
+		bool simplified = isSimplified();
+		std::vector< WallShapePtr > walls;
+
+		for (ShapePtr shape : findShapes( getVisibleArea()))
+		{
+			if (std::dynamic_pointer_cast< RobotShape >( shape))
+			{
+				continue;
+			}
+			if (simplified)
+			{
+				WallShapePtr wall = std::dynamic_pointer_cast< WallShape >( shape);
+				if (wall)
+				{
+					walls.push_back( wall);
+				} else if (shape->getModelObject())
+				{
+					// Not the end points of the walls or the lines drawn by the user
+					shape->drawSimplified( dc);
+				}
+			} else
+			{
+				shape->draw( dc);
+			}
+			// The first draw may have grown the shape to fit its title
+			shapeIndex.update( shape, shape->getBoundingBox());
+		}
+
+		if (simplified)
+		{
+			drawWallPolylines( dc, walls);
+		}
+	}
+	/**
+	 *
+	 */
+	void RobotWorldCanvas::renderDynamicLayer( wxDC& dc)
+	{
+		bool simplified = isSimplified();
+
+		// Only the robots in the part that is drawn again
+		wxCoord left;
+		wxCoord top;
+		wxCoord width;
+		wxCoord height;
+		dc.GetClippingBox( &left, &top, &width, &height);
+		Rect area = (width > 0 && height > 0) ? Rect( left, top, width, height) : getVisibleArea();
+
+		for (ShapePtr shape : findShapes( area))
 		{
-			//		Logger::log("Drawing shape: " + shape->asString());
-			shape->draw( dc);
-			//		Logger::log("Done drawing shape: " + shape->asString());
+			RobotShapePtr robotShape = std::dynamic_pointer_cast< RobotShape >( shape);
+			if (robotShape)
+			{
+				if (simplified)
+				{
+					robotShape->drawSimplified( dc);
+				} else
+				{
+					robotShape->draw( dc);
+				}
+			}
 		}
 		if (startActionShape != nullptr && actionStatus == DRAWING)
 		{
@@ -507,13 +738,101 @@ namespace View
 			dc.DrawLine( startActionShape->getCentre().x, startActionShape->getCentre().y, endActionPoint.x, endActionPoint.y);
 		}
 	}
+	/**
+	 *
+	 */
+	void RobotWorldCanvas::requestRefresh( bool aShapesChanged /*= false*/)
+	{
+		shapesChanged = shapesChanged || aShapesChanged;
+		if (refreshPending)
+		{
+			++mergedRefreshes;
+			return;
+		}
+		refreshPending = true;
+
+		// After a quiet period the first request is painted right away, the ones after it wait for the next frame
+		long frameInterval = 1000 / framesPerSecond;
+		long sinceLastRepaint = std::chrono::duration_cast< std::chrono::milliseconds >( std::chrono::steady_clock::now() - lastRepaint).count();
+		refreshTimer.StartOnce( static_cast< int >(std::max( 1L, frameInterval - sinceLastRepaint)));
+	}
+	/**
+	 *
+	 */
+	void RobotWorldCanvas::updateShapes()
+	{
+		// One consistent version of the world, whatever the other threads do in the meantime
+		Model::RobotWorld::SnapshotPtr snapshot = Model::RobotWorld::getRobotWorld().getSnapshot();
+
+		remove<Model::Robot,View::RobotShape>( snapshot->robots);
+		add<Model::Robot,View::RobotShape>( snapshot->robots);
+
+		remove<Model::WayPoint,View::WayPointShape>( snapshot->wayPoints);
+		add<Model::WayPoint,View::WayPointShape>( snapshot->wayPoints);
+
+		remove<Model::Goal,View::GoalShape>( snapshot->goals);
+		add<Model::Goal,View::GoalShape>( snapshot->goals);
+
+		remove<Model::Wall,View::WallShape>( snapshot->walls);
+		add<Model::Wall,View::WallShape>( snapshot->walls);
+	}
 	/**
 	 *
 	 */
 	void RobotWorldCanvas::handlePaint( PaintEvent& UNUSEDPARAM(event))
 	{
 		wxPaintDC dc( this);
-		render( dc);
+
+		Size clientSize = GetClientSize();
+		if (clientSize.x <= 0 || clientSize.y <= 0)
+		{
+			return;
+		}
+
+		static Base::Histogram& frameTime = Base::Metrics::getMetrics().getHistogram( "robotworld_canvas_frame_seconds", "The time it took to paint the canvas", 1e-6);
+		static Base::Counter& staticRenders = Base::Metrics::getMetrics().getCounter( "robotworld_canvas_static_renders_total", "The times the walls, goals and waypoints were drawn again");
+		static Base::Gauge& zoomGauge = Base::Metrics::getMetrics().getGauge( "robotworld_canvas_zoom", "The zoom factor of the canvas");
+		Base::ScopedTimer timer( frameTime);
+		zoomGauge.set( zoom);
+
+		if (!backBuffer.IsOk() || backBuffer.GetSize() != clientSize)
+		{
+			backBuffer.Create( clientSize);
+			staticLayer.Create( clientSize);
+			staticLayerValid = false;
+		}
+
+		MemoryDC staticDc( staticLayer);
+		if (!staticLayerValid)
+		{
+			staticDc.SetBackground( Brush( GetBackgroundColour()));
+			staticDc.Clear();
+			applyViewport( staticDc);
+			renderStaticLayer( staticDc);
+			staticRenders.add();
+			staticDc.SetUserScale( 1.0, 1.0);
+			staticDc.SetLogicalOrigin( 0, 0);
+			staticLayerValid = true;
+		}
+
+		// Only within the dirty rectangles: the static layer, the robots on top of it and the result to the screen
+		Region updateRegion = GetUpdateRegion();
+		MemoryDC bufferDc( backBuffer);
+		bufferDc.SetDeviceClippingRegion( updateRegion);
+		for (RegionIterator i( updateRegion); i; ++i)
+		{
+			Rect rect = i.GetRect();
+			bufferDc.Blit( rect.GetTopLeft(), rect.GetSize(), &staticDc, rect.GetTopLeft());
+		}
+		applyViewport( bufferDc);
+		renderDynamicLayer( bufferDc);
+		bufferDc.SetUserScale( 1.0, 1.0);
+		bufferDc.SetLogicalOrigin( 0, 0);
+		for (RegionIterator i( updateRegion); i; ++i)
+		{
+			Rect rect = i.GetRect();
+			dc.Blit( rect.GetTopLeft(), rect.GetSize(), &bufferDc, rect.GetTopLeft());
+		}
 	}
 	/**
 	 *
@@ -532,7 +851,7 @@ namespace View
 	{
 		Point screenPoint = event.GetPosition();
 
-		startActionPoint = screenPoint;
+		startActionPoint = devicePointFor( screenPoint);
 		endActionPoint = startActionPoint;
 		actionStatus = IDLE;
 
@@ -543,7 +862,7 @@ namespace View
 			WallShapePtr wall = std::dynamic_pointer_cast<WallShape>( shape);
 			if (wall)
 			{
-				RectangleShapePtr wallEndPoint = wall->hasEndPointAt( screenPoint);
+				RectangleShapePtr wallEndPoint = wall->hasEndPointAt( startActionPoint);
 				if (wallEndPoint)
 				{
 					setSelectedShape( wallEndPoint);
@@ -593,7 +912,7 @@ namespace View
 				if (startRectangleShape && endRectangeShape)
 				{
 					ShapePtr lineShape( new LineShape( startRectangleShape, endRectangeShape));
-					shapes.push_back( lineShape);
+					appendShape( lineShape);
 				}
 				break;
 			}
@@ -646,19 +965,22 @@ namespace View
 	/**
 	 *
 	 */
-	void RobotWorldCanvas::handleMiddleDown( MouseEvent& UNUSEDPARAM(event))
+	void RobotWorldCanvas::handleMiddleDown( MouseEvent& event)
 	{
 		// We must set the focus or any keyboard events will get lost
-		//SetFocus();
+		SetFocus();
 
-		//Point devicePoint = devicePointFor(event.GetPosition());
+		// Dragging with the middle button pans the view
+		panning = true;
+		panStartPoint = event.GetPosition();
+		panStartOrigin = viewOrigin;
 	}
 	/**
 	 *
 	 */
 	void RobotWorldCanvas::handleMiddleUp( MouseEvent& UNUSEDPARAM(event))
 	{
-		Application::Logger::log( __PRETTY_FUNCTION__);
+		panning = false;
 	}
 	/**
 	 *
@@ -721,11 +1043,19 @@ namespace View
 		{
 			return;
 		}
+		if (panning && event.Dragging() == true && event.MiddleIsDown())
+		{
+			Point offset = event.GetPosition() - panStartPoint;
+			setViewOrigin( Point(	panStartOrigin.x - static_cast< int >(offset.x / zoom),
+									panStartOrigin.y - static_cast< int >(offset.y / zoom)));
+			return;
+		}
 		if (event.Moving() == false && event.Dragging() == true && startActionShape != nullptr)
 		{
+			Point devicePoint = devicePointFor( event.GetPosition());
 			int tolerance = 2;
-			int dx = std::abs( event.GetPosition().x - startActionPoint.x);
-			int dy = std::abs( event.GetPosition().y - startActionPoint.y);
+			int dx = std::abs( devicePoint.x - startActionPoint.x);
+			int dy = std::abs( devicePoint.y - startActionPoint.y);
 			if (dx <= tolerance && dy <= tolerance)
 			{
 				return;
@@ -758,20 +1088,21 @@ namespace View
 				}
 				case DRAGGING:
 				{
-					startActionShape->setCentre( event.GetPosition() + actionOffset);
-					endActionPoint = event.GetPosition();
+					startActionShape->setCentre( devicePoint + actionOffset);
+					endActionPoint = devicePoint;
+					updateShapeIndex( startActionShape);
 					Refresh();
 					break;
 				}
 				case DRAWING:
 				{
-					endActionPoint = event.GetPosition();
+					endActionPoint = devicePoint;
 					Refresh();
 					break;
 				}
 				default:
 				{
-					Application::Logger::log( "Just moving, nothing to see...");
+					LOG_TRACE( "Just moving, nothing to see...");
 				}
 			}
 		}
@@ -781,7 +1112,7 @@ namespace View
 	 */
 	void RobotWorldCanvas::handleKey( KeyEvent& event)
 	{
-		Application::Logger::log( __PRETTY_FUNCTION__);
+		LOG_TRACE( __PRETTY_FUNCTION__);
 
 		switch (event.GetKeyCode())
 		{
@@ -790,6 +1121,45 @@ namespace View
 			{
 				break;
 			}
+			case '+':
+			case '=':
+			case WXK_NUMPAD_ADD:
+			{
+				setZoom( zoom * 1.25, ScreenToClient( wxGetMousePosition()));
+				break;
+			}
+			case '-':
+			case WXK_NUMPAD_SUBTRACT:
+			{
+				setZoom( zoom / 1.25, ScreenToClient( wxGetMousePosition()));
+				break;
+			}
+			case '0':
+			{
+				zoom = 1.0;
+				setViewOrigin( Point( 0, 0));
+				break;
+			}
+			case WXK_LEFT:
+			{
+				setViewOrigin( viewOrigin - Point( static_cast< int >(50 / zoom), 0));
+				break;
+			}
+			case WXK_RIGHT:
+			{
+				setViewOrigin( viewOrigin + Point( static_cast< int >(50 / zoom), 0));
+				break;
+			}
+			case WXK_UP:
+			{
+				setViewOrigin( viewOrigin - Point( 0, static_cast< int >(50 / zoom)));
+				break;
+			}
+			case WXK_DOWN:
+			{
+				setViewOrigin( viewOrigin + Point( 0, static_cast< int >(50 / zoom)));
+				break;
+			}
 			case WXK_ESCAPE:
 			{
 				switch (actionStatus)
@@ -822,6 +1192,19 @@ namespace View
 			}
 		}
 	}
+	/**
+	 *
+	 */
+	void RobotWorldCanvas::handleMouseWheel( MouseEvent& event)
+	{
+		if (event.GetWheelRotation() > 0)
+		{
+			setZoom( zoom * 1.25, event.GetPosition());
+		} else if (event.GetWheelRotation() < 0)
+		{
+			setZoom( zoom / 1.25, event.GetPosition());
+		}
+	}
 	/**
 	 *
 	 */
@@ -851,7 +1234,8 @@ namespace View
 		RectangleShapePtr rectangleShape = std::dynamic_pointer_cast<RectangleShape>(aShape);
 		if (rectangleShape)
 		{
-			for (ShapePtr shape : shapes)
+			// The bounding box of a wall contains those of its end points
+			for (ShapePtr shape : findShapes( rectangleShape->getBoundingBox()))
 			{
 				WallShapePtr wall = std::dynamic_pointer_cast<WallShape>( shape);
 				if (wall)
@@ -871,7 +1255,7 @@ namespace View
 	 */
 	void RobotWorldCanvas::handleAddRobot( CommandEvent& UNUSEDPARAM(event))
 	{
-		RobotShapePtr robot( new RobotShape( Model::RobotWorld::getRobotWorld().newRobot( "Robot", popupPoint)));
+		RobotShapePtr robot( new RobotShape( Model::RobotWorld::getRobotWorld().newRobot( "Robot", devicePointFor( popupPoint))));
 		addShape(robot);
 		Refresh();
 	}
@@ -910,7 +1294,7 @@ namespace View
 	 */
 	void RobotWorldCanvas::handleAddWayPoint( CommandEvent& UNUSEDPARAM(event))
 	{
-		WayPointShapePtr wayPoint( new WayPointShape( Model::RobotWorld::getRobotWorld().newWayPoint( "Joost", popupPoint)));
+		WayPointShapePtr wayPoint( new WayPointShape( Model::RobotWorld::getRobotWorld().newWayPoint( "Joost", devicePointFor( popupPoint))));
 		addShape(wayPoint);
 		Refresh();
 	}
@@ -949,7 +1333,7 @@ namespace View
 	 */
 	void RobotWorldCanvas::handleAddGoal( CommandEvent& UNUSEDPARAM(event))
 	{
-		GoalShapePtr goal( new GoalShape( Model::RobotWorld::getRobotWorld().newGoal( "Goal", popupPoint)));
+		GoalShapePtr goal( new GoalShape( Model::RobotWorld::getRobotWorld().newGoal( "Goal", devicePointFor( popupPoint))));
 		addShape(goal);
 		Refresh();
 	}
@@ -988,16 +1372,16 @@ namespace View
 	 */
 	void RobotWorldCanvas::handleAddWall( CommandEvent& UNUSEDPARAM(event))
 	{
-		RectangleShapePtr start( new RectangleShape( popupPoint));
-		RectangleShapePtr end( new RectangleShape( popupPoint + Point( 50, 50)));
+		RectangleShapePtr start( new RectangleShape( devicePointFor( popupPoint)));
+		RectangleShapePtr end( new RectangleShape( devicePointFor( popupPoint) + Point( 50, 50)));
 
 		ShapePtr wall( new WallShape( Model::RobotWorld::getRobotWorld().newWall( start->getCentre(), end->getCentre(),false),
 									  start,
 									  end));
 
-		shapes.push_back( wall);
-		shapes.push_back( start);
-		shapes.push_back( end);
+		appendShape( wall);
+		appendShape( start);
+		appendShape( end);
 
 		Refresh();
 	}
@@ -1035,19 +1419,67 @@ namespace View
 	 */
 	void RobotWorldCanvas::handleNotification( NotifyEvent& UNUSEDPARAM(aNotifyEvent))
 	{
-		remove<Model::Robot,View::RobotShape>( Model::RobotWorld::getRobotWorld().getRobots());
-		add<Model::Robot,View::RobotShape>( Model::RobotWorld::getRobotWorld().getRobots());
+		// Notifications from now on post a new event
+		notificationPending = false;
+		requestRefresh( true);
+	}
+	/**
+	 *
+	 */
+	void RobotWorldCanvas::handleChangeEvents( const Base::EventBus::ChangeEvents& someChangeEvents)
+	{
+		bool objectsChanged = false;
+		std::unordered_map< Base::ObjectId, unsigned > changedObjects;
+		for (const Base::ChangeEvent& changeEvent : someChangeEvents)
+		{
+			if (changeEvent.objectId.isNull() || changeEvent.has( Base::ChangeEvent::Added | Base::ChangeEvent::Removed))
+			{
+				objectsChanged = true;
+			} else
+			{
+				changedObjects[changeEvent.objectId] |= changeEvent.fields;
+			}
+		}
 
-		remove<Model::WayPoint,View::WayPointShape>( Model::RobotWorld::getRobotWorld().getWayPoints());
-		add<Model::WayPoint,View::WayPointShape>( Model::RobotWorld::getRobotWorld().getWayPoints());
+		// One pass over the shapes, however many objects changed
+		if (!changedObjects.empty())
+		{
+			const unsigned movementFields = Base::ChangeEvent::Position | Base::ChangeEvent::Front | Base::ChangeEvent::Speed;
+			for (ShapePtr shape : shapes)
+			{
+				if (!shape->getModelObject())
+				{
+					continue;
+				}
+				auto changedObject = changedObjects.find( shape->getModelObject()->getObjectId());
+				if (changedObject == changedObjects.end())
+				{
+					continue;
+				}
 
-		remove<Model::Goal,View::GoalShape>( Model::RobotWorld::getRobotWorld().getGoals());
-		add<Model::Goal,View::GoalShape>( Model::RobotWorld::getRobotWorld().getGoals());
+				RobotShapePtr robotShape = std::dynamic_pointer_cast< RobotShape >( shape);
+				if (robotShape && (changedObject->second & ~movementFields) == 0)
+				{
+					// Only the rectangles around the robot need to be drawn again
+					if (changedObject->second & Base::ChangeEvent::Position)
+					{
+						robotShape->setCentre( robotShape->getRobot()->getPosition());
+					}
+					if (changedObject->second & (Base::ChangeEvent::Position | Base::ChangeEvent::Front))
+					{
+						movedRobotShapes.insert( robotShape);
+					}
+				} else
+				{
+					// A static shape, or a path or size of a robot that may be anywhere on the canvas
+					staticLayerValid = false;
+				}
 
-		remove<Model::Wall,View::WallShape>( Model::RobotWorld::getRobotWorld().getWalls());
-		add<Model::Wall,View::WallShape>( Model::RobotWorld::getRobotWorld().getWalls());
+				updateShapeIndex( shape);
+			}
+		}
 
-		Refresh();
+		requestRefresh( objectsChanged);
 	}
 	/**
 	 *
@@ -1136,7 +1568,7 @@ namespace View
 	{
 		aRobotShape->setRobotWorldCanvas(this);
 		aRobotShape->handleNotificationsFor(*aRobotShape->getRobot());
-		shapes.push_back( std::dynamic_pointer_cast< Shape >( aRobotShape));
+		appendShape( std::dynamic_pointer_cast< Shape >( aRobotShape));
 	}
 	/**
 	 *
@@ -1144,7 +1576,7 @@ namespace View
 	void RobotWorldCanvas::addShape( GoalShapePtr aGoalShape)
 	{
 		aGoalShape->handleNotificationsFor(*aGoalShape->getGoal());
-		shapes.push_back( std::dynamic_pointer_cast< Shape >( aGoalShape));
+		appendShape( std::dynamic_pointer_cast< Shape >( aGoalShape));
 	}
 	/**
 	 *
@@ -1152,7 +1584,7 @@ namespace View
 	void RobotWorldCanvas::addShape( WayPointShapePtr aWayPointShape)
 	{
 		aWayPointShape->handleNotificationsFor(*aWayPointShape->getWayPoint());
-		shapes.push_back( std::dynamic_pointer_cast< Shape >( aWayPointShape));
+		appendShape( std::dynamic_pointer_cast< Shape >( aWayPointShape));
 	}
 	/**
 	 *
@@ -1167,9 +1599,9 @@ namespace View
 		aWallShape->setNode1(start);
 		aWallShape->setNode2(end);
 
-		shapes.push_back( start);
-		shapes.push_back( end);
-		shapes.push_back( aWallShape);
+		appendShape( start);
+		appendShape( end);
+		appendShape( aWallShape);
 	}
 	/**
 	 *
@@ -1225,6 +1657,133 @@ namespace View
 									{
 										return aShape->getObjectId() == s->getObjectId();
 									}));
+		shapeIndex.remove( aShape);
+	}
+	/**
+	 *
+	 */
+	void RobotWorldCanvas::appendShape( ShapePtr aShape)
+	{
+		shapes.push_back( aShape);
+		if (shapeIndexValid)
+		{
+			shapeIndex.insert( aShape, aShape->getBoundingBox());
+		}
+	}
+	/**
+	 *
+	 */
+	std::vector< ShapePtr > RobotWorldCanvas::findShapes( const Rect& anArea) const
+	{
+		if (!shapeIndexValid)
+		{
+			shapeIndex.clear();
+			for (ShapePtr shape : shapes)
+			{
+				shapeIndex.insert( shape, shape->getBoundingBox());
+			}
+			shapeIndexValid = true;
+		}
+		return shapeIndex.find( anArea);
+	}
+	/**
+	 *
+	 */
+	void RobotWorldCanvas::updateShapeIndex( ShapePtr aShape)
+	{
+		if (!shapeIndexValid)
+		{
+			// Rebuilt as a whole by the next findShapes
+			return;
+		}
+
+		WallShapePtr wall = std::dynamic_pointer_cast< WallShape >( aShape);
+		if (wall)
+		{
+			shapeIndex.update( wall->getNode1(), wall->getNode1()->getBoundingBox());
+			shapeIndex.update( wall->getNode2(), wall->getNode2()->getBoundingBox());
+		}
+
+		if (std::dynamic_pointer_cast< RectangleShape >( aShape))
+		{
+			// A line ends in the centre of its end points, so the lines that ended in the previous
+			// position of aShape are found within its previous bounding box
+			for (ShapePtr shape : shapeIndex.find( shapeIndex.getBoundingBox( aShape)))
+			{
+				std::shared_ptr< LineShape > line = std::dynamic_pointer_cast< LineShape >( shape);
+				if (line && (line->getNode1() == aShape || line->getNode2() == aShape))
+				{
+					shapeIndex.update( line, line->getBoundingBox());
+				}
+			}
+		}
+
+		shapeIndex.update( aShape, aShape->getBoundingBox());
+	}
+	/**
+	 *
+	 */
+	void RobotWorldCanvas::drawWallPolylines(	wxDC& dc,
+												const std::vector< WallShapePtr >& someWalls)
+	{
+		// The walls by the points they end in
+		std::map< std::pair< int, int >, std::vector< std::size_t > > wallsAtPoint;
+		for (std::size_t i = 0; i < someWalls.size(); ++i)
+		{
+			Point begin = someWalls[i]->getBegin();
+			Point end = someWalls[i]->getEnd();
+			wallsAtPoint[std::make_pair( begin.x, begin.y)].push_back( i);
+			wallsAtPoint[std::make_pair( end.x, end.y)].push_back( i);
+		}
+
+		std::vector< bool > used( someWalls.size(), false);
+		// Follows the unused walls from aPoint on, adding their far ends to the polyline
+		auto follow = [&](Point aPoint, bool atFront, std::deque< Point >& aPolyline)
+		{
+			for (;;)
+			{
+				std::vector< std::size_t >& walls = wallsAtPoint[std::make_pair( aPoint.x, aPoint.y)];
+				auto next = std::find_if( walls.begin(), walls.end(), [&used](std::size_t aWall){ return !used[aWall];});
+				if (next == walls.end())
+				{
+					return;
+				}
+				used[*next] = true;
+				aPoint = someWalls[*next]->getBegin() == aPoint ? someWalls[*next]->getEnd() : someWalls[*next]->getBegin();
+				if (atFront)
+				{
+					aPolyline.push_front( aPoint);
+				} else
+				{
+					aPolyline.push_back( aPoint);
+				}
+			}
+		};
+
+		dc.SetPen( wxPen( WXSTRING( "BLACK"), 1, wxSOLID));
+		for (std::size_t i = 0; i < someWalls.size(); ++i)
+		{
+			if (used[i])
+			{
+				continue;
+			}
+			used[i] = true;
+
+			std::deque< Point > polyline = { someWalls[i]->getBegin(), someWalls[i]->getEnd() };
+			follow( polyline.back(), false, polyline);
+			follow( polyline.front(), true, polyline);
+
+			std::vector< Point > points( polyline.begin(), polyline.end());
+			dc.DrawLines( static_cast< int >(points.size()), points.data());
+		}
+	}
+	/**
+	 *
+	 */
+	void RobotWorldCanvas::applyViewport( wxDC& dc) const
+	{
+		dc.SetUserScale( zoom, zoom);
+		dc.SetLogicalOrigin( viewOrigin.x, viewOrigin.y);
 	}
 	/**
 	 *
@@ -1310,6 +1869,13 @@ namespace View
 	{
 		handleMouseMotion( event);
 	}
+	/**
+	 *
+	 */
+	void RobotWorldCanvas::OnMouseWheel( MouseEvent& event)
+	{
+		handleMouseWheel( event);
+	}
 	/**
 	 *
 	 */
@@ -1430,4 +1996,32 @@ namespace View
 	{
 		handleNotification(aNotifyEvent);
 	}
+	/**
+	 *
+	 */
+	void RobotWorldCanvas::OnRefreshTimer( TimerEvent& UNUSEDPARAM(event))
+	{
+		refreshPending = false;
+		lastRepaint = std::chrono::steady_clock::now();
+		++repaints;
+
+		if (shapesChanged || !staticLayerValid)
+		{
+			if (shapesChanged)
+			{
+				shapesChanged = false;
+				updateShapes();
+			}
+			movedRobotShapes.clear();
+			Refresh();
+			return;
+		}
+
+		// Where the robots were and where they are now
+		for (const RobotShapePtr& robotShape : movedRobotShapes)
+		{
+			RefreshRect( screenRectFor( robotShape->getDrawnBodyBoundingBox().Union( robotShape->getBodyBoundingBox())), false);
+		}
+		movedRobotShapes.clear();
+	}
 } // namespace View
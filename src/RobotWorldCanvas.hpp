@@ -2,12 +2,18 @@
 #define ROBOTWORLDCANVAS_HPP_
 
 #include "Config.hpp"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <unordered_set>
 #include <vector>
 #include "Widgets.hpp"
+#include "EventBus.hpp"
 #include "ViewObject.hpp"
 #include "NotificationHandler.hpp"
 #include "RobotWorld.hpp"
 #include "Shape.hpp"
+#include "ShapeIndex.hpp"
 #include "Size.hpp"
 
 namespace View
@@ -47,7 +53,7 @@ namespace View
 			 * The canvas is partially displayed in a scrolling window. Hence, the user viewable part of this window
 			 * is probably just a part of this window. This function takes a point in the (visible) scrolling window coordinates
 			 * and translates it to this canvas windows coordinates. It takes into account the number of lines and number of
-			 * pixels between lines.
+			 * pixels between lines, and the zoom and pan of the viewport.
 			 */
 			Point devicePointFor( const Point& aScreenPoint) const;
 			/**
@@ -56,6 +62,58 @@ namespace View
 			 * @see devicePointFor( const Point&)
 			 */
 			Point screenPointFor( const Point& aDevicePoint) const;
+			/**
+			 * Translates a rectangle in canvas coordinates to one in scrolling window coordinates that contains it
+			 */
+			Rect screenRectFor( const Rect& aDeviceRect) const;
+			/**
+			 * @name Viewport functions
+			 *
+			 * The viewport shows the canvas from viewOrigin, the canvas point in the top left corner of
+			 * the window, at zoom screen pixels per canvas pixel. Below LevelOfDetailZoom the shapes are
+			 * drawn simplified: robots as dots, walls as merged polylines and no paths.
+			 */
+			//@{
+			/**
+			 *
+			 */
+			double getZoom() const
+			{
+				return zoom;
+			}
+			/**
+			 * Zooms around aScreenPoint, i.e. the canvas point under it stays where it is.
+			 * aZoom is limited to [MinimumZoom, MaximumZoom].
+			 */
+			void setZoom(	double aZoom,
+							const Point& aScreenPoint = Point( 0, 0));
+			/**
+			 *
+			 */
+			Point getViewOrigin() const
+			{
+				return viewOrigin;
+			}
+			/**
+			 *
+			 */
+			void setViewOrigin( const Point& aViewOrigin);
+			/**
+			 * The part of the canvas that is visible in the window, in canvas coordinates
+			 */
+			Rect getVisibleArea() const;
+			/**
+			 *
+			 */
+			bool isSimplified() const
+			{
+				return zoom < LevelOfDetailZoom;
+			}
+
+			static const double MinimumZoom;
+			static const double MaximumZoom;
+			static const double LevelOfDetailZoom;
+			//@}
 			/**
 			 * @name Event handling enabling functions
 			 *
@@ -77,6 +135,7 @@ namespace View
 			virtual void enableRightDClickHandling( bool enable = true);
 
 			virtual void enableMouseMotionHandling( bool enable = true);
+			virtual void enableMouseWheelHandling( bool enable = true);
 
 			virtual void enableKeyHandling( bool enable = true);
 
@@ -108,6 +167,7 @@ namespace View
 			virtual void setSelectedShape( ShapePtr aSelectedShape);
 
 			/**
+			 * Only the shapes the shape index finds at aPoint are asked whether they occupy it.
 			 *
 			 * @param 	aPoint
 			 * @return 	True if any Shape returns true for Shape.ocuppies(aPoint), false otherwise.
@@ -164,11 +224,54 @@ namespace View
 			/**
 			 * Asks the world to populates itself with a robot, a goal and the given number of walls
 			 */
-			void populate( int aNumberOfWalls = 2);
+			void populate( int aNumberOfWalls = 1);
 			/**
 			 * Removes everything from the world
 			 */
 			void unpopulate();
+			/**
+			 * @name Refresh rate functions
+			 *
+			 * Notifications of the model only mark the canvas as dirty. A single timer repaints it
+			 * at most framesPerSecond times per second, however many notifications came in between.
+			 */
+			//@{
+			/**
+			 *
+			 */
+			unsigned short getFramesPerSecond() const
+			{
+				return framesPerSecond;
+			}
+			/**
+			 * @throw std::invalid_argument if aFramesPerSecond is 0
+			 */
+			void setFramesPerSecond( unsigned short aFramesPerSecond);
+			/**
+			 * The number of repaints requested while one was pending already, i.e. merged into that one
+			 */
+			unsigned long getMergedRefreshes() const
+			{
+				return mergedRefreshes;
+			}
+			/**
+			 * The number of repaints done by the timer
+			 */
+			unsigned long getRepaints() const
+			{
+				return repaints;
+			}
+			/**
+			 * Returns a 1-line description of the refresh statistics
+			 */
+			std::string asRefreshString() const;
+			//@}
+			/**
+			 * Refreshing the whole canvas redraws the static layer as well, RefreshRect only
+			 * redraws the robots within the rectangle on top of the cached static layer
+			 */
+			virtual void Refresh(	bool eraseBackground = true,
+									const Rect* rect = nullptr);
 		protected:
 			/**
 			 * Common initialise function
@@ -178,6 +281,23 @@ namespace View
 			 *
 			 */
 			void render( wxDC& dc);
+			/**
+			 * Draws the shapes that do not move by themselves: walls, goals and way points
+			 */
+			void renderStaticLayer( wxDC& dc);
+			/**
+			 * Draws the robots and the line that is being drawn by the user
+			 */
+			void renderDynamicLayer( wxDC& dc);
+			/**
+			 * Marks the canvas as dirty and starts the refresh timer if it is not running yet.
+			 * If aShapesChanged the shapes are matched with the world first.
+			 */
+			void requestRefresh( bool aShapesChanged = false);
+			/**
+			 * Adds and removes the shapes for the objects that were added to and removed from the world
+			 */
+			void updateShapes();
 			/**
 			 * @name Event handling functions
 			 *
@@ -200,6 +320,7 @@ namespace View
 			virtual void handleRightDClick( MouseEvent& event);
 
 			virtual void handleMouseMotion( MouseEvent& event);
+			virtual void handleMouseWheel( MouseEvent& event);
 
 			virtual void handleKey( KeyEvent& event);
 
@@ -225,6 +346,10 @@ namespace View
 			virtual void handleShapeInfo( CommandEvent& event);
 
 			virtual void handleNotification( NotifyEvent& aNotifyEvent);
+			/**
+			 * The merged changes of the model since the previous call, on the main thread
+			 */
+			virtual void handleChangeEvents( const Base::EventBus::ChangeEvents& someChangeEvents);
 
 			//@}
 			virtual void handleActivation( ShapePtr aShape);
@@ -274,6 +399,28 @@ namespace View
 			 *
 			 */
 			void removeGenericShape( ShapePtr aShape);
+			/**
+			 * Adds aShape to the shapes and to the shape index
+			 */
+			void appendShape( ShapePtr aShape);
+			/**
+			 * The shapes whose bounding box intersects anArea, in the order they are drawn
+			 */
+			std::vector< ShapePtr > findShapes( const Rect& anArea) const;
+			/**
+			 * Moves aShape in the shape index to its current bounding box, together with the shapes
+			 * that move with it: the end points of a wall, or the wall of an end point
+			 */
+			void updateShapeIndex( ShapePtr aShape);
+			/**
+			 * Joins the walls that share an end point into polylines and draws each of them with a single call
+			 */
+			void drawWallPolylines(	wxDC& dc,
+									const std::vector< WallShapePtr >& someWalls);
+			/**
+			 * Sets the scale and origin of dc to those of the viewport
+			 */
+			void applyViewport( wxDC& dc) const;
 		private:
 			/**
 			 * @name Event handlers
@@ -296,6 +443,7 @@ namespace View
 			void OnRightDClick( MouseEvent& event);
 
 			void OnMouseMotion( MouseEvent& event);
+			void OnMouseWheel( MouseEvent& event);
 
 			void OnKeyDown( KeyEvent& event);
 			void OnCharDown( KeyEvent& event);
@@ -321,6 +469,8 @@ namespace View
 			void OnWorldInfo( CommandEvent& event);
 
 			void OnNotificationEvent( NotifyEvent& aNotifyEvent);
+
+			void OnRefreshTimer( TimerEvent& event);
 			//@}
 
 			std::vector< ShapePtr > shapes;
@@ -354,6 +504,58 @@ namespace View
 			bool dandEnabled;
 
 			Base::NotificationHandler< std::function< void( NotifyEvent&) > > * notificationHandler;
+			/**
+			 * The subscription on the EventBus, delivered with CallAfter
+			 */
+			Base::EventBus::SubscriptionPtr subscription;
+
+			/**
+			 * The only one that repaints the canvas on a notification
+			 */
+			Timer refreshTimer;
+			unsigned short framesPerSecond;
+			std::chrono::steady_clock::time_point lastRepaint;
+			/**
+			 * Only accessed on the main thread
+			 */
+			bool refreshPending;
+			bool shapesChanged;
+			/**
+			 * Set by handleBackGroundNotification until the posted event is handled
+			 */
+			std::atomic< bool > notificationPending;
+			std::atomic< unsigned long > mergedRefreshes;
+			unsigned long repaints;
+
+			/**
+			 * The static shapes, drawn again only after a full refresh or a resize
+			 */
+			Bitmap staticLayer;
+			bool staticLayerValid;
+			/**
+			 * The static layer with the robots on top, only the dirty rectangles are drawn
+			 * again and copied to the screen
+			 */
+			Bitmap backBuffer;
+			/**
+			 * The robots that moved since the previous frame
+			 */
+			std::unordered_set< RobotShapePtr > movedRobotShapes;
+
+			Point viewOrigin;
+			double zoom;
+			/**
+			 * Panning with the middle mouse button: where it went down and the viewOrigin at that moment
+			 */
+			bool panning;
+			Point panStartPoint;
+			Point panStartOrigin;
+			/**
+			 * The bounding boxes of the shapes, for culling and hit-testing. Rebuilt if not valid after
+			 * an edit the canvas can not follow shape by shape. Mutable because the hit tests are const.
+			 */
+			mutable ShapeIndex shapeIndex;
+			mutable bool shapeIndexValid;
 
 			/**
 			 * This function removes all Shapes that look at a ModelObject that is not longer in RobotWorld
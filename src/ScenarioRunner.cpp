@@ -0,0 +1,253 @@
+#include "ScenarioRunner.hpp"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <tuple>
+#include "Goal.hpp"
+#include "Robot.hpp"
+#include "RobotWorld.hpp"
+#include "SimulationClock.hpp"
+#include "WorkStealingPool.hpp"
+
+namespace Model
+{
+	/**
+	 *
+	 */
+	std::vector< Scenario > ParameterGrid::getScenarios() const
+	{
+		std::vector< Scenario > scenarios;
+		for (float speed : speeds)
+		{
+			for (unsigned short safetyMargin : safetyMargins)
+			{
+				for (const Size& footprint : footprints)
+				{
+					for (unsigned long seed = firstSeed; seed <= lastSeed; ++seed)
+					{
+						scenarios.push_back( Scenario { speed, safetyMargin, footprint, seed });
+					}
+				}
+			}
+		}
+		return scenarios;
+	}
+	/**
+	 *
+	 */
+	ScenarioRunner::ScenarioRunner(	const ParameterGrid& aParameterGrid,
+									const WorldGenerator& aWorldGenerator /*= populateRandomised*/) :
+								parameterGrid( aParameterGrid),
+								worldGenerator( aWorldGenerator),
+								maximumTicks( 1000)
+	{
+		if (parameterGrid.firstSeed > parameterGrid.lastSeed)
+		{
+			throw std::invalid_argument( "ScenarioRunner: the first seed must not be larger than the last seed");
+		}
+	}
+	/**
+	 *
+	 */
+	/* static */void ScenarioRunner::populateRandomised(	RobotWorld& aRobotWorld,
+															const Scenario& aScenario)
+	{
+		aRobotWorld.populate();
+
+		// The distributions of the standard library differ between implementations, the engine does not
+		std::mt19937 random( static_cast< std::mt19937::result_type >(aScenario.seed));
+		auto offset = [&random]()
+		{
+			return static_cast< int >(random() % 51) - 25;
+		};
+
+		for (RobotPtr robot : aRobotWorld.getRobots())
+		{
+			Point position = robot->getPosition();
+			robot->setPosition( Point( position.x + offset(), position.y + offset()), false);
+			robot->setSize( aScenario.footprint, false);
+			robot->setSpeed( aScenario.speed, false);
+			robot->setSafetyMargin( aScenario.safetyMargin);
+		}
+		for (GoalPtr goal : aRobotWorld.getGoals())
+		{
+			Point position = goal->getPosition();
+			goal->setPosition( Point( position.x + offset(), position.y + offset()), false);
+			// In the GUI the shape sizes the goal to fit its title
+			goal->setSize( Size( 40, 30), false);
+		}
+
+		// An opponent that stands somewhere beside the straight line from the robot to the goal. The robot
+		// only stops for it if it comes within the safety margin, so the margin decides the outcome.
+		RobotPtr robot = aRobotWorld.getRobot( "Robot");
+		GoalPtr goal = aRobotWorld.getGoal( "Goal");
+		if (robot && goal && !aRobotWorld.getRobot( "Robo2"))
+		{
+			Point start = robot->getPosition();
+			Point end = goal->getPosition();
+			double along = static_cast< double >(30 + random() % 41) / 100.0;
+			double aside = static_cast< double >(static_cast< int >(random() % 121) - 60);
+			double dx = end.x - start.x;
+			double dy = end.y - start.y;
+			double length = std::max( 1.0, std::sqrt( dx * dx + dy * dy));
+			Point position( static_cast< int >(start.x + along * dx - aside * dy / length),
+							static_cast< int >(start.y + along * dy + aside * dx / length));
+			aRobotWorld.newRobot( "Robo2", position, false);
+		}
+	}
+	/**
+	 *
+	 */
+	/* static */ScenarioResult ScenarioRunner::runScenario(	const Scenario& aScenario,
+															const WorldGenerator& aWorldGenerator,
+															unsigned long aMaximumTicks)
+	{
+		ScenarioResult result { aScenario, false, 0, -1, 0, 0, 0.0 };
+
+		RobotWorld robotWorld;
+		SimulationClock& clock = robotWorld.getSimulationClock();
+		clock.setMode( SimulationClock::Mode::Paused);
+
+		aWorldGenerator( robotWorld, aScenario);
+
+		RobotPtr robot = robotWorld.getRobot( "Robot");
+		GoalPtr goal = robotWorld.getGoal( "Goal");
+		if (!robot || !goal)
+		{
+			throw std::runtime_error( "ScenarioRunner: the world has no robot called \"Robot\" or no goal called \"Goal\"");
+		}
+
+		robot->startDriving();
+		while (robot->isDriving() && result.ticks < aMaximumTicks)
+		{
+			clock.step();
+			++result.ticks;
+		}
+		robot->stopDriving();
+
+		result.arrived = robot->intersects( goal->getRegion());
+		if (result.arrived)
+		{
+			result.timeToGoal = static_cast< long >(clock.getSimulatedTime().count());
+		}
+		result.collisions = robot->getCollisions();
+		result.replans = robot->getReplans();
+		result.planningTime = robot->getPlanningTime();
+		return result;
+	}
+	/**
+	 *
+	 */
+	const std::vector< ScenarioResult >& ScenarioRunner::run( unsigned short aNumberOfThreads /*= 0*/)
+	{
+		std::vector< Scenario > scenarios = parameterGrid.getScenarios();
+		results.assign( scenarios.size(), ScenarioResult());
+
+		// The robots of the scenarios run their own tasks on the shared pool, only the scenarios are waited for
+		Base::WorkStealingPool pool( aNumberOfThreads);
+		Base::WorkStealingPool::TaskGroup scenarioTasks( pool);
+		for (std::size_t i = 0; i < scenarios.size(); ++i)
+		{
+			// Every task writes its own element, so the results need no lock
+			Scenario scenario = scenarios[i];
+			scenarioTasks.submit( [this, i, scenario]
+			{
+				ScenarioResult& result = results[i];
+				try
+				{
+					result = runScenario( scenario, worldGenerator, maximumTicks);
+				}
+				catch (...)
+				{
+					result = ScenarioResult { scenario, false, 0, -1, 0, 0, 0.0 };
+					throw;
+				}
+			}, "scenario");
+		}
+		scenarioTasks.wait();
+		return results;
+	}
+	/**
+	 *
+	 */
+	std::vector< ScenarioStatistics > ScenarioRunner::getStatistics() const
+	{
+		typedef std::tuple< float, unsigned short, int, int > Key;
+
+		std::vector< ScenarioStatistics > statistics;
+		std::map< Key, std::size_t > index;
+		for (const ScenarioResult& result : results)
+		{
+			const Scenario& scenario = result.scenario;
+			Key key( scenario.speed, scenario.safetyMargin, scenario.footprint.x, scenario.footprint.y);
+			std::map< Key, std::size_t >::iterator i = index.find( key);
+			if (i == index.end())
+			{
+				i = index.insert( std::make_pair( key, statistics.size())).first;
+				statistics.push_back( ScenarioStatistics { scenario, 0, 0, 0.0, 0, 0.0, 0.0, 0.0, 0.0 });
+			}
+
+			// The means are sums until all results are added
+			ScenarioStatistics& aggregate = statistics[i->second];
+			++aggregate.runs;
+			if (result.arrived)
+			{
+				++aggregate.arrivals;
+				aggregate.meanTimeToGoal += static_cast< double >(result.timeToGoal);
+				aggregate.maximumTimeToGoal = std::max( aggregate.maximumTimeToGoal, result.timeToGoal);
+			}
+			aggregate.meanCollisions += static_cast< double >(result.collisions);
+			aggregate.meanReplans += static_cast< double >(result.replans);
+			aggregate.meanPlanningTime += result.planningTime;
+			aggregate.maximumPlanningTime = std::max( aggregate.maximumPlanningTime, result.planningTime);
+		}
+		for (ScenarioStatistics& aggregate : statistics)
+		{
+			if (aggregate.arrivals > 0)
+			{
+				aggregate.meanTimeToGoal /= static_cast< double >(aggregate.arrivals);
+			}
+			aggregate.meanCollisions /= static_cast< double >(aggregate.runs);
+			aggregate.meanReplans /= static_cast< double >(aggregate.runs);
+			aggregate.meanPlanningTime /= static_cast< double >(aggregate.runs);
+		}
+		return statistics;
+	}
+	/**
+	 *
+	 */
+	void ScenarioRunner::writeCsv( std::ostream& anOutputStream) const
+	{
+		anOutputStream << "speed,safety_margin,footprint_width,footprint_height,runs,arrivals,mean_time_to_goal_ms,max_time_to_goal_ms,mean_collisions,mean_replans,mean_planning_ms,max_planning_ms\n";
+		for (const ScenarioStatistics& aggregate : getStatistics())
+		{
+			anOutputStream << aggregate.parameters.speed << ',' << aggregate.parameters.safetyMargin << ',' << aggregate.parameters.footprint.x << ','
+							<< aggregate.parameters.footprint.y << ',' << aggregate.runs << ',' << aggregate.arrivals << ',' << aggregate.meanTimeToGoal << ','
+							<< aggregate.maximumTimeToGoal << ',' << aggregate.meanCollisions << ',' << aggregate.meanReplans << ','
+							<< aggregate.meanPlanningTime << ',' << aggregate.maximumPlanningTime << '\n';
+		}
+	}
+	/**
+	 *
+	 */
+	void ScenarioRunner::writeJson( std::ostream& anOutputStream) const
+	{
+		std::vector< ScenarioStatistics > statistics = getStatistics();
+
+		anOutputStream << "[\n";
+		for (std::size_t i = 0; i < statistics.size(); ++i)
+		{
+			const ScenarioStatistics& aggregate = statistics[i];
+			anOutputStream << "  {\"speed\": " << aggregate.parameters.speed << ", \"safety_margin\": " << aggregate.parameters.safetyMargin
+							<< ", \"footprint\": [" << aggregate.parameters.footprint.x << ", " << aggregate.parameters.footprint.y << "]"
+							<< ", \"runs\": " << aggregate.runs << ", \"arrivals\": " << aggregate.arrivals << ", \"mean_time_to_goal_ms\": "
+							<< aggregate.meanTimeToGoal << ", \"max_time_to_goal_ms\": " << aggregate.maximumTimeToGoal << ", \"mean_collisions\": "
+							<< aggregate.meanCollisions << ", \"mean_replans\": " << aggregate.meanReplans << ", \"mean_planning_ms\": "
+							<< aggregate.meanPlanningTime << ", \"max_planning_ms\": " << aggregate.maximumPlanningTime << "}"
+							<< (i + 1 < statistics.size() ? "," : "") << "\n";
+		}
+		anOutputStream << "]\n";
+	}
+} // namespace Model
@@ -0,0 +1,158 @@
+#ifndef SCENARIORUNNER_HPP_
+#define SCENARIORUNNER_HPP_
+
+#include "Config.hpp"
+
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Size.hpp"
+
+namespace Model
+{
+	class RobotWorld;
+
+	/**
+	 * One variant of the robot parameters in one randomised world
+	 */
+	struct Scenario
+	{
+			float speed;
+			unsigned short safetyMargin;
+			Size footprint;
+			unsigned long seed;
+	};
+
+	/**
+	 * The outcome of driving "Robot" to "Goal" in one scenario
+	 */
+	struct ScenarioResult
+	{
+			Scenario scenario;
+			bool arrived;
+			unsigned long ticks;
+			/**
+			 * Simulated milliseconds, only meaningful if arrived
+			 */
+			long timeToGoal;
+			unsigned long collisions;
+			unsigned long replans;
+			/**
+			 * Wall-clock milliseconds
+			 */
+			double planningTime;
+	};
+
+	/**
+	 * The aggregate over all seeds of one combination of parameters
+	 */
+	struct ScenarioStatistics
+	{
+			/**
+			 * The seed of the parameters is not used
+			 */
+			Scenario parameters;
+			unsigned long runs;
+			unsigned long arrivals;
+			double meanTimeToGoal;
+			long maximumTimeToGoal;
+			double meanCollisions;
+			double meanReplans;
+			double meanPlanningTime;
+			double maximumPlanningTime;
+	};
+
+	/**
+	 * The parameter values to sweep, every combination is run for every seed in [firstSeed, lastSeed]
+	 */
+	struct ParameterGrid
+	{
+			/**
+			 *
+			 */
+			std::vector< Scenario > getScenarios() const;
+
+			std::vector< float > speeds;
+			std::vector< unsigned short > safetyMargins;
+			std::vector< Size > footprints;
+			unsigned long firstSeed;
+			unsigned long lastSeed;
+	};
+
+	/**
+	 * Runs every scenario of a ParameterGrid headlessly in a RobotWorld of its own on a WorkStealingPool.
+	 *
+	 * A scenario only depends on its parameters and its seed: its world has its own SimulationClock
+	 * that is stepped by the thread that runs the scenario, so the results (except the planning time,
+	 * which is measured on the wall clock) do not depend on the number of threads or the speed of the machine.
+	 */
+	class ScenarioRunner
+	{
+		public:
+			/**
+			 * Builds the world of a scenario. It must at least create a robot called "Robot" and a goal called "Goal".
+			 */
+			typedef std::function< void( RobotWorld&, const Scenario&) > WorldGenerator;
+
+			/**
+			 *
+			 */
+			explicit ScenarioRunner(	const ParameterGrid& aParameterGrid,
+										const WorldGenerator& aWorldGenerator = populateRandomised);
+			/**
+			 * The default WorldGenerator: RobotWorld::populate with the start of the robot and the position of
+			 * the goal moved at random (seeded by the scenario), the parameters of the scenario applied to the robot
+			 * and a standing opponent robot "Robo2" placed at random beside the straight line to the goal
+			 */
+			static void populateRandomised(	RobotWorld& aRobotWorld,
+											const Scenario& aScenario);
+			/**
+			 * Runs a single scenario on the calling thread
+			 */
+			static ScenarioResult runScenario(	const Scenario& aScenario,
+												const WorldGenerator& aWorldGenerator,
+												unsigned long aMaximumTicks);
+			/**
+			 *
+			 */
+			void setMaximumTicks( unsigned long aMaximumTicks)
+			{
+				maximumTicks = aMaximumTicks;
+			}
+			/**
+			 * Runs all scenarios and returns their results in the order of ParameterGrid::getScenarios
+			 *
+			 * @param aNumberOfThreads 0 means one per hardware thread
+			 */
+			const std::vector< ScenarioResult >& run( unsigned short aNumberOfThreads = 0);
+			/**
+			 *
+			 */
+			const std::vector< ScenarioResult >& getResults() const
+			{
+				return results;
+			}
+			/**
+			 * The results aggregated per combination of parameters
+			 */
+			std::vector< ScenarioStatistics > getStatistics() const;
+			/**
+			 * Writes getStatistics() with a header line
+			 */
+			void writeCsv( std::ostream& anOutputStream) const;
+			/**
+			 * Writes getStatistics() as an array of objects
+			 */
+			void writeJson( std::ostream& anOutputStream) const;
+
+		private:
+			ParameterGrid parameterGrid;
+			WorldGenerator worldGenerator;
+			unsigned long maximumTicks;
+			std::vector< ScenarioResult > results;
+	};
+	// class ScenarioRunner
+} // namespace Model
+#endif // SCENARIORUNNER_HPP_
@@ -0,0 +1,287 @@
+#include "SegmentGrid.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+namespace Utils
+{
+	/**
+	 *
+	 */
+	SegmentGrid::SegmentGrid( int aCellSize /*= 32*/) :
+								cellSize( aCellSize > 0 ? aCellSize : 32),
+								minX( 0.0),
+								minY( 0.0),
+								columns( 0),
+								rows( 0),
+								cellStart( 1, 0)
+	{
+	}
+	/**
+	 *
+	 */
+	void SegmentGrid::addSegment(	const Point& aPoint1,
+									const Point& aPoint2)
+	{
+		segments.add( aPoint1, aPoint2);
+	}
+	/**
+	 *
+	 */
+	void SegmentGrid::build()
+	{
+		cellSegments.clear();
+		cellStart.assign( 1, 0);
+		columns = 0;
+		rows = 0;
+
+		if (segments.size() == 0)
+		{
+			return;
+		}
+
+		float maxX = std::numeric_limits< float >::lowest();
+		float maxY = std::numeric_limits< float >::lowest();
+		minX = std::numeric_limits< float >::max();
+		minY = std::numeric_limits< float >::max();
+		for (std::size_t i = 0; i < segments.size(); ++i)
+		{
+			minX = std::min( minX, std::min( segments.x[i], segments.x[i] + segments.dx[i]));
+			minY = std::min( minY, std::min( segments.y[i], segments.y[i] + segments.dy[i]));
+			maxX = std::max( maxX, std::max( segments.x[i], segments.x[i] + segments.dx[i]));
+			maxY = std::max( maxY, std::max( segments.y[i], segments.y[i] + segments.dy[i]));
+		}
+		// One pixel of slack on every side so that end points never lie on the border of the grid
+		minX = std::floor( minX) - 1;
+		minY = std::floor( minY) - 1;
+		columns = static_cast< int >((maxX + 1 - minX) / static_cast< float >(cellSize)) + 1;
+		rows = static_cast< int >((maxY + 1 - minY) / static_cast< float >(cellSize)) + 1;
+
+		// (cell, segment) pairs, distributed over cellSegments with a counting sort
+		std::vector< std::pair< std::size_t, std::size_t > > cellEntries;
+		for (std::size_t i = 0; i < segments.size(); ++i)
+		{
+			float x1 = std::min( segments.x[i], segments.x[i] + segments.dx[i]);
+			float x2 = std::max( segments.x[i], segments.x[i] + segments.dx[i]);
+			float y1 = std::min( segments.y[i], segments.y[i] + segments.dy[i]);
+			float y2 = std::max( segments.y[i], segments.y[i] + segments.dy[i]);
+
+			int firstColumn = static_cast< int >((x1 - minX) / static_cast< float >(cellSize));
+			int lastColumn = static_cast< int >((x2 - minX) / static_cast< float >(cellSize));
+			int firstRow = static_cast< int >((y1 - minY) / static_cast< float >(cellSize));
+			int lastRow = static_cast< int >((y2 - minY) / static_cast< float >(cellSize));
+
+			for (int row = firstRow; row <= lastRow; ++row)
+			{
+				for (int column = firstColumn; column <= lastColumn; ++column)
+				{
+					if (overlapsCell( i, column, row))
+					{
+						cellEntries.push_back( std::make_pair( static_cast< std::size_t >(row * columns + column), i));
+					}
+				}
+			}
+		}
+
+		std::size_t numberOfCells = static_cast< std::size_t >(columns * rows);
+		cellStart.assign( numberOfCells + 1, 0);
+		for (const std::pair< std::size_t, std::size_t >& entry : cellEntries)
+		{
+			++cellStart[entry.first + 1];
+		}
+		for (std::size_t cell = 0; cell < numberOfCells; ++cell)
+		{
+			cellStart[cell + 1] += cellStart[cell];
+		}
+
+		cellSegments.x.resize( cellEntries.size());
+		cellSegments.y.resize( cellEntries.size());
+		cellSegments.dx.resize( cellEntries.size());
+		cellSegments.dy.resize( cellEntries.size());
+
+		std::vector< std::size_t > next( cellStart.begin(), cellStart.end() - 1);
+		for (const std::pair< std::size_t, std::size_t >& entry : cellEntries)
+		{
+			std::size_t position = next[entry.first]++;
+			cellSegments.x[position] = segments.x[entry.second];
+			cellSegments.y[position] = segments.y[entry.second];
+			cellSegments.dx[position] = segments.dx[entry.second];
+			cellSegments.dy[position] = segments.dy[entry.second];
+		}
+	}
+	/**
+	 * Amanatides & Woo: walk the cells in the order the ray enters them and stop as soon as
+	 * the nearest hit so far lies within the cell that is being tested.
+	 */
+	float SegmentGrid::castRay(	float anX,
+								float anY,
+								float aDirectionX,
+								float aDirectionY,
+								float aMaxRange) const
+	{
+		if (columns == 0 || rows == 0)
+		{
+			return aMaxRange;
+		}
+
+		const float infinity = std::numeric_limits< float >::infinity();
+		float maxX = minX + static_cast< float >(columns * cellSize);
+		float maxY = minY + static_cast< float >(rows * cellSize);
+
+		// Clip the ray against the bounding box of the grid
+		float tEnter = 0.0;
+		float tExit = aMaxRange;
+		if (aDirectionX != 0.0)
+		{
+			float t1 = (minX - anX) / aDirectionX;
+			float t2 = (maxX - anX) / aDirectionX;
+			tEnter = std::max( tEnter, std::min( t1, t2));
+			tExit = std::min( tExit, std::max( t1, t2));
+		} else if (anX < minX || anX >= maxX)
+		{
+			return aMaxRange;
+		}
+		if (aDirectionY != 0.0)
+		{
+			float t1 = (minY - anY) / aDirectionY;
+			float t2 = (maxY - anY) / aDirectionY;
+			tEnter = std::max( tEnter, std::min( t1, t2));
+			tExit = std::min( tExit, std::max( t1, t2));
+		} else if (anY < minY || anY >= maxY)
+		{
+			return aMaxRange;
+		}
+		if (tEnter > tExit)
+		{
+			return aMaxRange;
+		}
+
+		float startX = anX + tEnter * aDirectionX;
+		float startY = anY + tEnter * aDirectionY;
+		int column = std::min( std::max( static_cast< int >((startX - minX) / static_cast< float >(cellSize)), 0), columns - 1);
+		int row = std::min( std::max( static_cast< int >((startY - minY) / static_cast< float >(cellSize)), 0), rows - 1);
+
+		int stepX = aDirectionX > 0 ? 1 : -1;
+		int stepY = aDirectionY > 0 ? 1 : -1;
+		float tDeltaX = aDirectionX != 0.0 ? static_cast< float >(cellSize) / std::abs( aDirectionX) : infinity;
+		float tDeltaY = aDirectionY != 0.0 ? static_cast< float >(cellSize) / std::abs( aDirectionY) : infinity;
+		float tMaxX = infinity;
+		float tMaxY = infinity;
+		if (aDirectionX != 0.0)
+		{
+			tMaxX = (minX + static_cast< float >((column + (aDirectionX > 0 ? 1 : 0)) * cellSize) - anX) / aDirectionX;
+		}
+		if (aDirectionY != 0.0)
+		{
+			tMaxY = (minY + static_cast< float >((row + (aDirectionY > 0 ? 1 : 0)) * cellSize) - anY) / aDirectionY;
+		}
+
+		float nearest = aMaxRange;
+		for (;;)
+		{
+			std::size_t cell = static_cast< std::size_t >(row * columns + column);
+			nearest = nearestHit( cellSegments, cellStart[cell], cellStart[cell + 1], anX, anY, aDirectionX, aDirectionY, nearest);
+
+			float tCellExit = std::min( tMaxX, tMaxY);
+			if (nearest <= tCellExit || tCellExit >= tExit)
+			{
+				break;
+			}
+			if (tMaxX < tMaxY)
+			{
+				column += stepX;
+				if (column < 0 || column >= columns)
+				{
+					break;
+				}
+				tMaxX += tDeltaX;
+			} else
+			{
+				row += stepY;
+				if (row < 0 || row >= rows)
+				{
+					break;
+				}
+				tMaxY += tDeltaY;
+			}
+		}
+		return nearest;
+	}
+	/**
+	 * Written without branches in the loop body so that GCC/Clang vectorise it at -O3.
+	 * The ray is o + t*d, the segment p + u*e, w = p - o:
+	 *
+	 * 		t = (w x e) / (d x e), u = (w x d) / (d x e)
+	 *
+	 * and there is a hit if t >= 0 and 0 <= u <= 1. If d x e == 0 t and u are inf or nan and the
+	 * comparisons are false.
+	 *
+	 * A running float minimum is a reduction the compiler will not vectorise without -ffast-math.
+	 * All candidate distances are >= +0.0 and non-negative IEEE 754 floats are ordered exactly
+	 * as their bit patterns read as signed integers are, so the minimum is taken over the bits.
+	 */
+	/* static */float SegmentGrid::nearestHit(	const Segments& aSegments,
+												std::size_t aBegin,
+												std::size_t anEnd,
+												float anX,
+												float anY,
+												float aDirectionX,
+												float aDirectionY,
+												float aMaxDistance)
+	{
+		const float* x = aSegments.x.data();
+		const float* y = aSegments.y.data();
+		const float* dx = aSegments.dx.data();
+		const float* dy = aSegments.dy.data();
+
+		std::int32_t nearest;
+		std::memcpy( &nearest, &aMaxDistance, sizeof( nearest));
+		for (std::size_t i = aBegin; i < anEnd; ++i)
+		{
+			float wx = x[i] - anX;
+			float wy = y[i] - anY;
+			float inverseDenominator = 1.0f / (aDirectionX * dy[i] - aDirectionY * dx[i]);
+			float t = (wx * dy[i] - wy * dx[i]) * inverseDenominator;
+			float u = (wx * aDirectionY - wy * aDirectionX) * inverseDenominator;
+			// Non short circuiting & on purpose, the inner select turns a -0.0 into +0.0
+			float distance = (t >= 0.0f) & (u >= 0.0f) & (u <= 1.0f) ? (t > 0.0f ? t : 0.0f) : aMaxDistance;
+
+			std::int32_t bits;
+			std::memcpy( &bits, &distance, sizeof( bits));
+			nearest = bits < nearest ? bits : nearest;
+		}
+
+		float result;
+		std::memcpy( &result, &nearest, sizeof( result));
+		return result;
+	}
+	/**
+	 * Conservative: true if the segment passes within half a cell diagonal of the centre of the cell
+	 */
+	bool SegmentGrid::overlapsCell(	std::size_t aSegment,
+									int aColumn,
+									int aRow) const
+	{
+		float half = static_cast< float >(cellSize) / 2.0f;
+		float centreX = minX + static_cast< float >(aColumn * cellSize) + half;
+		float centreY = minY + static_cast< float >(aRow * cellSize) + half;
+
+		float px = segments.x[aSegment];
+		float py = segments.y[aSegment];
+		float ex = segments.dx[aSegment];
+		float ey = segments.dy[aSegment];
+
+		float lengthSquared = ex * ex + ey * ey;
+		float u = 0.0;
+		if (lengthSquared > 0.0)
+		{
+			u = std::min( std::max( ((centreX - px) * ex + (centreY - py) * ey) / lengthSquared, 0.0f), 1.0f);
+		}
+		float distanceX = px + u * ex - centreX;
+		float distanceY = py + u * ey - centreY;
+		return distanceX * distanceX + distanceY * distanceY <= 2.0f * half * half;
+	}
+} // namespace Utils
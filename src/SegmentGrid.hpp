@@ -0,0 +1,156 @@
+#ifndef SEGMENTGRID_HPP_
+#define SEGMENTGRID_HPP_
+
+#include "Config.hpp"
+
+#include <cstddef>
+#include <vector>
+
+#include "AllocationCounter.hpp"
+#include "Point.hpp"
+
+namespace Utils
+{
+	/**
+	 * A set of line segments stored as a structure of arrays: start point and
+	 * direction (end - start) of every segment live in their own contiguous
+	 * float array so that SegmentGrid::nearestHit can be vectorised by the compiler.
+	 */
+	struct Segments
+	{
+			/**
+			 *
+			 */
+			void add(	const Point& aPoint1,
+						const Point& aPoint2)
+			{
+				add( static_cast< float >(aPoint1.x), static_cast< float >(aPoint1.y), static_cast< float >(aPoint2.x), static_cast< float >(aPoint2.y));
+			}
+			/**
+			 *
+			 */
+			void add(	float anX1,
+						float anY1,
+						float anX2,
+						float anY2)
+			{
+				x.push_back( anX1);
+				y.push_back( anY1);
+				dx.push_back( anX2 - anX1);
+				dy.push_back( anY2 - anY1);
+			}
+			/**
+			 *
+			 */
+			void clear()
+			{
+				x.clear();
+				y.clear();
+				dx.clear();
+				dy.clear();
+			}
+			/**
+			 *
+			 */
+			std::size_t size() const
+			{
+				return x.size();
+			}
+
+			/**
+			 * Counted, the robot edges of a scan are refilled every scan and should not allocate
+			 */
+			typedef std::vector< float, Base::CountingAllocator< float > > Floats;
+
+			Floats x;
+			Floats y;
+			Floats dx;
+			Floats dy;
+	};
+	// struct Segments
+
+	/**
+	 * A uniform grid over a static set of line segments (the walls of the world) that answers
+	 * "where does this ray hit the first segment" by walking only the cells the ray passes through.
+	 *
+	 * Every cell refers to a contiguous range in a packed Segments array (segments that overlap more than one
+	 * cell are copied into every cell they overlap), so the per cell test is a branch free loop over
+	 * plain float arrays.
+	 */
+	class SegmentGrid
+	{
+		public:
+			/**
+			 *
+			 * @param aCellSize The width and height of a cell in world coordinates
+			 */
+			SegmentGrid( int aCellSize = 32);
+			/**
+			 *
+			 */
+			void addSegment(	const Point& aPoint1,
+								const Point& aPoint2);
+			/**
+			 * Distributes all added segments over the cells. Must be called after the last
+			 * addSegment and before the first castRay.
+			 */
+			void build();
+			/**
+			 *
+			 * @return the distance from (anX,anY) in the direction (aDirectionX,aDirectionY) to the nearest segment,
+			 * 			or aMaxRange if no segment is hit within that range. The direction must be normalised.
+			 */
+			float castRay(	float anX,
+							float anY,
+							float aDirectionX,
+							float aDirectionY,
+							float aMaxRange) const;
+			/**
+			 *
+			 * @return the number of distinct segments in the grid
+			 */
+			std::size_t size() const
+			{
+				return segments.size();
+			}
+			/**
+			 * The ray-segment kernel.
+			 *
+			 * @return the smallest ray parameter in [0,aMaxDistance) for which the ray hits one of the segments
+			 * 			[aBegin,anEnd) of aSegments, or aMaxDistance if there is no such hit
+			 */
+			static float nearestHit(	const Segments& aSegments,
+										std::size_t aBegin,
+										std::size_t anEnd,
+										float anX,
+										float anY,
+										float aDirectionX,
+										float aDirectionY,
+										float aMaxDistance);
+
+		private:
+			/**
+			 *
+			 */
+			bool overlapsCell(	std::size_t aSegment,
+								int aColumn,
+								int aRow) const;
+
+			int cellSize;
+			float minX;
+			float minY;
+			int columns;
+			int rows;
+			/**
+			 * The segments as added
+			 */
+			Segments segments;
+			/**
+			 * The segments per cell: the segments of cell c are [cellStart[c],cellStart[c+1])
+			 */
+			Segments cellSegments;
+			std::vector< std::size_t > cellStart;
+	};
+	// class SegmentGrid
+} // namespace Utils
+#endif // SEGMENTGRID_HPP_
@@ -0,0 +1,297 @@
+#include "SensorScheduler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include "AbstractSensor.hpp"
+#include "WorkStealingPool.hpp"
+
+namespace Model
+{
+	/**
+	 *
+	 */
+	JitterStatistics::JitterStatistics() :
+								samples( 0),
+								overruns( 0),
+								mean( 0.0),
+								maximum( 0.0),
+								squaredDeviations( 0.0)
+	{
+	}
+	/**
+	 *
+	 */
+	void JitterStatistics::add( double aJitter)
+	{
+		++samples;
+		double delta = aJitter - mean;
+		mean += delta / static_cast< double >(samples);
+		squaredDeviations += delta * (aJitter - mean);
+		maximum = std::max( maximum, aJitter);
+	}
+	/**
+	 *
+	 */
+	double JitterStatistics::getStandardDeviation() const
+	{
+		return samples > 1 ? std::sqrt( squaredDeviations / static_cast< double >(samples - 1)) : 0.0;
+	}
+	/**
+	 *
+	 */
+	std::string JitterStatistics::asString() const
+	{
+		std::ostringstream os;
+		os << "samples: " << samples << ", overruns: " << overruns << ", jitter mean: " << mean << " us, stddev: " << getStandardDeviation() << " us, max: " << maximum << " us";
+		return os.str();
+	}
+	/**
+	 *
+	 */
+	/* static */SensorScheduler& SensorScheduler::getSensorScheduler()
+	{
+		// The pool is created first so that it is destroyed after the scheduler
+		static SensorScheduler sensorScheduler( Base::WorkStealingPool::getWorkStealingPool());
+		return sensorScheduler;
+	}
+	/**
+	 *
+	 */
+	SensorScheduler::SensorScheduler( Base::WorkStealingPool& aWorkStealingPool) :
+								workStealingPool( aWorkStealingPool),
+								running( true),
+								pendingSamples( 0),
+								nextGeneration( 1)
+	{
+	}
+	/**
+	 *
+	 */
+	SensorScheduler::~SensorScheduler()
+	{
+		{
+			std::unique_lock< std::mutex > lock( schedulerMutex);
+			running = false;
+			deadlinesChanged.notify_all();
+		}
+		if (dispatcherThread.joinable())
+		{
+			dispatcherThread.join();
+		}
+		std::unique_lock< std::mutex > lock( schedulerMutex);
+		samplingDone.wait( lock, [this]
+		{	return pendingSamples == 0;});
+	}
+	/**
+	 *
+	 */
+	void SensorScheduler::schedule(	AbstractSensor* aSensor,
+									unsigned long aPeriod)
+	{
+		std::unique_lock< std::mutex > lock( schedulerMutex);
+
+		if (!dispatcherThread.joinable())
+		{
+			std::thread newDispatcherThread( [this]
+			{	run();});
+			dispatcherThread.swap( newDispatcherThread);
+		}
+
+		std::chrono::microseconds period = std::chrono::milliseconds( std::max( 1UL, aPeriod));
+		std::map< AbstractSensor*, Entry >::iterator i = entries.find( aSensor);
+		if (i == entries.end())
+		{
+			Entry entry;
+			entry.period = period;
+			entry.generation = nextGeneration++;
+			entry.sampling = false;
+			i = entries.insert( std::make_pair( aSensor, entry)).first;
+			deadlines.push( Deadline { Clock::now(), aSensor, entry.generation });
+		} else
+		{
+			i->second.period = period;
+			// A sensor that is being sampled is put back by its task with the new period, a task that
+			// is still waiting for a worker is dropped because of the new generation
+			if (!i->second.sampling)
+			{
+				i->second.generation = nextGeneration++;
+				deadlines.push( Deadline { Clock::now() + period, aSensor, i->second.generation });
+			}
+		}
+		deadlinesChanged.notify_all();
+	}
+	/**
+	 *
+	 */
+	void SensorScheduler::unschedule( AbstractSensor* aSensor)
+	{
+		std::unique_lock< std::mutex > lock( schedulerMutex);
+
+		std::map< AbstractSensor*, Entry >::iterator i = entries.find( aSensor);
+		// Waiting for ourselves would never end if a sensor switches itself off while being sampled.
+		// A sample task that has not started yet is not waited for, it finds the entry gone.
+		while (i != entries.end() && i->second.sampling && i->second.samplingThread != std::this_thread::get_id())
+		{
+			samplingDone.wait( lock);
+			i = entries.find( aSensor);
+		}
+		if (i != entries.end())
+		{
+			// The pending deadline becomes stale and is dropped by the dispatcher that finds it
+			entries.erase( i);
+		}
+	}
+	/**
+	 *
+	 */
+	bool SensorScheduler::isScheduled( AbstractSensor* aSensor) const
+	{
+		std::unique_lock< std::mutex > lock( schedulerMutex);
+		return entries.find( aSensor) != entries.end();
+	}
+	/**
+	 *
+	 */
+	JitterStatistics SensorScheduler::getJitterStatistics( AbstractSensor* aSensor) const
+	{
+		std::unique_lock< std::mutex > lock( schedulerMutex);
+		std::map< AbstractSensor*, Entry >::const_iterator i = entries.find( aSensor);
+		if (i == entries.end())
+		{
+			return JitterStatistics();
+		}
+		return i->second.jitter;
+	}
+	/**
+	 *
+	 */
+	JitterStatistics SensorScheduler::getJitterStatistics() const
+	{
+		std::unique_lock< std::mutex > lock( schedulerMutex);
+		return jitter;
+	}
+	/**
+	 *
+	 */
+	void SensorScheduler::run()
+	{
+		std::unique_lock< std::mutex > lock( schedulerMutex);
+		while (running)
+		{
+			if (deadlines.empty())
+			{
+				deadlinesChanged.wait( lock);
+				continue;
+			}
+
+			Deadline deadline = deadlines.top();
+			std::map< AbstractSensor*, Entry >::iterator i = entries.find( deadline.sensor);
+			if (i == entries.end() || i->second.generation != deadline.generation)
+			{
+				deadlines.pop();
+				continue;
+			}
+
+			if (Clock::now() < deadline.due)
+			{
+				deadlinesChanged.wait_until( lock, deadline.due);
+				continue;
+			}
+			deadlines.pop();
+
+			++pendingSamples;
+			workStealingPool.submit( [this, deadline]
+			{	sample( deadline);}, "sensor");
+		}
+	}
+	/**
+	 *
+	 */
+	void SensorScheduler::sample( const Deadline& aDeadline)
+	{
+		std::unique_lock< std::mutex > lock( schedulerMutex);
+
+		std::map< AbstractSensor*, Entry >::iterator i = entries.find( aDeadline.sensor);
+		if (i != entries.end() && i->second.generation == aDeadline.generation)
+		{
+			Clock::time_point now = Clock::now();
+			double jitterTime = std::chrono::duration< double, std::micro >( now - aDeadline.due).count();
+			i->second.jitter.add( jitterTime);
+			jitter.add( jitterTime);
+			i->second.sampling = true;
+			i->second.samplingThread = std::this_thread::get_id();
+
+			lock.unlock();
+			try
+			{
+				aDeadline.sensor->sample();
+			}
+			catch (std::exception& e)
+			{
+				std::cerr << __PRETTY_FUNCTION__ << ": " << e.what() << std::endl;
+			}
+			catch (...)
+			{
+				std::cerr << __PRETTY_FUNCTION__ << ": unknown exception" << std::endl;
+			}
+			lock.lock();
+
+			// The sensor may have been unscheduled (and even rescheduled) from within sample()
+			i = entries.find( aDeadline.sensor);
+			if (i != entries.end() && i->second.generation == aDeadline.generation)
+			{
+				i->second.sampling = false;
+
+				Clock::time_point due = aDeadline.due + i->second.period;
+				now = Clock::now();
+				while (due < now)
+				{
+					due += i->second.period;
+					++i->second.jitter.overruns;
+					++jitter.overruns;
+				}
+				deadlines.push( Deadline { due, aDeadline.sensor, aDeadline.generation });
+				deadlinesChanged.notify_all();
+			} else if (i != entries.end())
+			{
+				i->second.sampling = false;
+			}
+		}
+		--pendingSamples;
+		samplingDone.notify_all();
+	}
+	/**
+	 *
+	 */
+	unsigned short SensorScheduler::getNumberOfThreads() const
+	{
+		return workStealingPool.getNumberOfWorkers();
+	}
+	/**
+	 *
+	 */
+	std::string SensorScheduler::asString() const
+	{
+		std::ostringstream os;
+		std::unique_lock< std::mutex > lock( schedulerMutex);
+		os << "SensorScheduler: " << entries.size() << " sensors on " << workStealingPool.getNumberOfWorkers() << " threads";
+		return os.str();
+	}
+	/**
+	 *
+	 */
+	std::string SensorScheduler::asDebugString() const
+	{
+		std::ostringstream os;
+		os << asString() << "\n";
+
+		std::unique_lock< std::mutex > lock( schedulerMutex);
+		os << "all sensors: " << jitter.asString() << "\n";
+		for (const std::pair< AbstractSensor* const, Entry >& entry : entries)
+		{
+			os << entry.first->asString() << " every " << entry.second.period.count() << " us: " << entry.second.jitter.asString() << "\n";
+		}
+		return os.str();
+	}
+} // namespace Model
@@ -0,0 +1,197 @@
+#ifndef SENSORSCHEDULER_HPP_
+#define SENSORSCHEDULER_HPP_
+
+#include "Config.hpp"
+
+#include <functional>
+#include <map>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "Thread.hpp"
+
+namespace Base
+{
+	class WorkStealingPool;
+} // namespace Base
+
+namespace Model
+{
+	class AbstractSensor;
+
+	/**
+	 * The difference between the time a sensor was due and the time it was actually sampled, in microseconds
+	 */
+	class JitterStatistics
+	{
+		public:
+			/**
+			 *
+			 */
+			JitterStatistics();
+			/**
+			 *
+			 */
+			void add( double aJitter);
+			/**
+			 *
+			 */
+			double getStandardDeviation() const;
+			/**
+			 * @name Debug functions
+			 */
+			//@{
+			/**
+			 * Returns a 1-line description of the object
+			 */
+			std::string asString() const;
+			//@}
+
+			unsigned long samples;
+			/**
+			 * The number of periods that were skipped because sampling took longer than the period
+			 */
+			unsigned long overruns;
+			double mean;
+			double maximum;
+
+		private:
+			/**
+			 * Sum of squared differences from the mean (Welford)
+			 */
+			double squaredDeviations;
+	};
+	// class JitterStatistics
+
+	/**
+	 * Samples all switched on sensors of all agents at their own rate as tasks on the shared WorkStealingPool.
+	 *
+	 * The deadlines of the sensors are kept in a single min-heap; a dispatcher thread sleeps until the earliest
+	 * deadline and submits a task that samples that sensor and puts it back with its next deadline. A sensor is
+	 * never sampled by two tasks at the same time. If sampling takes longer than the period the missed periods
+	 * are skipped (and counted as overruns) instead of being caught up. The jitter includes the time the task
+	 * waited for a worker.
+	 */
+	class SensorScheduler
+	{
+		public:
+			/**
+			 *
+			 */
+			static SensorScheduler& getSensorScheduler();
+			/**
+			 * Samples aSensor every aPeriod milliseconds, the first time as soon as possible. If aSensor
+			 * is already scheduled only its period is changed.
+			 */
+			void schedule(	AbstractSensor* aSensor,
+							unsigned long aPeriod);
+			/**
+			 * Stops sampling aSensor. When this function returns aSensor is not being sampled by another thread.
+			 */
+			void unschedule( AbstractSensor* aSensor);
+			/**
+			 *
+			 */
+			bool isScheduled( AbstractSensor* aSensor) const;
+			/**
+			 *
+			 */
+			JitterStatistics getJitterStatistics( AbstractSensor* aSensor) const;
+			/**
+			 * @return the jitter statistics over all sensors that were ever scheduled
+			 */
+			JitterStatistics getJitterStatistics() const;
+			/**
+			 *
+			 */
+			unsigned short getNumberOfThreads() const;
+			/**
+			 * @name Debug functions
+			 */
+			//@{
+			/**
+			 * Returns a 1-line description of the object
+			 */
+			std::string asString() const;
+			/**
+			 * Returns a description of the object with all data of the object usable for debugging
+			 */
+			std::string asDebugString() const;
+			//@}
+
+		private:
+			typedef std::chrono::steady_clock Clock;
+
+			/**
+			 *
+			 */
+			struct Entry
+			{
+					std::chrono::microseconds period;
+					unsigned long generation;
+					bool sampling;
+					std::thread::id samplingThread;
+					JitterStatistics jitter;
+			};
+			/**
+			 * A deadline is stale if its generation differs from the generation of its Entry
+			 */
+			struct Deadline
+			{
+					bool operator>( const Deadline& aDeadline) const
+					{
+						return due > aDeadline.due;
+					}
+
+					Clock::time_point due;
+					AbstractSensor* sensor;
+					unsigned long generation;
+			};
+
+			/**
+			 *
+			 */
+			explicit SensorScheduler( Base::WorkStealingPool& aWorkStealingPool);
+			/**
+			 *
+			 */
+			~SensorScheduler();
+			/**
+			 *
+			 */
+			SensorScheduler( const SensorScheduler& aSensorScheduler) = delete;
+			/**
+			 *
+			 */
+			SensorScheduler& operator=( const SensorScheduler& aSensorScheduler) = delete;
+			/**
+			 * The dispatcher loop
+			 */
+			void run();
+			/**
+			 * The task that samples the sensor of aDeadline, unless it was unscheduled or rescheduled in the meantime
+			 */
+			void sample( const Deadline& aDeadline);
+
+			Base::WorkStealingPool& workStealingPool;
+			bool running;
+			/**
+			 * The number of submitted sample tasks that have not finished yet
+			 */
+			unsigned long pendingSamples;
+			unsigned long nextGeneration;
+			std::map< AbstractSensor*, Entry > entries;
+			std::priority_queue< Deadline, std::vector< Deadline >, std::greater< Deadline > > deadlines;
+			JitterStatistics jitter;
+			/**
+			 * Started on the first call to schedule
+			 */
+			std::thread dispatcherThread;
+			mutable std::mutex schedulerMutex;
+			std::condition_variable deadlinesChanged;
+			std::condition_variable samplingDone;
+	};
+	// class SensorScheduler
+} // namespace Model
+#endif // SENSORSCHEDULER_HPP_
@@ -34,13 +34,13 @@ namespace Messaging
 			/**
 			 *	Handle any incoming connections
 			 */
-			void handleAccept( 	ServerSession* aSession,
+			void handleAccept( 	std::shared_ptr< ServerSession > aSession,
 								const boost::system::error_code& error)
 			{
 				if (!error)
 				{
 					// Create the session that will handle the next incoming connection
-					ServerSession* session = new ServerSession( io_service, requestHandler);
+					std::shared_ptr< ServerSession > session = std::make_shared< ServerSession >( io_service, requestHandler);
 					// Let the acceptor wait for any new incoming connections
 					// and let it call server::handle_accept on the happy occasion
 					acceptor.async_accept( session->getSocket(),
@@ -52,7 +52,6 @@ namespace Messaging
 					}
 				} else
 				{
-					delete aSession;
 					throw std::runtime_error( __PRETTY_FUNCTION__ + std::string( ": ") + error.message());
 				}
 			}
@@ -3,23 +3,31 @@
 
 #include "Config.hpp"
 
+#include <chrono>
 #include <string>
 #include <iostream>
 #include <sstream>
 #include <boost/bind.hpp>
 #include <boost/asio.hpp>
 #include <functional>
+#include <memory>
 
 #include "Message.hpp"
 #include "MessageHandler.hpp"
+#include "Metrics.hpp"
+#include "TraceLog.hpp"
 #include "CommunicationService.hpp"
+#include "WorkStealingPool.hpp"
 
 namespace Messaging
 {
 	/**
 	 * A session is an encapsulation of a request/response transaction sequence.
+	 *
+	 * A session is owned by a std::shared_ptr. Every pending asynchronous operation holds one,
+	 * so the session is destroyed when the last one is done and starts nothing new.
 	 */
-	class Session
+	class Session : public std::enable_shared_from_this< Session >
 	{
 		public:
 			/**
@@ -79,7 +87,7 @@ namespace Messaging
 				headerBuffer.resize( aMessage.getHeader().getHeaderLength());
 				boost::asio::async_read( getSocket(),
 										 boost::asio::buffer( headerBuffer),
-										 boost::bind( &Session::handleHeaderRead, this, aMessage, boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred));
+										 boost::bind( &Session::handleHeaderRead, shared_from_this(), aMessage, boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred));
 			}
 			/**
 			 * This function is called after the header bytes are read.
@@ -94,10 +102,9 @@ namespace Messaging
 					bodyBuffer.resize( aMessage.getHeader().getMessageLength());
 					boost::asio::async_read( getSocket(),
 											 boost::asio::buffer( bodyBuffer),
-											 boost::bind( &Session::handleBodyRead, this, aMessage, boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred));
+											 boost::bind( &Session::handleBodyRead, shared_from_this(), aMessage, boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred));
 				} else
 				{
-					delete this;
 					throw std::runtime_error( __PRETTY_FUNCTION__ + std::string( ": ") + error.message());
 				}
 			}
@@ -117,7 +124,6 @@ namespace Messaging
 					handleMessageRead( aMessage, error, bytes_transferred);
 				} else
 				{
-					delete this;
 					// Throwing a exception goes wrong if a "stop" message is send in the (limited)
 					// context of this example. If any "strange" things happen, enable the next line.
 					// A "end of file" exception will happen on "normal" termination of the message exchange...
@@ -134,10 +140,15 @@ namespace Messaging
 			{
 				if (!error)
 				{
+					static Base::Counter& bytesReceived = Base::Metrics::getMetrics().getCounter( "robotworld_message_received_bytes_total", "The bytes of the messages that were received, headers included");
+					static Base::Histogram& handleTime = Base::Metrics::getMetrics().getHistogram( "robotworld_message_handle_seconds", "The time it took to handle a message that was received", 1e-6);
+					bytesReceived.add( aMessage.getHeader().getHeaderLength() + aMessage.length());
+
+					Base::TraceScope trace( Base::TraceEvent::MessageReceive, static_cast< std::uint64_t >(aMessage.getMessageType()), aMessage.length());
+					Base::ScopedTimer timer( handleTime);
 					handleMessageRead( aMessage);
 				} else
 				{
-					delete this;
 					throw std::runtime_error( __PRETTY_FUNCTION__ + std::string( ": ") + error.message());
 				}
 			}
@@ -152,9 +163,11 @@ namespace Messaging
 			 */
 			void writeMessage( Message& aMessage)
 			{
+				Base::TraceLog::getTraceLog().trace( Base::TraceEvent::MessageSend, Base::TracePhase::Instant, static_cast< std::uint64_t >(aMessage.getMessageType()), aMessage.length());
+				writeStart = std::chrono::steady_clock::now();
 				boost::asio::async_write( getSocket(),
 										  boost::asio::buffer( aMessage.getHeader().toString(), aMessage.getHeader().getHeaderLength()),
-										  boost::bind( &Session::handleHeaderWritten, this, aMessage, boost::asio::placeholders::error));
+										  boost::bind( &Session::handleHeaderWritten, shared_from_this(), aMessage, boost::asio::placeholders::error));
 			}
 			/**
 			 * This function is called after the header bytes are written.
@@ -166,10 +179,9 @@ namespace Messaging
 				{
 					boost::asio::async_write( getSocket(),
 											  boost::asio::buffer( aMessage.getBody(), aMessage.length()),
-											  boost::bind( &Session::handleBodyWritten, this, aMessage, boost::asio::placeholders::error));
+											  boost::bind( &Session::handleBodyWritten, shared_from_this(), aMessage, boost::asio::placeholders::error));
 				} else
 				{
-					delete this;
 					throw std::runtime_error( __PRETTY_FUNCTION__ + std::string( ": ") + error.message());
 				}
 			}
@@ -184,7 +196,6 @@ namespace Messaging
 					handleMessageWritten( aMessage, error);
 				} else
 				{
-					delete this;
 					throw std::runtime_error( __PRETTY_FUNCTION__ + std::string( ": ") + error.message());
 				}
 			}
@@ -199,10 +210,14 @@ namespace Messaging
 			{
 				if (!error)
 				{
+					static Base::Counter& bytesSent = Base::Metrics::getMetrics().getCounter( "robotworld_message_sent_bytes_total", "The bytes of the messages that were sent, headers included");
+					static Base::Histogram& writeTime = Base::Metrics::getMetrics().getHistogram( "robotworld_message_write_seconds", "The time from starting to write a message until it was written", 1e-6);
+					bytesSent.add( aMessage.getHeader().getHeaderLength() + aMessage.length());
+					writeTime.record( static_cast< std::uint64_t >(std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::steady_clock::now() - writeStart).count()));
+
 					handleMessageWritten( aMessage);
 				} else
 				{
-					delete this;
 					throw std::runtime_error( __PRETTY_FUNCTION__ + std::string( ": ") + error.message());
 				}
 			}
@@ -210,6 +225,10 @@ namespace Messaging
 			boost::asio::ip::tcp::socket socket;
 			std::vector< char > headerBuffer;
 			std::vector< char > bodyBuffer;
+			/**
+			 * When writeMessage was called for the message that is being written
+			 */
+			std::chrono::steady_clock::time_point writeStart;
 	};
 	// class Session
 	/**
@@ -226,6 +245,7 @@ namespace Messaging
 			ServerSession( 	boost::asio::io_service& io_service,
 							RequestHandlerPtr aRequestHandler) :
 							Session( io_service),
+							io_service( io_service),
 							requestHandler( aRequestHandler)
 			{
 			}
@@ -247,25 +267,37 @@ namespace Messaging
 			 */
 			virtual void handleMessageRead( Message& aMessage)
 			{
-				requestHandler->handleRequest( aMessage);
-				writeMessage( aMessage);
-
-				// This is part of the original application. If one wants a stop message
-				// just leave this here. Otherwise think something up yourself.
-				if (aMessage.getBody() == "stop")
+				// The request is handled on the shared pool so that a slow handler does not hold up
+				// the io_service, the reply is written on the io_service again
+				// The session is kept alive while the request is on the pool and while the reply waits for the io_service
+				std::shared_ptr< ServerSession > session = std::dynamic_pointer_cast< ServerSession >( shared_from_this());
+				Message request( aMessage);
+				Base::WorkStealingPool::getWorkStealingPool().submit( [session, request]() mutable
 				{
-					CommunicationService::getCommunicationService().getIOService().stop();
-				}
+					session->requestHandler->handleRequest( request);
+					session->io_service.post( [session, request]() mutable
+					{
+						session->writeMessage( request);
+
+						// This is part of the original application. If one wants a stop message
+						// just leave this here. Otherwise think something up yourself.
+						if (request.getBody() == "stop")
+						{
+							CommunicationService::getCommunicationService().getIOService().stop();
+						}
+					});
+				}, "request");
 			}
 			/**
 			 * @see Session::handleMessageWritten( Message& aMessage)
 			 */
 			virtual void handleMessageWritten( Message& UNUSEDPARAM(aMessage))
 			{
-				delete this;
+				// Nothing is pending any more, the session is destroyed when this handler returns
 			}
 
 		private:
+			boost::asio::io_service& io_service;
 			RequestHandlerPtr  requestHandler;
 
 	};
@@ -284,17 +316,35 @@ namespace Messaging
 			 */
 			ClientSession( 	Message aMessage,
 							boost::asio::io_service& io_service,
-							ResponseHandlerPtr aResponseHandler) :
+							ResponseHandlerPtr aResponseHandler,
+							const std::function< void() >& aWhenDone = nullptr) :
 							Session( io_service),
 							message( aMessage),
-							responseHandler( aResponseHandler)
+							responseHandler( aResponseHandler),
+							whenDone( aWhenDone)
 			{
 			}
 			/**
-			 *
+			 * The exchange is over, with or without a response, when the last pending operation lets go
+			 * of the session: whenDone is called then
 			 */
 			~ClientSession()
 			{
+				if (whenDone)
+				{
+					try
+					{
+						whenDone();
+					}
+					catch (std::exception& e)
+					{
+						std::cerr << __PRETTY_FUNCTION__ << ": " << e.what() << std::endl;
+					}
+					catch (...)
+					{
+						std::cerr << __PRETTY_FUNCTION__ << ": unknown exception" << std::endl;
+					}
+				}
 			}
 			/**
 			 * @see Session::start()
@@ -309,10 +359,11 @@ namespace Messaging
 			virtual void handleMessageRead( Message& aMessage)
 			{
 				// This is the place where any reply message from the server should
-				// be handled
-				responseHandler->handleResponse( aMessage);
-
-				delete this;
+				// be handled, on the shared pool like the requests of a ServerSession
+				ResponseHandlerPtr handler( responseHandler);
+				Message response( aMessage);
+				Base::WorkStealingPool::getWorkStealingPool().submit( [handler, response]
+				{	handler->handleResponse( response);}, "response");
 			}
 			/**
 			 * @see Session::handleMessageWritten( Message& aMessage)
@@ -326,6 +377,7 @@ namespace Messaging
 		private:
 			Message message;
 			ResponseHandlerPtr responseHandler;
+			std::function< void() > whenDone;
 	};
 //	class ClientSession
 
@@ -100,7 +100,18 @@ namespace View
 			 *
 			 */
 			virtual void setCentre( const Point& aPoint) = 0;
+			/**
+			 * The rectangle that contains everything the shape draws, in canvas coordinates
+			 */
+			virtual Rect getBoundingBox() const = 0;
 			//@}
+			/**
+			 * Draws the shape when the canvas is zoomed out too far to see the details. The default draws it as usual.
+			 */
+			virtual void drawSimplified( wxDC& dc)
+			{
+				draw( dc);
+			}
 			/**
 			 * @name Accessors and mutators
 			 */
@@ -1,7 +1,7 @@
 #include "Shape2DUtils.hpp"
 #include <sstream>
 #include <algorithm>
-#include "Widgets.hpp"
+#include <cmath>
 
 namespace Utils
 {
@@ -0,0 +1,221 @@
+#include "ShapeIndex.hpp"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_set>
+#include "Shape.hpp"
+
+namespace View
+{
+	/**
+	 *
+	 */
+	ShapeIndex::ShapeIndex( int aCellSize /*= 128*/) :
+								cellSize( aCellSize),
+								nextSequence( 0)
+	{
+		if (cellSize <= 0)
+		{
+			throw std::invalid_argument( "The cells of a ShapeIndex must have a positive size");
+		}
+	}
+	/**
+	 *
+	 */
+	void ShapeIndex::insert(	ShapePtr aShape,
+								const Rect& aBoundingBox)
+	{
+		if (contains( aShape))
+		{
+			update( aShape, aBoundingBox);
+			return;
+		}
+
+		Entry entry = { aShape, aBoundingBox, nextSequence++ };
+		entries.insert( std::make_pair( aShape.get(), entry));
+		addToCells( aShape.get(), aBoundingBox);
+	}
+	/**
+	 *
+	 */
+	void ShapeIndex::remove( ShapePtr aShape)
+	{
+		auto entry = entries.find( aShape.get());
+		if (entry != entries.end())
+		{
+			removeFromCells( aShape.get(), entry->second.boundingBox);
+			entries.erase( entry);
+		}
+	}
+	/**
+	 *
+	 */
+	bool ShapeIndex::update(	ShapePtr aShape,
+								const Rect& aBoundingBox)
+	{
+		auto entry = entries.find( aShape.get());
+		if (entry == entries.end() || entry->second.boundingBox == aBoundingBox)
+		{
+			return false;
+		}
+
+		removeFromCells( aShape.get(), entry->second.boundingBox);
+		entry->second.boundingBox = aBoundingBox;
+		addToCells( aShape.get(), aBoundingBox);
+		return true;
+	}
+	/**
+	 *
+	 */
+	bool ShapeIndex::contains( ShapePtr aShape) const
+	{
+		return entries.find( aShape.get()) != entries.end();
+	}
+	/**
+	 *
+	 */
+	Rect ShapeIndex::getBoundingBox( ShapePtr aShape) const
+	{
+		auto entry = entries.find( aShape.get());
+		if (entry == entries.end())
+		{
+			return Rect();
+		}
+		return entry->second.boundingBox;
+	}
+	/**
+	 *
+	 */
+	std::vector< ShapePtr > ShapeIndex::find( const Rect& anArea) const
+	{
+		std::vector< const Entry* > found;
+		std::unordered_set< Shape* > seen;
+
+		auto visit = [&](const std::vector< Shape* >& aCell)
+		{
+			for (Shape* shape : aCell)
+			{
+				if (seen.insert( shape).second)
+				{
+					const Entry& entry = entries.at( shape);
+					if (entry.boundingBox.Intersects( anArea))
+					{
+						found.push_back( &entry);
+					}
+				}
+			}
+		};
+
+		int left = cellFor( anArea.GetLeft());
+		int top = cellFor( anArea.GetTop());
+		int right = cellFor( anArea.GetRight());
+		int bottom = cellFor( anArea.GetBottom());
+
+		// Zoomed far out the area covers more cells than are in use
+		if (static_cast< double >(right - left + 1) * (bottom - top + 1) > cells.size())
+		{
+			for (const auto& cell : cells)
+			{
+				visit( cell.second);
+			}
+		} else
+		{
+			for (int x = left; x <= right; ++x)
+			{
+				for (int y = top; y <= bottom; ++y)
+				{
+					auto cell = cells.find( cellKeyFor( x, y));
+					if (cell != cells.end())
+					{
+						visit( cell->second);
+					}
+				}
+			}
+		}
+
+		std::sort(	found.begin(),
+					found.end(),
+					[](const Entry* lhs, const Entry* rhs)
+					{
+						return lhs->sequence < rhs->sequence;
+					});
+
+		std::vector< ShapePtr > shapes;
+		shapes.reserve( found.size());
+		for (const Entry* entry : found)
+		{
+			shapes.push_back( entry->shape);
+		}
+		return shapes;
+	}
+	/**
+	 *
+	 */
+	void ShapeIndex::clear()
+	{
+		entries.clear();
+		cells.clear();
+		nextSequence = 0;
+	}
+	/**
+	 *
+	 */
+	std::string ShapeIndex::asString() const
+	{
+		std::ostringstream os;
+		os << "ShapeIndex: " << entries.size() << " shapes in " << cells.size() << " cells of " << cellSize;
+		return os.str();
+	}
+	/**
+	 *
+	 */
+	int ShapeIndex::cellFor( int aCoordinate) const
+	{
+		return aCoordinate >= 0 ? aCoordinate / cellSize : -((-aCoordinate + cellSize - 1) / cellSize);
+	}
+	/**
+	 *
+	 */
+	/* static */ShapeIndex::CellKey ShapeIndex::cellKeyFor(	int aCellX,
+																int aCellY)
+	{
+		return (static_cast< CellKey >(static_cast< std::uint32_t >(aCellX)) << 32) | static_cast< std::uint32_t >(aCellY);
+	}
+	/**
+	 *
+	 */
+	void ShapeIndex::addToCells(	Shape* aShape,
+									const Rect& aBoundingBox)
+	{
+		for (int x = cellFor( aBoundingBox.GetLeft()); x <= cellFor( aBoundingBox.GetRight()); ++x)
+		{
+			for (int y = cellFor( aBoundingBox.GetTop()); y <= cellFor( aBoundingBox.GetBottom()); ++y)
+			{
+				cells[cellKeyFor( x, y)].push_back( aShape);
+			}
+		}
+	}
+	/**
+	 *
+	 */
+	void ShapeIndex::removeFromCells(	Shape* aShape,
+										const Rect& aBoundingBox)
+	{
+		for (int x = cellFor( aBoundingBox.GetLeft()); x <= cellFor( aBoundingBox.GetRight()); ++x)
+		{
+			for (int y = cellFor( aBoundingBox.GetTop()); y <= cellFor( aBoundingBox.GetBottom()); ++y)
+			{
+				auto cell = cells.find( cellKeyFor( x, y));
+				if (cell != cells.end())
+				{
+					std::vector< Shape* >& shapes = cell->second;
+					shapes.erase( std::remove( shapes.begin(), shapes.end(), aShape), shapes.end());
+					if (shapes.empty())
+					{
+						cells.erase( cell);
+					}
+				}
+			}
+		}
+	}
+} // namespace View
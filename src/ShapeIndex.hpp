@@ -0,0 +1,121 @@
+#ifndef SHAPEINDEX_HPP_
+#define SHAPEINDEX_HPP_
+
+#include "Config.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Widgets.hpp"
+
+namespace View
+{
+	class Shape;
+	typedef std::shared_ptr<Shape> ShapePtr;
+
+	/**
+	 * A uniform grid over the bounding boxes of the shapes of a canvas, in canvas coordinates.
+	 *
+	 * Finding the shapes in a rectangle costs the number of cells it covers plus the number of shapes
+	 * found, not the number of shapes on the canvas. A shape that moves is only taken out of the cells
+	 * it left and put in the cells it entered.
+	 */
+	class ShapeIndex
+	{
+		public:
+			/**
+			 *
+			 */
+			explicit ShapeIndex( int aCellSize = 128);
+			/**
+			 * Adds aShape, or updates it if it is in the index already
+			 */
+			void insert(	ShapePtr aShape,
+							const Rect& aBoundingBox);
+			/**
+			 *
+			 */
+			void remove( ShapePtr aShape);
+			/**
+			 * Moves aShape to the cells of aBoundingBox, it keeps its place in the order of the shapes
+			 *
+			 * @return true if the bounding box changed
+			 */
+			bool update(	ShapePtr aShape,
+							const Rect& aBoundingBox);
+			/**
+			 *
+			 */
+			bool contains( ShapePtr aShape) const;
+			/**
+			 * The bounding box aShape was inserted or last updated with, an empty Rect if it is not in the index
+			 */
+			Rect getBoundingBox( ShapePtr aShape) const;
+			/**
+			 * The shapes whose bounding box intersects anArea, in the order they were inserted
+			 */
+			std::vector< ShapePtr > find( const Rect& anArea) const;
+			/**
+			 *
+			 */
+			void clear();
+			/**
+			 *
+			 */
+			std::size_t size() const
+			{
+				return entries.size();
+			}
+			/**
+			 * @name Debug functions
+			 */
+			//@{
+			/**
+			 * Returns a 1-line description of the object
+			 */
+			std::string asString() const;
+			//@}
+
+		private:
+			/**
+			 *
+			 */
+			struct Entry
+			{
+					ShapePtr shape;
+					Rect boundingBox;
+					unsigned long sequence;
+			};
+			typedef std::uint64_t CellKey;
+
+			/**
+			 * The cell that contains aCoordinate, rounded towards minus infinity
+			 */
+			int cellFor( int aCoordinate) const;
+			/**
+			 *
+			 */
+			static CellKey cellKeyFor(	int aCellX,
+										int aCellY);
+			/**
+			 *
+			 */
+			void addToCells(	Shape* aShape,
+								const Rect& aBoundingBox);
+			/**
+			 *
+			 */
+			void removeFromCells(	Shape* aShape,
+									const Rect& aBoundingBox);
+
+			int cellSize;
+			std::unordered_map< Shape*, Entry > entries;
+			std::unordered_map< CellKey, std::vector< Shape* > > cells;
+			unsigned long nextSequence;
+	};
+	// class ShapeIndex
+} // namespace View
+#endif // SHAPEINDEX_HPP_
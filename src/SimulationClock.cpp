@@ -0,0 +1,410 @@
+#include "SimulationClock.hpp"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include "WorkStealingPool.hpp"
+
+namespace Model
+{
+	/**
+	 * True while the thread is calling handleTick, detach must not wait for the tick it is called from
+	 */
+	static thread_local bool handlingTick = false;
+
+	/**
+	 *
+	 */
+	/* static */SimulationClock& SimulationClock::getSimulationClock()
+	{
+		static SimulationClock simulationClock( static_cast< unsigned short >(std::max( 2U, std::thread::hardware_concurrency()) - 1));
+		return simulationClock;
+	}
+	/**
+	 *
+	 */
+	SimulationClock::SimulationClock( unsigned short aNumberOfWorkers /*= 0*/) :
+								numberOfWorkers( aNumberOfWorkers),
+								// Getting the pool here makes sure it outlives a static clock
+								workStealingPool( aNumberOfWorkers > 0 ? &Base::WorkStealingPool::getWorkStealingPool() : nullptr),
+								mode( Mode::RealTime),
+								timeStep( 100),
+								tick( 0),
+								simulatedTime( 0),
+								running( false),
+								nextTickHandler( 0),
+								doneTickHandlers( 0),
+								tickGeneration( 0),
+								activeWorkers( 0),
+								pendingHelpers( 0)
+	{
+	}
+	/**
+	 *
+	 */
+	SimulationClock::~SimulationClock()
+	{
+		stop();
+	}
+	/**
+	 *
+	 */
+	void SimulationClock::attach( TickHandler* aTickHandler)
+	{
+		{
+			std::lock_guard< std::mutex > lock( tickHandlersMutex);
+			if (std::find( tickHandlers.begin(), tickHandlers.end(), aTickHandler) == tickHandlers.end())
+			{
+				tickHandlers.push_back( aTickHandler);
+			}
+		}
+		// A paused clock only runs the ticks of step(), it needs no thread
+		if (mode != Mode::Paused)
+		{
+			start();
+		}
+
+		std::lock_guard< std::mutex > lock( clockMutex);
+		modeChanged.notify_all();
+	}
+	/**
+	 *
+	 */
+	void SimulationClock::detach( TickHandler* aTickHandler)
+	{
+		{
+			std::lock_guard< std::mutex > lock( tickHandlersMutex);
+			tickHandlers.erase( std::remove( tickHandlers.begin(), tickHandlers.end(), aTickHandler), tickHandlers.end());
+		}
+		if (!handlingTick)
+		{
+			// Wait for the tick that may still be calling aTickHandler
+			std::lock_guard< std::mutex > lock( tickMutex);
+		}
+	}
+	/**
+	 *
+	 */
+	void SimulationClock::attachPostTickHandler( TickHandler* aTickHandler)
+	{
+		std::lock_guard< std::mutex > lock( tickHandlersMutex);
+		if (std::find( postTickHandlers.begin(), postTickHandlers.end(), aTickHandler) == postTickHandlers.end())
+		{
+			postTickHandlers.push_back( aTickHandler);
+		}
+	}
+	/**
+	 *
+	 */
+	void SimulationClock::detachPostTickHandler( TickHandler* aTickHandler)
+	{
+		{
+			std::lock_guard< std::mutex > lock( tickHandlersMutex);
+			postTickHandlers.erase( std::remove( postTickHandlers.begin(), postTickHandlers.end(), aTickHandler), postTickHandlers.end());
+		}
+		if (!handlingTick)
+		{
+			std::lock_guard< std::mutex > lock( tickMutex);
+		}
+	}
+	/**
+	 *
+	 */
+	void SimulationClock::setMode( Mode aMode)
+	{
+		{
+			std::lock_guard< std::mutex > lock( clockMutex);
+			mode = aMode;
+			modeChanged.notify_all();
+		}
+		if (aMode != Mode::Paused)
+		{
+			bool idle;
+			{
+				std::lock_guard< std::mutex > tickHandlersLock( tickHandlersMutex);
+				idle = tickHandlers.empty();
+			}
+			if (!idle)
+			{
+				start();
+			}
+		}
+	}
+	/**
+	 *
+	 */
+	void SimulationClock::setTimeStep( std::chrono::milliseconds aTimeStep)
+	{
+		if (aTimeStep.count() <= 0)
+		{
+			throw std::invalid_argument( "SimulationClock::setTimeStep: the time step must be positive");
+		}
+		timeStep = static_cast< long >(aTimeStep.count());
+	}
+	/**
+	 *
+	 */
+	void SimulationClock::step( unsigned long aNumberOfTicks /*= 1*/)
+	{
+		for (unsigned long i = 0; i < aNumberOfTicks; ++i)
+		{
+			runTick();
+		}
+	}
+	/**
+	 *
+	 */
+	void SimulationClock::start()
+	{
+		std::lock_guard< std::mutex > lock( clockMutex);
+		if (!running)
+		{
+			running = true;
+			std::thread newClockThread( [this]
+			{	run();});
+			clockThread.swap( newClockThread);
+		}
+	}
+	/**
+	 *
+	 */
+	void SimulationClock::stop()
+	{
+		bool wasRunning;
+		{
+			std::lock_guard< std::mutex > lock( clockMutex);
+			wasRunning = running;
+			running = false;
+			modeChanged.notify_all();
+		}
+		if (wasRunning)
+		{
+			clockThread.join();
+		}
+
+		// A clock that was only stepped has no thread but may still have helpers on the pool
+		std::unique_lock< std::mutex > lock( workMutex);
+		workDone.wait( lock, [this]
+		{	return pendingHelpers == 0;});
+	}
+	/**
+	 *
+	 */
+	void SimulationClock::run()
+	{
+		typedef std::chrono::steady_clock Clock;
+
+		Clock::time_point nextTickTime = Clock::now();
+		std::unique_lock< std::mutex > lock( clockMutex);
+		while (running)
+		{
+			bool idle;
+			{
+				std::lock_guard< std::mutex > tickHandlersLock( tickHandlersMutex);
+				idle = tickHandlers.empty();
+			}
+			if (mode == Mode::Paused || idle)
+			{
+				modeChanged.wait( lock);
+				nextTickTime = Clock::now();
+				continue;
+			}
+			if (mode == Mode::RealTime && Clock::now() < nextTickTime)
+			{
+				modeChanged.wait_until( lock, nextTickTime);
+				continue;
+			}
+
+			lock.unlock();
+			runTick();
+			lock.lock();
+
+			Clock::time_point now = Clock::now();
+			if (mode == Mode::RealTime)
+			{
+				// Late ticks are not caught up, that would only make the next ones late as well
+				nextTickTime = std::max( nextTickTime + std::chrono::milliseconds( timeStep.load()), now);
+			} else
+			{
+				nextTickTime = now;
+			}
+		}
+	}
+	/**
+	 *
+	 */
+	void SimulationClock::runTick()
+	{
+		std::lock_guard< std::mutex > tickLock( tickMutex);
+
+		bool haveTickHandlers;
+		{
+			std::unique_lock< std::mutex > lock( workMutex);
+			workDone.wait( lock, [this]
+			{	return activeWorkers == 0;});
+			{
+				std::lock_guard< std::mutex > tickHandlersLock( tickHandlersMutex);
+				// Assignment reuses the capacity of currentTickHandlers
+				currentTickHandlers = tickHandlers;
+			}
+			nextTickHandler = 0;
+			doneTickHandlers = 0;
+			haveTickHandlers = !currentTickHandlers.empty();
+			if (haveTickHandlers)
+			{
+				++tickGeneration;
+				// The calling thread takes part as well, a helper for a single handler would only be in the way
+				std::size_t helpers = workStealingPool ? std::min< std::size_t >( numberOfWorkers, currentTickHandlers.size() - 1) : 0;
+				for (std::size_t i = 0; i < helpers; ++i)
+				{
+					++pendingHelpers;
+					unsigned long generation = tickGeneration;
+					workStealingPool->submit( [this, generation]
+					{	help( generation);}, "tick");
+				}
+			}
+		}
+
+		if (haveTickHandlers)
+		{
+			handleTicks();
+
+			std::unique_lock< std::mutex > lock( workMutex);
+			workDone.wait( lock, [this]
+			{	return doneTickHandlers == currentTickHandlers.size();});
+		}
+
+		std::vector< TickHandler* > currentPostTickHandlers;
+		{
+			std::lock_guard< std::mutex > tickHandlersLock( tickHandlersMutex);
+			currentPostTickHandlers = postTickHandlers;
+		}
+		handlingTick = true;
+		for (TickHandler* postTickHandler : currentPostTickHandlers)
+		{
+			try
+			{
+				postTickHandler->handleTick( tick);
+			}
+			catch (std::exception& e)
+			{
+				std::cerr << __PRETTY_FUNCTION__ << ": " << e.what() << std::endl;
+			}
+			catch (...)
+			{
+				std::cerr << __PRETTY_FUNCTION__ << ": unknown exception" << std::endl;
+			}
+		}
+		handlingTick = false;
+
+		++tick;
+		simulatedTime += timeStep;
+	}
+	/**
+	 *
+	 */
+	void SimulationClock::help( unsigned long aGeneration)
+	{
+		std::unique_lock< std::mutex > lock( workMutex);
+		// A helper that only gets a worker after its tick is done must leave the next tick alone
+		if (aGeneration == tickGeneration)
+		{
+			++activeWorkers;
+			lock.unlock();
+			handleTicks();
+			lock.lock();
+			--activeWorkers;
+		}
+		--pendingHelpers;
+		workDone.notify_all();
+	}
+	/**
+	 *
+	 */
+	void SimulationClock::handleTicks()
+	{
+		handlingTick = true;
+		unsigned long currentTick = tick;
+		for (;;)
+		{
+			std::size_t index = nextTickHandler++;
+			if (index >= currentTickHandlers.size())
+			{
+				break;
+			}
+			try
+			{
+				currentTickHandlers[index]->handleTick( currentTick);
+			}
+			catch (std::exception& e)
+			{
+				std::cerr << __PRETTY_FUNCTION__ << ": " << e.what() << std::endl;
+			}
+			catch (...)
+			{
+				std::cerr << __PRETTY_FUNCTION__ << ": unknown exception" << std::endl;
+			}
+			if (++doneTickHandlers == currentTickHandlers.size())
+			{
+				std::lock_guard< std::mutex > lock( workMutex);
+				workDone.notify_all();
+			}
+		}
+		handlingTick = false;
+	}
+	/**
+	 *
+	 */
+	/* static */std::string SimulationClock::asString( Mode aMode)
+	{
+		switch (aMode)
+		{
+			case Mode::RealTime:
+				return "realtime";
+			case Mode::Accelerated:
+				return "accelerated";
+			case Mode::Paused:
+				return "paused";
+		}
+		return "unknown";
+	}
+	/**
+	 *
+	 */
+	/* static */SimulationClock::Mode SimulationClock::modeFromString( const std::string& aMode)
+	{
+		if (aMode == "realtime")
+		{
+			return Mode::RealTime;
+		}
+		if (aMode == "accelerated")
+		{
+			return Mode::Accelerated;
+		}
+		if (aMode == "paused")
+		{
+			return Mode::Paused;
+		}
+		throw std::invalid_argument( "SimulationClock::modeFromString: unknown mode " + aMode);
+	}
+	/**
+	 *
+	 */
+	std::string SimulationClock::asString() const
+	{
+		std::ostringstream os;
+		os << "SimulationClock: " << asString( mode) << ", tick " << tick << ", simulated time " << simulatedTime << " ms";
+		return os.str();
+	}
+	/**
+	 *
+	 */
+	std::string SimulationClock::asDebugString() const
+	{
+		std::ostringstream os;
+		os << asString() << ", time step " << timeStep << " ms, " << numberOfWorkers << " workers";
+		std::lock_guard< std::mutex > lock( tickHandlersMutex);
+		os << ", " << tickHandlers.size() << " tick handlers";
+		return os.str();
+	}
+} // namespace Model
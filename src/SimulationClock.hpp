@@ -0,0 +1,235 @@
+#ifndef SIMULATIONCLOCK_HPP_
+#define SIMULATIONCLOCK_HPP_
+
+#include "Config.hpp"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "Thread.hpp"
+
+namespace Base
+{
+	class WorkStealingPool;
+} // namespace Base
+
+namespace Model
+{
+	/**
+	 * Anything that is advanced by the SimulationClock
+	 */
+	class TickHandler
+	{
+		public:
+			/**
+			 *
+			 */
+			virtual ~TickHandler()
+			{
+			}
+			/**
+			 * Advances the handler by one time step of the SimulationClock. The handlers of one tick are
+			 * called in parallel, a tick only starts when all handlers of the previous tick have returned.
+			 */
+			virtual void handleTick( unsigned long aTick) = 0;
+	};
+	// class TickHandler
+
+	/**
+	 * The simulation clock of a RobotWorld: advances all attached TickHandlers in discrete ticks of a fixed
+	 * simulated time step, independent of how long a tick takes on the wall clock.
+	 *
+	 * In RealTime mode a tick starts every time step of wall-clock time (late ticks are not caught up),
+	 * in Accelerated mode the next tick starts as soon as the previous one is done and in Paused mode
+	 * no ticks are run except those requested with step(). A Paused clock has no thread of its own,
+	 * so the many worlds of a sweep only use the threads of the WorkStealingPool.
+	 */
+	class SimulationClock
+	{
+		public:
+			/**
+			 *
+			 */
+			enum class Mode
+			{
+				RealTime, Accelerated, Paused
+			};
+			/**
+			 * The clock of the default RobotWorld
+			 */
+			static SimulationClock& getSimulationClock();
+			/**
+			 * The handlers of a tick are called on the clock thread, or the thread that calls step(), helped by
+			 * up to aNumberOfWorkers tasks on the shared WorkStealingPool. With 0 workers the pool is not used.
+			 */
+			explicit SimulationClock( unsigned short aNumberOfWorkers = 0);
+			/**
+			 *
+			 */
+			~SimulationClock();
+			/**
+			 *
+			 */
+			SimulationClock( const SimulationClock& aSimulationClock) = delete;
+			/**
+			 *
+			 */
+			SimulationClock& operator=( const SimulationClock& aSimulationClock) = delete;
+			/**
+			 * Starts the clock thread if it is not running yet, unless the clock is Paused
+			 */
+			void attach( TickHandler* aTickHandler);
+			/**
+			 * When this function returns aTickHandler is not being called by the clock anymore,
+			 * unless it is called from within aTickHandler->handleTick.
+			 */
+			void detach( TickHandler* aTickHandler);
+			/**
+			 * aTickHandler is called after all TickHandlers of every tick, one after the other on the thread
+			 * that runs the tick. Unlike a TickHandler it does not keep the clock ticking.
+			 */
+			void attachPostTickHandler( TickHandler* aTickHandler);
+			/**
+			 * @see detach
+			 */
+			void detachPostTickHandler( TickHandler* aTickHandler);
+			/**
+			 *
+			 */
+			Mode getMode() const
+			{
+				return mode;
+			}
+			/**
+			 * Leaving the Paused mode starts the clock thread if there are TickHandlers
+			 */
+			void setMode( Mode aMode);
+			/**
+			 *
+			 */
+			std::chrono::milliseconds getTimeStep() const
+			{
+				return std::chrono::milliseconds( timeStep.load());
+			}
+			/**
+			 *
+			 */
+			void setTimeStep( std::chrono::milliseconds aTimeStep);
+			/**
+			 *
+			 * @return the number of ticks since the clock was created
+			 */
+			unsigned long getTick() const
+			{
+				return tick;
+			}
+			/**
+			 *
+			 * @return the simulated time since the clock was created
+			 */
+			std::chrono::milliseconds getSimulatedTime() const
+			{
+				return std::chrono::milliseconds( simulatedTime.load());
+			}
+			/**
+			 * Runs aNumberOfTicks ticks on the calling thread (and the worker pool), whatever the mode.
+			 * Intended for the Paused mode and for tests, it does not start the clock thread.
+			 */
+			void step( unsigned long aNumberOfTicks = 1);
+			/**
+			 * Stops the clock thread and waits for the helper tasks
+			 */
+			void stop();
+			/**
+			 *
+			 */
+			static std::string asString( Mode aMode);
+			/**
+			 * @throws std::invalid_argument if aMode is not "realtime", "accelerated" or "paused"
+			 */
+			static Mode modeFromString( const std::string& aMode);
+			/**
+			 * @name Debug functions
+			 */
+			//@{
+			/**
+			 * Returns a 1-line description of the object
+			 */
+			std::string asString() const;
+			/**
+			 * Returns a description of the object with all data of the object usable for debugging
+			 */
+			std::string asDebugString() const;
+			//@}
+
+		private:
+			/**
+			 * Starts the clock thread if it is not running yet
+			 */
+			void start();
+			/**
+			 * The clock thread
+			 */
+			void run();
+			/**
+			 * Runs one tick: submits the helper tasks and calls handlers until all are done
+			 */
+			void runTick();
+			/**
+			 * The helper task, it calls handlers of the tick of aGeneration if that tick is still running
+			 */
+			void help( unsigned long aGeneration);
+			/**
+			 * Calls the handlers of the current tick until there are no more left
+			 */
+			void handleTicks();
+
+			unsigned short numberOfWorkers;
+			/**
+			 * nullptr if there are no workers
+			 */
+			Base::WorkStealingPool* workStealingPool;
+			std::atomic< Mode > mode;
+			std::atomic< long > timeStep;
+			std::atomic< unsigned long > tick;
+			std::atomic< long > simulatedTime;
+			std::atomic< bool > running;
+
+			std::vector< TickHandler* > tickHandlers;
+			std::vector< TickHandler* > postTickHandlers;
+			mutable std::mutex tickHandlersMutex;
+
+			/**
+			 * Held for the duration of a tick
+			 */
+			std::mutex tickMutex;
+			/**
+			 * The handlers of the current tick, the index of the next one to call and the number that are done
+			 */
+			std::vector< TickHandler* > currentTickHandlers;
+			std::atomic< std::size_t > nextTickHandler;
+			std::atomic< std::size_t > doneTickHandlers;
+			/**
+			 * Incremented for every tick that has handlers, a helper task of an older generation does nothing
+			 */
+			unsigned long tickGeneration;
+			/**
+			 * The number of helper tasks calling handlers. The handlers of the next tick are only
+			 * handed out when this is 0.
+			 */
+			unsigned short activeWorkers;
+			/**
+			 * The number of submitted helper tasks that have not finished yet
+			 */
+			unsigned long pendingHelpers;
+			std::mutex workMutex;
+			std::condition_variable workDone;
+
+			std::thread clockThread;
+			std::mutex clockMutex;
+			std::condition_variable modeChanged;
+	};
+	// class SimulationClock
+} // namespace Model
+#endif // SIMULATIONCLOCK_HPP_
@@ -8,6 +8,74 @@
  * Author: jkr
  */
 
+#include "Config.hpp"
+
+#ifdef ROBOTWORLD_HEADLESS
+
+namespace Widgets
+{
+	/**
+	 * The headless replacement of wxSize, it only offers what the model uses
+	 */
+	class Size
+	{
+		public:
+			/**
+			 *
+			 */
+			Size() :
+							x( 0),
+							y( 0)
+			{
+			}
+			/**
+			 *
+			 */
+			Size(	int aWidth,
+					int aHeight) :
+							x( aWidth),
+							y( aHeight)
+			{
+			}
+			/**
+			 *
+			 */
+			bool operator==( const Size& aSize) const
+			{
+				return x == aSize.x && y == aSize.y;
+			}
+			/**
+			 *
+			 */
+			bool operator!=( const Size& aSize) const
+			{
+				return !(*this == aSize);
+			}
+			/**
+			 *
+			 */
+			int GetWidth() const
+			{
+				return x;
+			}
+			/**
+			 *
+			 */
+			int GetHeight() const
+			{
+				return y;
+			}
+
+			int x;
+			int y;
+	};
+	// class Size
+} // namespace Widgets
+
+#define DefaultSize Widgets::Size( -1, -1)
+
+#else
+
 #include <wx/gdicmn.h>
 
 namespace Widgets
@@ -17,6 +85,11 @@ namespace Widgets
 	 */
 	typedef wxSize Size;
 } // namespace Widgets
+
+#define DefaultSize wxDefaultSize
+
+#endif // ROBOTWORLD_HEADLESS
+
 using namespace Widgets;
 
 
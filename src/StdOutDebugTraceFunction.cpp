@@ -5,6 +5,10 @@ namespace Base
 {
 	void StdOutDebugTraceFunction::trace( const std::string& aText)
 	{
-		std::cout << aText << std::endl;
+		std::cout << aText << '\n';
+	}
+	void StdOutDebugTraceFunction::flush()
+	{
+		std::cout.flush();
 	}
 } // namespace Base
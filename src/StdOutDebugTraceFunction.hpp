@@ -17,6 +17,10 @@ namespace Base
 			 * @param aText The text that will be send to the final trace destination.
 			 */
 			virtual void trace( const std::string& aText);
+			/**
+			 *
+			 */
+			virtual void flush();
 
 	};
 	// class StdOutDebugTraceFunction
@@ -0,0 +1,406 @@
+#include "TraceLog.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define ROBOTWORLD_HAS_MMAP
+#endif
+
+namespace Base
+{
+	namespace
+	{
+		/**
+		 * The first bytes of the file
+		 */
+		struct TraceFileHeader
+		{
+				char magic[8];
+				std::uint32_t version;
+				std::uint32_t recordSize;
+				/**
+				 * The system time in nanoseconds since the epoch at timestamp 0
+				 */
+				std::uint64_t startTime;
+				std::uint64_t reserved[5];
+		};
+		static_assert( sizeof(TraceRecord) == 32, "A TraceRecord must be 32 bytes");
+		static_assert( sizeof(TraceFileHeader) % sizeof(TraceRecord) == 0, "The header must take a whole number of slots");
+
+		const char Magic[8] = { 'R', 'W', 'T', 'R', 'A', 'C', 'E', '\0' };
+		const std::uint32_t Version = 1;
+		/**
+		 * A multiple of the page size, so every chunk can be mapped on its own
+		 */
+		const std::size_t ChunkBytes = 1 << 20;
+		const std::size_t RecordsPerChunk = ChunkBytes / sizeof(TraceRecord);
+		/**
+		 * At most 4 GiB of trace
+		 */
+		const std::size_t MaximumChunks = 4096;
+		const std::uint64_t HeaderSlots = sizeof(TraceFileHeader) / sizeof(TraceRecord);
+
+		/**
+		 * The names of an event and of its payloads, nullptr if the payload has no meaning
+		 */
+		struct EventDescription
+		{
+				TraceEvent event;
+				const char* name;
+				const char* beginArguments[2];
+				const char* endArguments[2];
+		};
+		const EventDescription eventDescriptions[] = {
+			{ TraceEvent::RobotTick, "RobotTick", { "tick", "robot" }, { nullptr, nullptr } },
+			{ TraceEvent::RouteSearch, "RouteSearch", { "distance", nullptr }, { "expansions", "vertices" } },
+			{ TraceEvent::MessageSend, "MessageSend", { "type", "length" }, { nullptr, nullptr } },
+			{ TraceEvent::MessageReceive, "MessageReceive", { "type", "length" }, { nullptr, nullptr } },
+			{ TraceEvent::Notification, "Notification", { "observers", nullptr }, { nullptr, nullptr } },
+			{ TraceEvent::ChangeEvent, "ChangeEvent", { "object", "fields" }, { nullptr, nullptr } }
+		};
+		/**
+		 *
+		 */
+		const EventDescription* descriptionOf( std::uint16_t anEvent)
+		{
+			for (const EventDescription& description : eventDescriptions)
+			{
+				if (static_cast< std::uint16_t >(description.event) == anEvent)
+				{
+					return &description;
+				}
+			}
+			return nullptr;
+		}
+		/**
+		 * The number of the calling thread in the trace
+		 */
+		std::uint32_t traceThread()
+		{
+			static std::atomic< std::uint32_t > nextThread( 1);
+			thread_local std::uint32_t thread = nextThread.fetch_add( 1, std::memory_order_relaxed);
+			return thread;
+		}
+	} // namespace
+
+	/**
+	 *
+	 */
+	/* static */TraceLog& TraceLog::getTraceLog()
+	{
+		static TraceLog traceLog;
+		return traceLog;
+	}
+	/**
+	 *
+	 */
+	TraceLog::TraceLog() :
+						fileDescriptor( -1),
+						enabled( false),
+						writers( 0),
+						nextSlot( HeaderSlots),
+						dropped( 0),
+						chunks( new std::atomic< char* >[MaximumChunks])
+	{
+		for (std::size_t i = 0; i < MaximumChunks; ++i)
+		{
+			chunks[i].store( nullptr, std::memory_order_relaxed);
+		}
+	}
+	/**
+	 *
+	 */
+	TraceLog::~TraceLog()
+	{
+		close();
+	}
+	/**
+	 *
+	 */
+	void TraceLog::open( const std::string& aFileName)
+	{
+#ifdef ROBOTWORLD_HAS_MMAP
+		std::lock_guard< std::mutex > lock( chunksMutex);
+		if (fileDescriptor != -1)
+		{
+			throw std::runtime_error( "The trace is open already: " + fileName);
+		}
+
+		fileDescriptor = ::open( aFileName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if (fileDescriptor == -1)
+		{
+			throw std::runtime_error( "Can not create " + aFileName + ": " + std::strerror( errno));
+		}
+		fileName = aFileName;
+		nextSlot = HeaderSlots;
+		dropped = 0;
+
+		char* firstChunk = mapChunk( 0);
+		if (!firstChunk)
+		{
+			::close( fileDescriptor);
+			fileDescriptor = -1;
+			throw std::runtime_error( "Can not map " + aFileName + ": " + std::strerror( errno));
+		}
+
+		TraceFileHeader header;
+		std::memset( &header, 0, sizeof(header));
+		std::memcpy( header.magic, Magic, sizeof(Magic));
+		header.version = Version;
+		header.recordSize = sizeof(TraceRecord);
+		header.startTime = static_cast< std::uint64_t >(std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::system_clock::now().time_since_epoch()).count());
+		std::memcpy( firstChunk, &header, sizeof(header));
+
+		start = std::chrono::steady_clock::now();
+		enabled = true;
+#else
+		throw std::runtime_error( "Tracing needs memory-mapped files, can not trace to " + aFileName);
+#endif
+	}
+	/**
+	 *
+	 */
+	void TraceLog::close()
+	{
+#ifdef ROBOTWORLD_HAS_MMAP
+		enabled = false;
+		// A thread that saw enabled before it was cleared may still be writing into a chunk
+		while (writers.load() != 0)
+		{
+			std::this_thread::yield();
+		}
+
+		std::lock_guard< std::mutex > lock( chunksMutex);
+		if (fileDescriptor == -1)
+		{
+			return;
+		}
+
+		// Only the slots that were handed out, the rest of the last chunk was never written
+		std::uint64_t slots = std::min( nextSlot.load(), static_cast< std::uint64_t >(MaximumChunks * RecordsPerChunk));
+		unmapAll();
+		if (::ftruncate( fileDescriptor, static_cast< off_t >(slots * sizeof(TraceRecord))) != 0)
+		{
+			// The records are there, only followed by empty ones that read() skips
+		}
+		::close( fileDescriptor);
+		fileDescriptor = -1;
+#endif
+	}
+	/**
+	 *
+	 */
+	void TraceLog::trace(	TraceEvent anEvent,
+							TracePhase aPhase,
+							std::uint64_t aPayload0 /*= 0*/,
+							std::uint64_t aPayload1 /*= 0*/)
+	{
+		if (!isEnabled())
+		{
+			return;
+		}
+
+		writers.fetch_add( 1);
+		// Checked again, close may have started between the first check and the increment
+		if (isEnabled())
+		{
+			std::uint64_t slot = nextSlot.fetch_add( 1, std::memory_order_relaxed);
+			std::size_t chunk = static_cast< std::size_t >(slot / RecordsPerChunk);
+			char* chunkBase = chunk < MaximumChunks ? chunks[chunk].load( std::memory_order_acquire) : nullptr;
+			if (!chunkBase && chunk < MaximumChunks)
+			{
+				std::lock_guard< std::mutex > lock( chunksMutex);
+				chunkBase = mapChunk( chunk);
+			}
+
+			if (chunkBase)
+			{
+				TraceRecord* record = reinterpret_cast< TraceRecord* >(chunkBase) + (slot % RecordsPerChunk);
+				record->timestamp = static_cast< std::uint64_t >(std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - start).count());
+				record->thread = traceThread();
+				record->event = static_cast< std::uint16_t >(anEvent);
+				record->reserved = 0;
+				record->payload[0] = aPayload0;
+				record->payload[1] = aPayload1;
+				record->phase = static_cast< std::uint8_t >(aPhase);
+			} else
+			{
+				dropped.fetch_add( 1, std::memory_order_relaxed);
+			}
+		}
+		writers.fetch_sub( 1);
+	}
+	/**
+	 *
+	 */
+	unsigned long TraceLog::getRecorded() const
+	{
+		return static_cast< unsigned long >(nextSlot.load( std::memory_order_relaxed) - HeaderSlots);
+	}
+	/**
+	 *
+	 */
+	/* static */std::vector< TraceRecord > TraceLog::read( const std::string& aFileName)
+	{
+		std::ifstream file( aFileName.c_str(), std::ios::binary);
+		if (!file)
+		{
+			throw std::runtime_error( "Can not open " + aFileName);
+		}
+
+		TraceFileHeader header;
+		if (!file.read( reinterpret_cast< char* >(&header), sizeof(header)) ||
+			std::memcmp( header.magic, Magic, sizeof(Magic)) != 0 ||
+			header.version != Version ||
+			header.recordSize != sizeof(TraceRecord))
+		{
+			throw std::runtime_error( "Not a trace file of version " + std::to_string( Version) + ": " + aFileName);
+		}
+
+		std::vector< TraceRecord > records;
+		TraceRecord record;
+		while (file.read( reinterpret_cast< char* >(&record), sizeof(record)))
+		{
+			if (record.phase != 0)
+			{
+				records.push_back( record);
+			}
+		}
+		return records;
+	}
+	/**
+	 *
+	 */
+	/* static */void TraceLog::writeChromeTrace(	const std::vector< TraceRecord >& someRecords,
+												std::ostream& os)
+	{
+		os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+		bool first = true;
+		for (const TraceRecord& record : someRecords)
+		{
+			const EventDescription* description = descriptionOf( record.event);
+			const char* const* arguments = description ? (record.phase == static_cast< std::uint8_t >(TracePhase::End) ? description->endArguments : description->beginArguments) : nullptr;
+
+			os << (first ? "\n" : ",\n");
+			first = false;
+			os << "{\"name\":\"" << (description ? description->name : std::to_string( record.event)) << "\""
+			   << ",\"cat\":\"robotworld\""
+			   << ",\"ph\":\"" << static_cast< char >(record.phase) << "\""
+			   << ",\"ts\":" << (record.timestamp / 1000) << "." << (record.timestamp % 1000 / 100)
+			   << ",\"pid\":1"
+			   << ",\"tid\":" << record.thread;
+			if (record.phase == static_cast< std::uint8_t >(TracePhase::Instant))
+			{
+				os << ",\"s\":\"t\"";
+			}
+			os << ",\"args\":{";
+			bool firstArgument = true;
+			for (std::size_t i = 0; i < 2; ++i)
+			{
+				if (arguments && arguments[i])
+				{
+					os << (firstArgument ? "" : ",") << "\"" << arguments[i] << "\":" << record.payload[i];
+					firstArgument = false;
+				}
+			}
+			os << "}}";
+		}
+		os << "\n]}\n";
+	}
+	/**
+	 *
+	 */
+	/* static */void TraceLog::writeCsv(	const std::vector< TraceRecord >& someRecords,
+										std::ostream& os)
+	{
+		os << "timestamp_ns,thread,event,phase,payload0,payload1\n";
+		for (const TraceRecord& record : someRecords)
+		{
+			const EventDescription* description = descriptionOf( record.event);
+			os << record.timestamp << ","
+			   << record.thread << ","
+			   << (description ? description->name : std::to_string( record.event)) << ","
+			   << static_cast< char >(record.phase) << ","
+			   << record.payload[0] << ","
+			   << record.payload[1] << "\n";
+		}
+	}
+	/**
+	 *
+	 */
+	/* static */std::string TraceLog::nameOf( TraceEvent anEvent)
+	{
+		const EventDescription* description = descriptionOf( static_cast< std::uint16_t >(anEvent));
+		return description ? description->name : std::to_string( static_cast< std::uint16_t >(anEvent));
+	}
+	/**
+	 *
+	 */
+	std::string TraceLog::asString() const
+	{
+		std::ostringstream os;
+		std::lock_guard< std::mutex > lock( chunksMutex);
+		os << "TraceLog: ";
+		if (fileDescriptor == -1)
+		{
+			os << "closed";
+		} else
+		{
+			os << fileName << ", " << getRecorded() << " records, " << getDropped() << " dropped";
+		}
+		return os.str();
+	}
+	/**
+	 *
+	 */
+	char* TraceLog::mapChunk( std::size_t aChunk)
+	{
+#ifdef ROBOTWORLD_HAS_MMAP
+		char* chunkBase = chunks[aChunk].load( std::memory_order_acquire);
+		if (chunkBase || fileDescriptor == -1)
+		{
+			return chunkBase;
+		}
+
+		off_t offset = static_cast< off_t >(aChunk * ChunkBytes);
+		if (::ftruncate( fileDescriptor, offset + static_cast< off_t >(ChunkBytes)) != 0)
+		{
+			return nullptr;
+		}
+		void* address = ::mmap( nullptr, ChunkBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, offset);
+		if (address == MAP_FAILED)
+		{
+			return nullptr;
+		}
+		chunkBase = static_cast< char* >(address);
+		chunks[aChunk].store( chunkBase, std::memory_order_release);
+		return chunkBase;
+#else
+		UNUSEDCAST( aChunk);
+		return nullptr;
+#endif
+	}
+	/**
+	 *
+	 */
+	void TraceLog::unmapAll()
+	{
+#ifdef ROBOTWORLD_HAS_MMAP
+		for (std::size_t i = 0; i < MaximumChunks; ++i)
+		{
+			char* chunkBase = chunks[i].exchange( nullptr);
+			if (chunkBase)
+			{
+				::munmap( chunkBase, ChunkBytes);
+			}
+		}
+#endif
+	}
+} // namespace Base
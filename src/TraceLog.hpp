@@ -0,0 +1,249 @@
+#ifndef TRACELOG_HPP_
+#define TRACELOG_HPP_
+
+#include "Config.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Thread.hpp"
+
+namespace Base
+{
+	/**
+	 * What a TraceRecord is about. The meaning of the payloads is given per event.
+	 */
+	enum class TraceEvent : std::uint16_t
+	{
+		RobotTick = 1, //!< Begin/End, payloads: the tick and the hash of the ObjectId of the robot
+		RouteSearch, //!< Begin, payload: the distance to the goal; End, payloads: the expansions and the vertices of the path
+		MessageSend, //!< Instant, payloads: the message type and the length of the body
+		MessageReceive, //!< Instant, payloads: the message type and the length of the body
+		Notification, //!< Begin/End, payload: the number of observers
+		ChangeEvent //!< Instant, payloads: the hash of the ObjectId of the object and the changed fields
+	};
+	/**
+	 * The values are those of the "ph" field of the Chrome trace event format
+	 */
+	enum class TracePhase : std::uint8_t
+	{
+		Begin = 'B',
+		End = 'E',
+		Instant = 'i'
+	};
+	/**
+	 * A record of the trace file, 32 bytes in the byte order of the machine that wrote it
+	 */
+	struct TraceRecord
+	{
+			/**
+			 * Nanoseconds since the trace was opened
+			 */
+			std::uint64_t timestamp;
+			/**
+			 * The threads are numbered in the order they first trace
+			 */
+			std::uint32_t thread;
+			std::uint16_t event;
+			/**
+			 * 0 if the record was never written
+			 */
+			std::uint8_t phase;
+			std::uint8_t reserved;
+			std::uint64_t payload[2];
+	};
+
+	/**
+	 * A compact binary trace of what the application does, for offline analysis.
+	 *
+	 * A record is a fixed-size TraceRecord. A thread that traces claims the next slot of the file with
+	 * a single atomic increment and writes the record straight into the memory-mapped file, so tracing
+	 * takes no lock and makes no system call. The file grows in chunks of 1 MiB; only the thread that
+	 * needs a chunk that is not mapped yet takes a lock to map it. If the trace is not open,
+	 * tracing costs a relaxed atomic load.
+	 *
+	 * The file is a 64 byte header followed by the records. robotworld_trace converts it to Chrome
+	 * trace JSON (chrome://tracing, Perfetto) or CSV.
+	 */
+	class TraceLog
+	{
+		public:
+			/**
+			 * The trace of the application
+			 */
+			static TraceLog& getTraceLog();
+			/**
+			 *
+			 */
+			TraceLog();
+			/**
+			 * Closes the trace
+			 */
+			~TraceLog();
+			/**
+			 *
+			 */
+			TraceLog( const TraceLog& aTraceLog) = delete;
+			/**
+			 *
+			 */
+			TraceLog& operator=( const TraceLog& aTraceLog) = delete;
+			/**
+			 * Truncates or creates aFileName and starts tracing into it
+			 *
+			 * @throws std::runtime_error if the file can not be created or mapped, or if the trace is open already
+			 */
+			void open( const std::string& aFileName);
+			/**
+			 * Stops tracing and truncates the file to the records that were written
+			 */
+			void close();
+			/**
+			 *
+			 */
+			bool isEnabled() const
+			{
+				return enabled.load( std::memory_order_relaxed);
+			}
+			/**
+			 * Does nothing if the trace is not open
+			 */
+			void trace(	TraceEvent anEvent,
+						TracePhase aPhase,
+						std::uint64_t aPayload0 = 0,
+						std::uint64_t aPayload1 = 0);
+			/**
+			 * The number of records since the trace was opened
+			 */
+			unsigned long getRecorded() const;
+			/**
+			 * The number of records that did not fit in the file
+			 */
+			unsigned long getDropped() const
+			{
+				return dropped.load( std::memory_order_relaxed);
+			}
+			/**
+			 * @name Conversion functions
+			 */
+			//@{
+			/**
+			 * The records of aFileName that were written, in file order
+			 *
+			 * @throws std::runtime_error if aFileName is not a trace file of this version
+			 */
+			static std::vector< TraceRecord > read( const std::string& aFileName);
+			/**
+			 * Writes someRecords in the Chrome trace event format
+			 */
+			static void writeChromeTrace(	const std::vector< TraceRecord >& someRecords,
+											std::ostream& os);
+			/**
+			 * Writes someRecords as CSV with a header line
+			 */
+			static void writeCsv(	const std::vector< TraceRecord >& someRecords,
+									std::ostream& os);
+			/**
+			 *
+			 */
+			static std::string nameOf( TraceEvent anEvent);
+			//@}
+			/**
+			 * @name Debug functions
+			 */
+			//@{
+			/**
+			 * Returns a 1-line description of the object
+			 */
+			std::string asString() const;
+			//@}
+
+		private:
+			/**
+			 * Maps aChunk, growing the file if needed. The caller holds chunksMutex.
+			 *
+			 * @return nullptr if it can not be mapped
+			 */
+			char* mapChunk( std::size_t aChunk);
+			/**
+			 *
+			 */
+			void unmapAll();
+
+			std::string fileName;
+			int fileDescriptor;
+			std::atomic< bool > enabled;
+			/**
+			 * The threads in trace(), close waits until there are none
+			 */
+			std::atomic< unsigned long > writers;
+			/**
+			 * The next slot of the file, the header takes the first slots
+			 */
+			std::atomic< std::uint64_t > nextSlot;
+			std::atomic< unsigned long > dropped;
+			std::unique_ptr< std::atomic< char* >[] > chunks;
+			std::chrono::steady_clock::time_point start;
+			/**
+			 * Serialises open, close and the mapping of chunks
+			 */
+			mutable std::mutex chunksMutex;
+	};
+	// class TraceLog
+
+	/**
+	 * Traces the Begin of anEvent when it is constructed and the End when it is destructed
+	 */
+	class TraceScope
+	{
+		public:
+			/**
+			 *
+			 */
+			TraceScope(	TraceEvent anEvent,
+						std::uint64_t aPayload0 = 0,
+						std::uint64_t aPayload1 = 0) :
+								event( anEvent),
+								endPayload0( 0),
+								endPayload1( 0)
+			{
+				TraceLog::getTraceLog().trace( event, TracePhase::Begin, aPayload0, aPayload1);
+			}
+			/**
+			 *
+			 */
+			~TraceScope()
+			{
+				TraceLog::getTraceLog().trace( event, TracePhase::End, endPayload0, endPayload1);
+			}
+			/**
+			 *
+			 */
+			TraceScope( const TraceScope& aTraceScope) = delete;
+			/**
+			 *
+			 */
+			TraceScope& operator=( const TraceScope& aTraceScope) = delete;
+			/**
+			 * The payloads of the End record
+			 */
+			void setEndPayload(	std::uint64_t aPayload0,
+								std::uint64_t aPayload1 = 0)
+			{
+				endPayload0 = aPayload0;
+				endPayload1 = aPayload1;
+			}
+
+		private:
+			TraceEvent event;
+			std::uint64_t endPayload0;
+			std::uint64_t endPayload1;
+	};
+	// class TraceScope
+} // namespace Base
+#endif // TRACELOG_HPP_
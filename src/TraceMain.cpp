@@ -0,0 +1,89 @@
+#include "Config.hpp"
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <stdexcept>
+#include "CommandlineArguments.hpp"
+#include "TraceLog.hpp"
+
+namespace
+{
+	typedef Application::CommandlineArguments Arguments;
+
+	/**
+	 *
+	 */
+	std::string getArg(	const std::string& aVariable,
+						const std::string& aDefault)
+	{
+		return Arguments::isArgGiven( aVariable) ? Arguments::getArg( aVariable).value : aDefault;
+	}
+	/**
+	 *
+	 */
+	bool endsWith(	const std::string& aString,
+					const std::string& anEnd)
+	{
+		return aString.size() >= anEnd.size() && aString.compare( aString.size() - anEnd.size(), anEnd.size(), anEnd) == 0;
+	}
+} // namespace
+
+/**
+ * The entry point of robotworld_trace, which converts a binary trace written with -trace=FILE.
+ *
+ * Command line arguments:
+ * -input=FILE				the binary trace
+ * -output=FILE				stdout by default
+ * -format=json|csv			Chrome trace JSON by default, csv if FILE ends with .csv
+ */
+int main( 	int argc,
+			char* argv[])
+{
+	try
+	{
+		Arguments::setCommandlineArguments( argc, argv);
+		if (!Arguments::isArgGiven( "-input"))
+		{
+			std::cerr << "Usage: " << argv[0] << " -input=FILE [-output=FILE] [-format=json|csv]" << std::endl;
+			return 2;
+		}
+
+		std::vector< Base::TraceRecord > records = Base::TraceLog::read( getArg( "-input", ""));
+
+		std::string outputFileName = getArg( "-output", "");
+		std::string format = getArg( "-format", endsWith( outputFileName, ".csv") ? "csv" : "json");
+		if (format != "json" && format != "csv")
+		{
+			throw std::invalid_argument( "No such format: " + format);
+		}
+
+		std::ofstream outputFile;
+		if (!outputFileName.empty())
+		{
+			outputFile.open( outputFileName.c_str());
+			if (!outputFile)
+			{
+				throw std::runtime_error( "Can not create " + outputFileName);
+			}
+		}
+		std::ostream& os = outputFileName.empty() ? std::cout : outputFile;
+
+		if (format == "csv")
+		{
+			Base::TraceLog::writeCsv( records, os);
+		} else
+		{
+			Base::TraceLog::writeChromeTrace( records, os);
+		}
+		return 0;
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << __PRETTY_FUNCTION__ << ": " << e.what() << std::endl;
+	}
+	catch (...)
+	{
+		std::cerr << __PRETTY_FUNCTION__ << ": unknown exception" << std::endl;
+	}
+	return 1;
+}
@@ -1,6 +1,8 @@
 #include "Wall.hpp"
 #include <sstream>
+#include "EventBus.hpp"
 #include "Logger.hpp"
+#include "RobotWorld.hpp"
 #include "Shape2DUtils.hpp"
 
 namespace Model
@@ -8,7 +10,8 @@ namespace Model
 	/**
 	 *
 	 */
-	Wall::Wall()
+	Wall::Wall() :
+								robotWorld( nullptr)
 	{
 	}
 	/**
@@ -17,7 +20,8 @@ namespace Model
 	Wall::Wall( const Point& aPoint1,
 				const Point& aPoint2) :
 								point1( aPoint1),
-								point2( aPoint2)
+								point2( aPoint2),
+								robotWorld( nullptr)
 	{
 	}
 	/**
@@ -33,9 +37,13 @@ namespace Model
 							bool aNotifyObservers /*= true*/)
 	{
 		point1 = aPoint1;
+		if (robotWorld)
+		{
+			robotWorld->wallMoved();
+		}
 		if (aNotifyObservers == true)
 		{
-			notifyObservers();
+			notifyObservers( Base::ChangeEvent::Position);
 		}
 	}
 	/**
@@ -45,9 +53,13 @@ namespace Model
 							bool aNotifyObservers /*= true*/)
 	{
 		point2 = aPoint2;
+		if (robotWorld)
+		{
+			robotWorld->wallMoved();
+		}
 		if (aNotifyObservers == true)
 		{
-			notifyObservers();
+			notifyObservers( Base::ChangeEvent::Position);
 		}
 	}
 	/**
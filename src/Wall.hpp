@@ -7,6 +7,8 @@
 
 namespace Model
 {
+	class RobotWorld;
+
 	class Wall;
 	typedef std::shared_ptr<Wall> WallPtr;
 
@@ -50,6 +52,14 @@ namespace Model
 			 */
 			void setPoint2( const Point& aPoint2,
 							bool aNotifyObservers = true);
+			/**
+			 * The world that is told when the end points change, so that it can drop its caches of the wall
+			 * geometry, e.g. RobotWorld::getWallGrid. Set by the world the wall is in.
+			 */
+			void setRobotWorld( RobotWorld* aRobotWorld)
+			{
+				robotWorld = aRobotWorld;
+			}
 			/**
 			 * @name Debug functions
 			 */
@@ -67,6 +77,7 @@ namespace Model
 		private:
 			Point point1;
 			Point point2;
+			RobotWorld* robotWorld;
 	};
 } // namespace Model
 #endif // WALL_HPP_
@@ -128,6 +128,13 @@ namespace View
 		}
 		return false;
 	}
+	/**
+	 *
+	 */
+	Rect WallShape::getBoundingBox() const
+	{
+		return LineShape::getBoundingBox().Union( getNode1()->getBoundingBox()).Union( getNode2()->getBoundingBox());
+	}
 	/**
 	 *
 	 */
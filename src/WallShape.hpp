@@ -73,6 +73,10 @@ namespace View
 			 * @return True if the point is in the shape
 			 */
 			virtual bool occupies( const Point& aPoint) const;
+			/**
+			 * The line and both end points, as they are part of what occupies returns true for
+			 */
+			virtual Rect getBoundingBox() const;
 			//@}
 			/**
 			 * @name Debug functions
@@ -1,6 +1,8 @@
 #include "WayPoint.hpp"
 #include <sstream>
+#include "EventBus.hpp"
 #include "Logger.hpp"
+#include "RobotWorld.hpp"
 
 namespace Model
 {
@@ -8,14 +10,16 @@ namespace Model
 	 *
 	 */
 	WayPoint::WayPoint( ) :
-								name( "")
+								name( ""),
+								robotWorld( nullptr)
 	{
 	}
 	/**
 	 *
 	 */
 	WayPoint::WayPoint( const std::string& aName) :
-								name( aName)
+								name( aName),
+								robotWorld( nullptr)
 	{
 	}
 	/**
@@ -24,7 +28,8 @@ namespace Model
 	WayPoint::WayPoint( const std::string& aName,
 						const Point& aPosition) :
 								name( aName),
-								position( aPosition)
+								position( aPosition),
+								robotWorld( nullptr)
 	{
 	}
 	/**
@@ -39,10 +44,15 @@ namespace Model
 	void WayPoint::setName( const std::string& aName,
 							bool aNotifyObservers /*= true*/)
 	{
+		std::string oldName = name;
 		name = aName;
+		if (robotWorld)
+		{
+			robotWorld->updateNameIndex( getObjectId(), oldName);
+		}
 		if (aNotifyObservers == true)
 		{
-			notifyObservers();
+			notifyObservers( Base::ChangeEvent::Name);
 		}
 	}
 	/**
@@ -61,7 +71,7 @@ namespace Model
 		size = aSize;
 		if (aNotifyObservers == true)
 		{
-			notifyObservers();
+			notifyObservers( Base::ChangeEvent::Size);
 		}
 	}
 	/**
@@ -73,7 +83,7 @@ namespace Model
 		position = aPosition;
 		if (aNotifyObservers == true)
 		{
-			notifyObservers();
+			notifyObservers( Base::ChangeEvent::Position);
 		}
 	}
 	/**
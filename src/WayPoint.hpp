@@ -9,6 +9,8 @@
 
 namespace Model
 {
+	class RobotWorld;
+
 	class WayPoint;
 	typedef std::shared_ptr<WayPoint> WayPointPtr;
 
@@ -44,6 +46,13 @@ namespace Model
 			 */
 			void setName( const std::string& aName,
 						  bool aNotifyObservers = true);
+			/**
+			 * The world whose name index setName keeps up to date, set by the world the way point is in
+			 */
+			void setRobotWorld( RobotWorld* aRobotWorld)
+			{
+				robotWorld = aRobotWorld;
+			}
 			/**
 			 *
 			 */
@@ -91,6 +100,7 @@ namespace Model
 			std::string name;
 			Size size;
 			Point position;
+			RobotWorld* robotWorld;
 	};
 } // namespace Model
 #endif // WAYPOINT_HPP_
@@ -15,20 +15,7 @@ namespace Application
 	 */
 	void WidgetDebugTraceFunction::trace( const std::string& aText)
 	{
-		// One can create any type of command event here but we use the
-		// LogTextControl provided things
-		CommandEvent event( Application::ROBOTWORLD_TRACE_EVENT);
-		event.SetString( WXSTRING( aText));
-
-		// TODO: should we decide this runtime?
-
-		// If we need synchronous handling of the trace to prevent loosing
-		// messages in case of a crash we must use ProcessEvent. It will
-		// slow down the application though.
-		//         outputCtrl->ProcessEvent(event);
-
-		// In case we can get away with asynchronous event handling
-		// If we do not want to recompile: use StdOutDebugTraceFunction
-		wxPostEvent( outputControl, event);
+		// The LogTextCtrl queues the text and takes it in on the GUI thread, in batches
+		outputControl->log( aText);
 	}
 } // namespace Application
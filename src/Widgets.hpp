@@ -6,8 +6,10 @@
 #include <string>
 
 #include <wx/app.h>
+#include <wx/bitmap.h>
 #include <wx/dc.h>
 #include <wx/dcclient.h>
+#include <wx/dcmemory.h>
 #include <wx/defs.h>
 #include <wx/dnd.h>
 #include <wx/event.h>
@@ -26,9 +28,11 @@
 #include <wx/statline.h>
 #include <wx/toolbar.h>
 #include <wx/listbase.h>
+#include <wx/listctrl.h>
 #include <wx/scrolwin.h>
 #include <wx/sizer.h>
 #include <wx/string.h>
+#include <wx/timer.h>
 #include <wx/treebase.h>
 #include <wx/validate.h>
 #include <wx/generic/textdlgg.h>
@@ -51,6 +55,10 @@ typedef wxActivateEvent ActivateEvent;
  * @see http://docs.wxwidgets.org/stable/
  */
 	typedef wxBoxSizer BoxSizer;
+	/**
+	 * @see http://docs.wxwidgets.org/stable/classwx_bitmap
+	 */
+	typedef wxBitmap Bitmap;
 	/**
 	 * @see http://docs.wxwidgets.org/stable/classwx_brush
 	 */
@@ -163,6 +171,10 @@ typedef wxActivateEvent ActivateEvent;
 	 * @see http://docs.wxwidgets.org/stable/classwx_list_item
 	 */
 	typedef wxListItem ListItem;
+	/**
+	 * @see http://docs.wxwidgets.org/stable/classwx_memory_d_c
+	 */
+	typedef wxMemoryDC MemoryDC;
 	/**classwx_treeevent
 	 * @see http://docs.wxwidgets.org/stable/classwx_menu_bar
 	 */
@@ -199,6 +211,14 @@ typedef wxActivateEvent ActivateEvent;
 	 * @see http://docs.wxwidgets.org/stable/classwx_panel
 	 */
 	typedef wxPanel Panel;
+	/**
+	 * @see http://docs.wxwidgets.org/stable/classwx_rect
+	 */
+	typedef wxRect Rect;
+	/**
+	 * @see http://docs.wxwidgets.org/stable/classwx_region_iterator
+	 */
+	typedef wxRegionIterator RegionIterator;
 	/**
 	 * @see http://docs.wxwidgets.org/stable/classwx_scrolled
 	 */
@@ -239,6 +259,14 @@ typedef wxActivateEvent ActivateEvent;
 	 * @see http://docs.wxwidgets.org/stable/classwx_text_entry_dialog
 	 */
 	typedef wxTextEntryDialog TextEntryDialog;
+	/**
+	 * @see http://docs.wxwidgets.org/stable/classwx_timer
+	 */
+	typedef wxTimer Timer;
+	/**
+	 * @see http://docs.wxwidgets.org/stable/classwx_timer_event
+	 */
+	typedef wxTimerEvent TimerEvent;
 	/**
 	 * @see http://docs.wxwidgets.org/stable/classwx_tool_bar
 	 */
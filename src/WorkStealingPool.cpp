@@ -0,0 +1,384 @@
+#include "WorkStealingPool.hpp"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace Base
+{
+	/**
+	 *
+	 */
+	TaskStatistics::TaskStatistics() :
+								tasks( 0),
+								meanQueueLatency( 0.0),
+								maximumQueueLatency( 0.0),
+								meanRunTime( 0.0),
+								maximumRunTime( 0.0)
+	{
+	}
+	/**
+	 *
+	 */
+	void TaskStatistics::add(	double aQueueLatency,
+								double aRunTime)
+	{
+		++tasks;
+		meanQueueLatency += (aQueueLatency - meanQueueLatency) / static_cast< double >(tasks);
+		meanRunTime += (aRunTime - meanRunTime) / static_cast< double >(tasks);
+		maximumQueueLatency = std::max( maximumQueueLatency, aQueueLatency);
+		maximumRunTime = std::max( maximumRunTime, aRunTime);
+	}
+	/**
+	 *
+	 */
+	void TaskStatistics::merge( const TaskStatistics& aTaskStatistics)
+	{
+		unsigned long total = tasks + aTaskStatistics.tasks;
+		if (total == 0)
+		{
+			return;
+		}
+		meanQueueLatency = (meanQueueLatency * static_cast< double >(tasks) + aTaskStatistics.meanQueueLatency * static_cast< double >(aTaskStatistics.tasks)) / static_cast< double >(total);
+		meanRunTime = (meanRunTime * static_cast< double >(tasks) + aTaskStatistics.meanRunTime * static_cast< double >(aTaskStatistics.tasks)) / static_cast< double >(total);
+		maximumQueueLatency = std::max( maximumQueueLatency, aTaskStatistics.maximumQueueLatency);
+		maximumRunTime = std::max( maximumRunTime, aTaskStatistics.maximumRunTime);
+		tasks = total;
+	}
+	/**
+	 *
+	 */
+	std::string TaskStatistics::asString() const
+	{
+		std::ostringstream os;
+		os << "tasks: " << tasks << ", queue latency mean: " << meanQueueLatency << " us, max: " << maximumQueueLatency << " us, run time mean: " << meanRunTime << " us, max: " << maximumRunTime << " us";
+		return os.str();
+	}
+	/**
+	 * The pool and the index of the queue of the worker that runs on this thread, if any
+	 */
+	static thread_local const WorkStealingPool* currentPool = nullptr;
+	static thread_local std::size_t currentQueue = 0;
+
+	/**
+	 *
+	 */
+	/* static */WorkStealingPool& WorkStealingPool::getWorkStealingPool()
+	{
+		static WorkStealingPool workStealingPool;
+		return workStealingPool;
+	}
+	/**
+	 *
+	 */
+	WorkStealingPool::WorkStealingPool( unsigned short aNumberOfWorkers /*= 0*/) :
+								nextQueue( 0),
+								queued( 0),
+								unfinished( 0),
+								executed( 0),
+								steals( 0),
+								running( true)
+	{
+		std::size_t numberOfWorkers = aNumberOfWorkers != 0 ? aNumberOfWorkers : std::max( 1U, std::thread::hardware_concurrency());
+		for (std::size_t i = 0; i < numberOfWorkers; ++i)
+		{
+			queues.push_back( std::unique_ptr< WorkQueue >( new WorkQueue()));
+		}
+		for (std::size_t i = 0; i < numberOfWorkers; ++i)
+		{
+			workers.push_back( std::thread( [this, i]
+			{	work( i);}));
+		}
+	}
+	/**
+	 *
+	 */
+	WorkStealingPool::~WorkStealingPool()
+	{
+		{
+			// Not wait(): a destructor should not throw
+			std::unique_lock< std::mutex > lock( idleMutex);
+			allDone.wait( lock, [this]
+			{	return unfinished == 0;});
+			running = false;
+			workAvailable.notify_all();
+		}
+		for (std::thread& worker : workers)
+		{
+			worker.join();
+		}
+	}
+	/**
+	 *
+	 */
+	WorkStealingPool::TaskGroup::TaskGroup( WorkStealingPool& aWorkStealingPool) :
+								workStealingPool( aWorkStealingPool),
+								unfinished( 0)
+	{
+	}
+	/**
+	 *
+	 */
+	WorkStealingPool::TaskGroup::~TaskGroup()
+	{
+		// No check for a worker here: a destructor should not throw
+		std::unique_lock< std::mutex > lock( mutex);
+		allDone.wait( lock, [this]
+		{	return unfinished == 0;});
+	}
+	/**
+	 *
+	 */
+	void WorkStealingPool::TaskGroup::submit(	const Task& aTask,
+												const char* aName /*= "task"*/)
+	{
+		{
+			std::lock_guard< std::mutex > lock( mutex);
+			++unfinished;
+		}
+		workStealingPool.enqueue( aTask, aName, this);
+	}
+	/**
+	 *
+	 */
+	void WorkStealingPool::TaskGroup::wait()
+	{
+		if (workStealingPool.isWorker())
+		{
+			throw std::logic_error( "WorkStealingPool::TaskGroup::wait: called by a worker of the pool");
+		}
+		std::unique_lock< std::mutex > lock( mutex);
+		allDone.wait( lock, [this]
+		{	return unfinished == 0;});
+	}
+	/**
+	 *
+	 */
+	void WorkStealingPool::TaskGroup::taskDone()
+	{
+		// Notified under the lock: the waiter may destroy the group as soon as it sees the count drop
+		std::lock_guard< std::mutex > lock( mutex);
+		if (--unfinished == 0)
+		{
+			allDone.notify_all();
+		}
+	}
+	/**
+	 *
+	 */
+	void WorkStealingPool::submit(	const Task& aTask,
+									const char* aName /*= "task"*/)
+	{
+		enqueue( aTask, aName, nullptr);
+	}
+	/**
+	 *
+	 */
+	void WorkStealingPool::enqueue(	const Task& aTask,
+									const char* aName,
+									TaskGroup* aTaskGroup)
+	{
+		++unfinished;
+
+		bool spawned = currentPool == this;
+		std::size_t index = spawned ? currentQueue : nextQueue++ % queues.size();
+		{
+			std::lock_guard< std::mutex > lock( queues[index]->mutex);
+			queues[index]->tasks.push_back( QueuedTask { aTask, aName, aTaskGroup, Clock::now(), spawned });
+		}
+		{
+			// Counting under the idle mutex makes sure a worker that is about to sleep sees the task
+			std::lock_guard< std::mutex > lock( idleMutex);
+			++queued;
+		}
+		workAvailable.notify_one();
+	}
+	/**
+	 *
+	 */
+	void WorkStealingPool::wait()
+	{
+		if (isWorker())
+		{
+			throw std::logic_error( "WorkStealingPool::wait: called by a worker of the pool");
+		}
+		std::unique_lock< std::mutex > lock( idleMutex);
+		allDone.wait( lock, [this]
+		{	return unfinished == 0;});
+	}
+	/**
+	 *
+	 */
+	void WorkStealingPool::work( std::size_t anIndex)
+	{
+		currentPool = this;
+		currentQueue = anIndex;
+
+		QueuedTask task;
+		for (;;)
+		{
+			if (popTask( anIndex, task) || stealTask( anIndex, task))
+			{
+				runTask( anIndex, task);
+				continue;
+			}
+
+			std::unique_lock< std::mutex > lock( idleMutex);
+			workAvailable.wait( lock, [this]
+			{	return !running || queued > 0;});
+			if (!running && queued == 0)
+			{
+				break;
+			}
+		}
+		currentPool = nullptr;
+	}
+	/**
+	 *
+	 */
+	bool WorkStealingPool::popTask(	std::size_t anIndex,
+									QueuedTask& aTask)
+	{
+		WorkQueue& queue = *queues[anIndex];
+		std::lock_guard< std::mutex > lock( queue.mutex);
+		if (queue.tasks.empty())
+		{
+			return false;
+		}
+		if (queue.tasks.back().spawned)
+		{
+			aTask = std::move( queue.tasks.back());
+			queue.tasks.pop_back();
+		} else
+		{
+			aTask = std::move( queue.tasks.front());
+			queue.tasks.pop_front();
+		}
+		--queued;
+		return true;
+	}
+	/**
+	 *
+	 */
+	bool WorkStealingPool::stealTask(	std::size_t anIndex,
+										QueuedTask& aTask)
+	{
+		for (std::size_t i = 1; i < queues.size(); ++i)
+		{
+			WorkQueue& queue = *queues[(anIndex + i) % queues.size()];
+			std::unique_lock< std::mutex > lock( queue.mutex, std::try_to_lock);
+			if (!lock.owns_lock() || queue.tasks.empty())
+			{
+				continue;
+			}
+			aTask = std::move( queue.tasks.front());
+			queue.tasks.pop_front();
+			--queued;
+			++steals;
+			return true;
+		}
+		return false;
+	}
+	/**
+	 *
+	 */
+	bool WorkStealingPool::runPendingTask()
+	{
+		if (!isWorker())
+		{
+			return false;
+		}
+		QueuedTask task;
+		if (popTask( currentQueue, task) || stealTask( currentQueue, task))
+		{
+			runTask( currentQueue, task);
+			return true;
+		}
+		return false;
+	}
+	/**
+	 *
+	 */
+	bool WorkStealingPool::isWorker() const
+	{
+		return currentPool == this;
+	}
+	/**
+	 *
+	 */
+	void WorkStealingPool::runTask(	std::size_t anIndex,
+									QueuedTask& aTask)
+	{
+		Clock::time_point started = Clock::now();
+		try
+		{
+			aTask.task();
+		}
+		catch (std::exception& e)
+		{
+			std::cerr << __PRETTY_FUNCTION__ << ": " << e.what() << std::endl;
+		}
+		catch (...)
+		{
+			std::cerr << __PRETTY_FUNCTION__ << ": unknown exception" << std::endl;
+		}
+		Clock::time_point finished = Clock::now();
+		// Release whatever the task holds before anybody is told it is done
+		aTask.task = nullptr;
+		{
+			WorkQueue& queue = *queues[anIndex];
+			std::lock_guard< std::mutex > lock( queue.statisticsMutex);
+			queue.statistics[aTask.name].add( std::chrono::duration< double, std::micro >( started - aTask.submitted).count(),
+											std::chrono::duration< double, std::micro >( finished - started).count());
+		}
+		++executed;
+
+		if (aTask.group)
+		{
+			aTask.group->taskDone();
+		}
+		if (--unfinished == 0)
+		{
+			std::lock_guard< std::mutex > lock( idleMutex);
+			allDone.notify_all();
+		}
+	}
+	/**
+	 *
+	 */
+	std::string WorkStealingPool::asString() const
+	{
+		std::ostringstream os;
+		os << "WorkStealingPool: " << workers.size() << " workers, " << executed << " tasks executed, " << steals << " stolen, " << unfinished << " unfinished";
+		return os.str();
+	}
+	/**
+	 *
+	 */
+	std::map< std::string, TaskStatistics > WorkStealingPool::getTaskStatistics() const
+	{
+		std::map< std::string, TaskStatistics > taskStatistics;
+		for (const std::unique_ptr< WorkQueue >& queue : queues)
+		{
+			std::lock_guard< std::mutex > lock( queue->statisticsMutex);
+			for (const std::pair< const char* const, TaskStatistics >& statistics : queue->statistics)
+			{
+				taskStatistics[statistics.first].merge( statistics.second);
+			}
+		}
+		return taskStatistics;
+	}
+	/**
+	 *
+	 */
+	std::string WorkStealingPool::asDebugString() const
+	{
+		std::ostringstream os;
+		os << asString() << "\n";
+		for (const std::pair< const std::string, TaskStatistics >& statistics : getTaskStatistics())
+		{
+			os << statistics.first << ": " << statistics.second.asString() << "\n";
+		}
+		return os.str();
+	}
+} // namespace Base
@@ -0,0 +1,277 @@
+#ifndef WORKSTEALINGPOOL_HPP_
+#define WORKSTEALINGPOOL_HPP_
+
+#include "Config.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Thread.hpp"
+
+namespace Base
+{
+	/**
+	 * The latencies of the tasks with the same name, in microseconds
+	 */
+	class TaskStatistics
+	{
+		public:
+			/**
+			 *
+			 */
+			TaskStatistics();
+			/**
+			 *
+			 * @param aQueueLatency the time between submitting and starting the task
+			 * @param aRunTime the time the task ran
+			 */
+			void add(	double aQueueLatency,
+						double aRunTime);
+			/**
+			 * Adds the tasks of aTaskStatistics
+			 */
+			void merge( const TaskStatistics& aTaskStatistics);
+			/**
+			 * @name Debug functions
+			 */
+			//@{
+			/**
+			 * Returns a 1-line description of the object
+			 */
+			std::string asString() const;
+			//@}
+
+			unsigned long tasks;
+			double meanQueueLatency;
+			double maximumQueueLatency;
+			double meanRunTime;
+			double maximumRunTime;
+	};
+	// class TaskStatistics
+
+	/**
+	 * A fixed set of worker threads that each have their own queue of tasks.
+	 *
+	 * A task submitted by a worker of the pool goes to the queue of that worker, other tasks are spread
+	 * over the queues round robin. A worker takes the tasks it spawned itself newest first, which keeps the
+	 * data of the task that spawned them warm in its cache, and the tasks submitted from outside the pool
+	 * oldest first, so that none of them starves. When its queue is empty it steals the oldest task of
+	 * another worker. Only idle workers touch the queues of others, so a busy worker hardly ever contends
+	 * for its own queue.
+	 */
+	class WorkStealingPool
+	{
+		public:
+			typedef std::function< void() > Task;
+
+			/**
+			 * The tasks of one job, so that the job can wait for its own tasks instead of for everything
+			 * that runs on the pool. A group must live until its tasks are done, its destructor waits for them.
+			 */
+			class TaskGroup
+			{
+				public:
+					/**
+					 *
+					 */
+					explicit TaskGroup( WorkStealingPool& aWorkStealingPool);
+					/**
+					 * Waits until the tasks of the group are done
+					 */
+					~TaskGroup();
+					/**
+					 *
+					 */
+					TaskGroup( const TaskGroup& aTaskGroup) = delete;
+					/**
+					 *
+					 */
+					TaskGroup& operator=( const TaskGroup& aTaskGroup) = delete;
+					/**
+					 * @see WorkStealingPool::submit
+					 */
+					void submit(	const Task& aTask,
+									const char* aName = "task");
+					/**
+					 * Blocks until the tasks submitted to the group so far are done.
+					 * Throws std::logic_error if called by a worker of the pool: the worker could be needed by the tasks.
+					 */
+					void wait();
+
+				private:
+					friend class WorkStealingPool;
+
+					/**
+					 * Called by the worker that ran a task of the group
+					 */
+					void taskDone();
+
+					WorkStealingPool& workStealingPool;
+					unsigned long unfinished;
+					std::mutex mutex;
+					std::condition_variable allDone;
+			};
+			// class TaskGroup
+
+
+			/**
+			 * The pool shared by the robots, the sensors, the SimulationClock and the CommunicationService,
+			 * with one worker per hardware thread
+			 */
+			static WorkStealingPool& getWorkStealingPool();
+			/**
+			 *
+			 * @param aNumberOfWorkers 0 means one worker per hardware thread
+			 */
+			explicit WorkStealingPool( unsigned short aNumberOfWorkers = 0);
+			/**
+			 * Waits until all submitted tasks are done
+			 */
+			~WorkStealingPool();
+			/**
+			 *
+			 */
+			WorkStealingPool( const WorkStealingPool& aWorkStealingPool) = delete;
+			/**
+			 *
+			 */
+			WorkStealingPool& operator=( const WorkStealingPool& aWorkStealingPool) = delete;
+			/**
+			 * An exception thrown by aTask is reported on std::cerr and otherwise ignored.
+			 * A task should not block for long: it occupies a worker while it does.
+			 *
+			 * @param aName the latencies are kept per name, it must be a string literal
+			 */
+			void submit(	const Task& aTask,
+							const char* aName = "task");
+			/**
+			 * Blocks until all tasks submitted so far, and the tasks they submitted, are done. A job that only
+			 * needs its own tasks to be done should use a TaskGroup.
+			 * Throws std::logic_error if called by a worker of the pool, which would wait for its own task.
+			 */
+			void wait();
+			/**
+			 * Runs one queued task on the calling worker, so that a worker that has to wait for a task can help
+			 * with the queued tasks instead of blocking.
+			 *
+			 * @return false if there was no task or the caller is not a worker of the pool
+			 */
+			bool runPendingTask();
+			/**
+			 * True if the calling thread is a worker of this pool
+			 */
+			bool isWorker() const;
+			/**
+			 *
+			 */
+			unsigned short getNumberOfWorkers() const
+			{
+				return static_cast< unsigned short >(workers.size());
+			}
+			/**
+			 *
+			 * @return the number of tasks that were taken from the queue of another worker
+			 */
+			unsigned long getSteals() const
+			{
+				return steals;
+			}
+			/**
+			 *
+			 * @return the latencies of the tasks that are done, per name
+			 */
+			std::map< std::string, TaskStatistics > getTaskStatistics() const;
+			/**
+			 * @name Debug functions
+			 */
+			//@{
+			/**
+			 * Returns a 1-line description of the object
+			 */
+			std::string asString() const;
+			/**
+			 * Returns a description of the object with all data of the object usable for debugging
+			 */
+			std::string asDebugString() const;
+			//@}
+
+		private:
+			typedef std::chrono::steady_clock Clock;
+
+			/**
+			 *
+			 */
+			struct QueuedTask
+			{
+					Task task;
+					const char* name;
+					TaskGroup* group;
+					Clock::time_point submitted;
+					/**
+					 * True if the task was submitted by the worker of the queue
+					 */
+					bool spawned;
+			};
+			/**
+			 * The statistics are only written by the worker of the queue, so workers do not contend for them.
+			 * They are kept by the address of the name literal, which costs no string per task. The same name
+			 * at another address is merged by getTaskStatistics.
+			 */
+			struct WorkQueue
+			{
+					std::mutex mutex;
+					std::deque< QueuedTask > tasks;
+					mutable std::mutex statisticsMutex;
+					std::unordered_map< const char*, TaskStatistics > statistics;
+			};
+			/**
+			 * The worker loop
+			 */
+			void work( std::size_t anIndex);
+			/**
+			 *
+			 */
+			void enqueue(	const Task& aTask,
+							const char* aName,
+							TaskGroup* aTaskGroup);
+			/**
+			 * Takes the newest task from the queue of anIndex if it spawned that task, the oldest otherwise
+			 */
+			bool popTask(	std::size_t anIndex,
+							QueuedTask& aTask);
+			/**
+			 * Takes the oldest task from the first other queue that has one
+			 */
+			bool stealTask(	std::size_t anIndex,
+							QueuedTask& aTask);
+			/**
+			 *
+			 */
+			void runTask(	std::size_t anIndex,
+							QueuedTask& aTask);
+
+			std::vector< std::unique_ptr< WorkQueue > > queues;
+			std::vector< std::thread > workers;
+			std::atomic< std::size_t > nextQueue;
+			/**
+			 * The number of tasks in the queues and the number of tasks that are not done yet
+			 */
+			std::atomic< unsigned long > queued;
+			std::atomic< unsigned long > unfinished;
+			std::atomic< unsigned long > executed;
+			std::atomic< unsigned long > steals;
+			bool running;
+			std::mutex idleMutex;
+			std::condition_variable workAvailable;
+			std::condition_variable allDone;
+	};
+	// class WorkStealingPool
+} // namespace Base
+#endif // WORKSTEALINGPOOL_HPP_